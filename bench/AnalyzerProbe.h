@@ -0,0 +1,43 @@
+/**
+ * @file AnalyzerProbe.h
+ * @brief Gives the micro-benchmarks access to the Analyzer's individual passes.
+ *
+ * The passes are private because `Analyzer::analyze` is the only supported way
+ * to run them in production; this friend forwards to them one at a time so each
+ * can be measured in isolation.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef ANALYZER_PROBE_H
+#define ANALYZER_PROBE_H
+
+#include "Analyzer.h"
+
+class AnalyzerProbe {
+public:
+    static void analyzeFunctions(Analyzer& analyzer, TSNode root, FileMetrics& metrics, const std::string& source) {
+        analyzer.analyzeFunctions(root, metrics, source);
+    }
+
+    static int calculateComplexity(Analyzer& analyzer, TSNode functionNode) {
+        return analyzer.calculateComplexity(functionNode);
+    }
+
+    static void analyzeFileWideMetrics(Analyzer& analyzer, TSNode root, FileMetrics& metrics) {
+        analyzer.analyzeFileWideMetrics(root, metrics);
+    }
+
+    static void analyzeNaming(Analyzer& analyzer, TSNode root, FileMetrics& metrics, const std::string& source) {
+        analyzer.analyzeNaming(root, metrics, source);
+    }
+
+    static void calculateFinalScore(Analyzer& analyzer, FileMetrics& metrics) {
+        analyzer.calculateFinalScore(metrics);
+    }
+
+    static const LanguageStrategy& strategy(const Analyzer& analyzer) { return *analyzer.langStrategy; }
+};
+
+#endif // ANALYZER_PROBE_H
@@ -0,0 +1,652 @@
+/**
+ * @file BenchMain.cpp
+ * @brief `cqa-bench`: end-to-end throughput benchmark over synthetic corpora.
+ *
+ * Generates one deterministic corpus per language (see CorpusGenerator.h), runs
+ * the full analysis pipeline over each corpus several times and reports the
+ * median run as JSON: files/s, MB/s, peak RSS and time per pipeline phase.
+ * With the same options and seed, every machine and commit analyzes exactly
+ * the same input, so results can be compared directly.
+ *
+ * With `--threads`, it instead sweeps worker counts over all corpora together
+ * and reports, per count, the speedup and parallel efficiency against the
+ * first count, the Karp-Flatt serial fraction, how busy workers were in each
+ * pipeline phase, and the contention on each shared lock (see LockStats.h), so
+ * a scaling cliff can be traced to the phase or lock that causes it.
+ *
+ * With `--baseline`, the corpus options, languages and worker count are taken
+ * from a previously saved report, and the new results are checked against it.
+ * The run fails if files/s or MB/s fall, or peak RSS grows, by more than the
+ * tolerance. Throughput changes must also exceed three times the combined
+ * run-to-run spread (MAD) of the two reports, so noise alone does not fail it.
+ * A missing baseline file exits with kExitSkipped, which CTest reports as a
+ * skip. A metric the baseline does not record yet is shown and not checked; if
+ * it records none, the run exits with kExitSkipped once the corpora match.
+ *
+ * With `--alloc-check`, it instead verifies that the pipeline's per-file worker
+ * loop is allocation-free once warmed up. Each corpus is analyzed twice by
+ * analyzePath() with one worker, whose workspace is kept between the runs. The
+ * first run grows every reused buffer; in the second, each file's turn through
+ * the loop, from admission to storing its result, is measured (see
+ * LoopAllocations) and the check fails if any turn makes a C++ heap allocation.
+ * The second run reserves room for the first run's results, so storing them does
+ * not count. Tree-sitter's own
+ * allocations (the syntax trees) are reported for reference but not checked.
+ * Builds that cannot count C++ allocations exit with kExitSkipped.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#include "BenchStats.h"
+#include "CorpusGenerator.h"
+#include "Json.h"
+#include "LockStats.h"
+#include "MemoryTracker.h"
+#include "Pipeline.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/// Exit status when a check cannot run here (no --baseline file, or no allocation counting);
+/// the perf-check and alloc-check tests skip on it.
+constexpr int kExitSkipped = 77;
+
+/**
+ * @struct BenchOptions
+ * @brief Command-line options for cqa-bench.
+ */
+struct BenchOptions {
+    CorpusSpec spec;                      ///< Shape shared by every language's corpus.
+    std::vector<std::string> languages = CorpusGenerator::languages();
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    int repeat = 3;                       ///< Runs per corpus; the median is reported.
+    std::string out_path;                 ///< JSON destination; empty writes to stdout.
+    std::string work_dir;                 ///< Where corpora are generated; empty uses a temp directory.
+    bool keep = false;                    ///< Keep the generated corpora afterwards.
+    std::vector<unsigned> threads;        ///< Worker counts to sweep; empty runs the per-language benchmark.
+    std::string baseline_path;            ///< Report to compare against; empty disables the check.
+    double tolerance = 0.10;              ///< Allowed relative drop in files/s and MB/s.
+    double memory_tolerance = 0.10;       ///< Allowed relative growth in peak RSS.
+    bool alloc_check = false;             ///< Check for allocations per file instead of timing.
+};
+
+/**
+ * @struct RunResult
+ * @brief Measurements of one pass of the pipeline over a corpus.
+ */
+struct RunResult {
+    double seconds = 0.0;
+    size_t files = 0;
+    uint64_t phase_ns[Profiler::kPhaseCount] = {};
+    std::map<std::string, LockStats::Totals> locks;
+    size_t throttled_waits = 0;
+};
+
+/**
+ * @struct CorpusResult
+ * @brief The reported (median) run for one language.
+ */
+struct CorpusResult {
+    std::string language;
+    size_t bytes = 0;
+    RunResult median;
+    double min_seconds = 0.0;
+    double max_seconds = 0.0;
+    double mad_seconds = 0.0; ///< Run-to-run spread of the wall time.
+    size_t peak_rss = 0;
+};
+
+/**
+ * @struct AllocationResult
+ * @brief Allocations made by the worker loop in the measured (second) run over one corpus.
+ */
+struct AllocationResult {
+    std::string language;
+    size_t files = 0;
+    size_t allocating_files = 0;   ///< Files whose turn made a C++ heap allocation.
+    size_t growth_files = 0;       ///< Files whose turn grew the run's results past the reservation.
+    uint64_t cxx_allocations = 0;
+    uint64_t cxx_bytes = 0;
+    uint64_t tree_allocations = 0; ///< Tree-sitter heap; informational.
+    std::string worst_file;        ///< The file with the most C++ allocations, if any allocated.
+    uint64_t worst_allocations = 0;
+};
+
+/**
+ * @struct ScalingPoint
+ * @brief The reported (median) run over the combined corpus at one worker count.
+ */
+struct ScalingPoint {
+    unsigned threads = 0;
+    RunResult median;
+};
+
+static std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+/**
+ * @brief Parses command-line arguments into BenchOptions.
+ * @return False if the arguments are malformed.
+ */
+static bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if ((arg == "-j" || arg == "--jobs") && hasValue) {
+                options.jobs = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--files" && hasValue) {
+                options.spec.files = std::stoul(argv[++i]);
+            } else if (arg == "--file-bytes" && hasValue) {
+                options.spec.file_bytes = std::stoul(argv[++i]);
+            } else if (arg == "--functions" && hasValue) {
+                options.spec.functions_per_file = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--nesting" && hasValue) {
+                options.spec.nesting_depth = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--comments" && hasValue) {
+                options.spec.comment_density = std::stod(argv[++i]);
+            } else if (arg == "--style" && hasValue) {
+                if (!CorpusGenerator::parseIdentifierStyle(argv[++i], options.spec.identifier_style)) return false;
+            } else if (arg == "--seed" && hasValue) {
+                options.spec.seed = std::stoull(argv[++i]);
+            } else if (arg == "--languages" && hasValue) {
+                options.languages = splitList(argv[++i]);
+                const auto& known = CorpusGenerator::languages();
+                for (const auto& language : options.languages) {
+                    if (std::find(known.begin(), known.end(), language) == known.end()) return false;
+                }
+            } else if (arg == "--repeat" && hasValue) {
+                options.repeat = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--out" && hasValue) {
+                options.out_path = argv[++i];
+            } else if (arg == "--work-dir" && hasValue) {
+                options.work_dir = argv[++i];
+            } else if (arg == "--keep") {
+                options.keep = true;
+            } else if (arg == "--alloc-check") {
+                options.alloc_check = true;
+            } else if (arg == "--baseline" && hasValue) {
+                options.baseline_path = argv[++i];
+            } else if (arg == "--tolerance" && hasValue) {
+                options.tolerance = std::stod(argv[++i]);
+            } else if (arg == "--memory-tolerance" && hasValue) {
+                options.memory_tolerance = std::stod(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                std::string value = argv[++i];
+                if (value == "auto") {
+                    // Powers of two up to the machine, plus the machine itself.
+                    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+                    for (unsigned n = 1; n < hardware; n *= 2) options.threads.push_back(n);
+                    options.threads.push_back(hardware);
+                } else {
+                    for (const auto& item : splitList(value)) options.threads.push_back(std::max(1, std::stoi(item)));
+                }
+                if (options.threads.empty()) return false;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !options.languages.empty() && (options.baseline_path.empty() || options.threads.empty()) &&
+           (!options.alloc_check || (options.baseline_path.empty() && options.threads.empty()));
+}
+
+/**
+ * @brief Replaces the corpus options, languages and worker count with those a baseline was recorded with.
+ * @return False (with `error` set) if the baseline is not a per-language cqa-bench report.
+ */
+static bool applyBaselineConfig(const Json::Value& baseline, BenchOptions& options, std::string& error) {
+    const Json::Value* config = baseline.find("config");
+    const Json::Value* corpora = baseline.find("corpora");
+    if (baseline.numberOr("schema", 0) != 1 || !config || !corpora || corpora->type != Json::Type::Array) {
+        error = "not a per-language cqa-bench report (schema 1)";
+        return false;
+    }
+
+    CorpusSpec& spec = options.spec;
+    spec.files = static_cast<size_t>(config->numberOr("files", spec.files));
+    spec.file_bytes = static_cast<size_t>(config->numberOr("file_bytes", spec.file_bytes));
+    spec.functions_per_file = static_cast<int>(config->numberOr("functions_per_file", spec.functions_per_file));
+    spec.nesting_depth = static_cast<int>(config->numberOr("nesting_depth", spec.nesting_depth));
+    spec.comment_density = config->numberOr("comment_density", spec.comment_density);
+    spec.seed = static_cast<uint64_t>(config->numberOr("seed", static_cast<double>(spec.seed)));
+    options.jobs = static_cast<unsigned>(config->numberOr("jobs", options.jobs));
+    std::string style = config->stringOr("identifier_style", CorpusGenerator::identifierStyleName(spec.identifier_style));
+    if (!CorpusGenerator::parseIdentifierStyle(style, spec.identifier_style)) {
+        error = "unknown identifier style '" + style + "'";
+        return false;
+    }
+
+    options.languages.clear();
+    for (const Json::Value& corpus : corpora->array) options.languages.push_back(corpus.stringOr("language", ""));
+    const auto& known = CorpusGenerator::languages();
+    for (const auto& language : options.languages) {
+        if (std::find(known.begin(), known.end(), language) == known.end()) {
+            error = "unknown language '" + language + "'";
+            return false;
+        }
+    }
+    if (options.languages.empty()) {
+        error = "no corpora";
+        return false;
+    }
+    return true;
+}
+
+static RunResult runOnce(const std::string& directory, unsigned jobs) {
+    PipelineOptions pipeline;
+    pipeline.governor.max_workers = jobs;
+
+    RunResult result;
+    GovernorStats governor;
+    uint64_t before[Profiler::kPhaseCount];
+    uint64_t after[Profiler::kPhaseCount];
+    Profiler::phaseTotals(before);
+    auto locksBefore = LockStats::snapshot();
+    auto start = std::chrono::steady_clock::now();
+    result.files = analyzePath(directory, pipeline, &governor).size();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Profiler::phaseTotals(after);
+    for (size_t p = 0; p < Profiler::kPhaseCount; ++p) result.phase_ns[p] = after[p] - before[p];
+    for (const auto& [name, totals] : LockStats::snapshot()) result.locks[name] = totals - locksBefore[name];
+    result.throttled_waits = governor.throttled_waits;
+    return result;
+}
+
+static AllocationResult checkAllocations(const std::string& directory, const std::string& language) {
+    PipelineOptions pipeline;
+    pipeline.governor.max_workers = 1;
+    std::vector<std::unique_ptr<AnalysisWorkspace>> workspaces;
+    pipeline.workspaces = &workspaces;
+    std::vector<FileMetrics> warmup = analyzePath(directory, pipeline);
+
+    // Room for everything the first run found, so the measured run never grows its results.
+    pipeline.reserve.files = warmup.size();
+    for (const FileMetrics& metrics : warmup) {
+        pipeline.reserve.functions += metrics.functions.size();
+        pipeline.reserve.name_bytes += metrics.functions.nameBytes();
+    }
+    warmup.clear();
+    LoopAllocations loop;
+    pipeline.loop_allocations = &loop;
+    analyzePath(directory, pipeline);
+
+    AllocationResult result;
+    result.language = language;
+    result.files = loop.files;
+    result.allocating_files = loop.allocating_files;
+    result.growth_files = loop.growth_files;
+    result.cxx_allocations = loop.allocations;
+    result.cxx_bytes = loop.bytes;
+    result.tree_allocations = loop.tree_allocations;
+    result.worst_allocations = loop.worst_allocations;
+    if (loop.worst_file != PathTable::kNoPath) result.worst_file = PathTable::global().path(loop.worst_file);
+    return result;
+}
+
+static bool writeAllocationJson(const std::string& path, const std::vector<AllocationResult>& results) {
+    std::FILE* out = path.empty() ? stdout : std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fputs("{\n  \"alloc_check\": [\n", out);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const AllocationResult& result = results[i];
+        double files = std::max<size_t>(result.files, 1);
+        std::fprintf(out, "    {\"language\": \"%s\", \"files\": %zu, \"allocating_files\": %zu, "
+                          "\"growth_files\": %zu, \"cxx_allocations_per_file\": %.3f, \"cxx_bytes_per_file\": %.1f, "
+                          "\"tree_allocations_per_file\": %.1f}%s\n",
+                     result.language.c_str(), result.files, result.allocating_files, result.growth_files,
+                     result.cxx_allocations / files, result.cxx_bytes / files, result.tree_allocations / files,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fputs("  ]\n}\n", out);
+    return path.empty() ? std::fflush(out) == 0 : std::fclose(out) == 0;
+}
+
+static RunResult medianRun(std::vector<RunResult>& runs) {
+    std::sort(runs.begin(), runs.end(), [](const RunResult& a, const RunResult& b) { return a.seconds < b.seconds; });
+    return runs[runs.size() / 2];
+}
+
+static void writeRunFields(std::FILE* out, const RunResult& run, size_t bytes) {
+    double mb = bytes / (1024.0 * 1024.0);
+    std::fprintf(out, "\"files\": %zu, \"bytes\": %zu, \"seconds\": %.6f, ", run.files, bytes, run.seconds);
+    std::fprintf(out, "\"files_per_second\": %.2f, \"mb_per_second\": %.3f, ",
+                 run.seconds > 0 ? run.files / run.seconds : 0.0, run.seconds > 0 ? mb / run.seconds : 0.0);
+    std::fputs("\"phase_ms\": {", out);
+    for (size_t p = 0; p < Profiler::kPhaseCount; ++p) {
+        std::fprintf(out, "%s\"%s\": %.3f", p ? ", " : "", Profiler::phaseName(static_cast<Profiler::Phase>(p)),
+                     run.phase_ns[p] / 1e6);
+    }
+    std::fputc('}', out);
+}
+
+/// Writes one sweep point: throughput, scaling figures, phase utilization and lock contention.
+static void writeScalingPoint(std::FILE* out, const ScalingPoint& point, const ScalingPoint& base, size_t bytes) {
+    const RunResult& run = point.median;
+    double speedup = run.seconds > 0 ? base.median.seconds / run.seconds : 0.0;
+    double relativeThreads = static_cast<double>(point.threads) / base.threads;
+    double efficiency = speedup / relativeThreads;
+    // Karp-Flatt: the serial fraction that would explain the measured speedup.
+    double serial = relativeThreads > 1.0 && speedup > 0 ? (1.0 / speedup - 1.0 / relativeThreads) /
+                                                               (1.0 - 1.0 / relativeThreads)
+                                                         : 0.0;
+    double workerNs = run.seconds * 1e9 * point.threads;
+
+    std::fprintf(out, "    {\"threads\": %u, ", point.threads);
+    writeRunFields(out, run, bytes);
+    std::fprintf(out, ", \"speedup\": %.3f, \"efficiency\": %.3f, \"serial_fraction\": %.4f, "
+                      "\"throttled_waits\": %zu,\n     \"utilization\": {",
+                 speedup, efficiency, serial, run.throttled_waits);
+    for (size_t p = 0; p < Profiler::kPhaseCount; ++p) {
+        std::fprintf(out, "%s\"%s\": %.4f", p ? ", " : "", Profiler::phaseName(static_cast<Profiler::Phase>(p)),
+                     workerNs > 0 ? run.phase_ns[p] / workerNs : 0.0);
+    }
+    std::fputs("},\n     \"locks\": {", out);
+    bool first = true;
+    for (const auto& [name, totals] : run.locks) {
+        std::fprintf(out, "%s\"%s\": {\"acquisitions\": %llu, \"contended\": %llu, \"wait_ms\": %.3f, "
+                          "\"hold_ms\": %.3f, \"hold_fraction\": %.4f}",
+                     first ? "" : ", ", name.c_str(), static_cast<unsigned long long>(totals.acquisitions),
+                     static_cast<unsigned long long>(totals.contended), totals.wait_ns / 1e6, totals.hold_ns / 1e6,
+                     run.seconds > 0 ? totals.hold_ns / (run.seconds * 1e9) : 0.0);
+        first = false;
+    }
+    std::fputs("}}", out);
+}
+
+/// Sums the per-language medians into one "total" entry; spreads are combined as independent.
+static CorpusResult totalOf(const std::vector<CorpusResult>& corpora) {
+    CorpusResult total;
+    total.language = "total";
+    double madSquares = 0.0;
+    for (const CorpusResult& corpus : corpora) {
+        total.median.seconds += corpus.median.seconds;
+        total.median.files += corpus.median.files;
+        for (size_t p = 0; p < Profiler::kPhaseCount; ++p) total.median.phase_ns[p] += corpus.median.phase_ns[p];
+        total.bytes += corpus.bytes;
+        total.peak_rss = std::max(total.peak_rss, corpus.peak_rss);
+        madSquares += corpus.mad_seconds * corpus.mad_seconds;
+    }
+    total.mad_seconds = std::sqrt(madSquares);
+    return total;
+}
+
+/**
+ * @brief Compares the results with a baseline report and prints one line per check to stderr.
+ * @param compared Receives the number of metrics the baseline records and that were checked.
+ * @return False if any metric regressed beyond its threshold, or the corpora no longer match.
+ */
+static bool checkBaseline(const Json::Value& baseline, const BenchOptions& options,
+                          const std::vector<CorpusResult>& corpora, size_t& compared) {
+    compared = 0;
+    std::vector<const Json::Value*> entries;
+    std::vector<CorpusResult> current = corpora;
+    for (const Json::Value& corpus : baseline.find("corpora")->array) entries.push_back(&corpus);
+    entries.push_back(baseline.find("total"));
+    current.push_back(totalOf(corpora));
+
+    bool passed = true;
+    std::fprintf(stderr, "%-12s %-18s %14s %14s %9s %9s\n", "corpus", "metric", "baseline", "current", "change",
+                 "allowed");
+    for (size_t i = 0; i < current.size(); ++i) {
+        const CorpusResult& now = current[i];
+        const Json::Value* before = entries[i];
+        if (!before || static_cast<size_t>(before->numberOr("bytes", 0)) != now.bytes) {
+            std::fprintf(stderr, "%-12s corpus differs from the baseline's; re-record the baseline\n",
+                         now.language.c_str());
+            passed = false;
+            continue;
+        }
+
+        double seconds = now.median.seconds;
+        double baseSeconds = before->numberOr("seconds", 0);
+        double spread = std::hypot(seconds > 0 ? now.mad_seconds / seconds : 0.0,
+                                   baseSeconds > 0 ? before->numberOr("mad_seconds", 0) / baseSeconds : 0.0);
+        double throughputAllowed = std::max(options.tolerance, 3.0 * spread);
+        double mb = now.bytes / (1024.0 * 1024.0);
+
+        struct Check {
+            const char* metric;
+            double baseline;
+            double current;
+            double allowed;
+            bool higherIsBetter;
+        };
+        std::vector<Check> checks = {
+            {"files_per_second", before->numberOr("files_per_second", 0), seconds > 0 ? now.median.files / seconds : 0,
+             throughputAllowed, true},
+            {"mb_per_second", before->numberOr("mb_per_second", 0), seconds > 0 ? mb / seconds : 0, throughputAllowed,
+             true},
+        };
+        // Peak RSS is a process high-water mark, so only the run as a whole is meaningful.
+        if (now.language == "total") {
+            checks.push_back({"peak_rss_bytes", before->numberOr("peak_rss_bytes", 0),
+                              static_cast<double>(now.peak_rss), options.memory_tolerance, false});
+        }
+
+        for (const Check& check : checks) {
+            if (check.baseline <= 0) {
+                std::fprintf(stderr, "%-12s %-18s %14s %14.2f  (not recorded in the baseline)\n",
+                             now.language.c_str(), check.metric, "-", check.current);
+                continue;
+            }
+            ++compared;
+            double change = check.current / check.baseline - 1.0;
+            bool regressed = check.higherIsBetter ? change < -check.allowed : change > check.allowed;
+            passed = passed && !regressed;
+            std::fprintf(stderr, "%-12s %-18s %14.2f %14.2f %+8.1f%% %8.1f%%%s\n", now.language.c_str(), check.metric,
+                         check.baseline, check.current, change * 100, check.allowed * 100,
+                         regressed ? "  REGRESSION" : "");
+        }
+    }
+    return passed;
+}
+
+static bool writeJson(const std::string& path, const BenchOptions& options, const std::vector<CorpusResult>& corpora,
+                      const std::vector<ScalingPoint>& scaling, size_t scalingBytes) {
+    std::FILE* out = path.empty() ? stdout : std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    const CorpusSpec& spec = options.spec;
+    std::fputs("{\n  \"schema\": 1,\n", out);
+    std::fprintf(out, "  \"machine\": {\"hardware_threads\": %u, \"compiler\": \"%s\", \"phase_times\": %s},\n",
+                 std::thread::hardware_concurrency(),
+#if defined(__VERSION__)
+                 __VERSION__,
+#else
+                 "unknown",
+#endif
+                 CQA_ENABLE_TRACING ? "true" : "false");
+    std::fprintf(out, "  \"config\": {\"jobs\": %u, \"repeat\": %d, \"seed\": %llu, \"files\": %zu, \"file_bytes\": %zu, "
+                      "\"functions_per_file\": %d, \"nesting_depth\": %d, \"comment_density\": %.3f, "
+                      "\"identifier_style\": \"%s\"},\n",
+                 options.jobs, options.repeat, static_cast<unsigned long long>(spec.seed), spec.files, spec.file_bytes,
+                 spec.functions_per_file, spec.nesting_depth, spec.comment_density,
+                 CorpusGenerator::identifierStyleName(spec.identifier_style));
+
+    if (!scaling.empty()) {
+        std::fputs("  \"scaling\": [\n", out);
+        for (size_t i = 0; i < scaling.size(); ++i) {
+            writeScalingPoint(out, scaling[i], scaling.front(), scalingBytes);
+            std::fputs(i + 1 < scaling.size() ? ",\n" : "\n", out);
+        }
+        std::fputs("  ]\n}\n", out);
+        return path.empty() ? std::fflush(out) == 0 : std::fclose(out) == 0;
+    }
+
+    std::fputs("  \"corpora\": [\n", out);
+    for (size_t i = 0; i < corpora.size(); ++i) {
+        const CorpusResult& corpus = corpora[i];
+        std::fprintf(out, "    {\"language\": \"%s\", ", corpus.language.c_str());
+        writeRunFields(out, corpus.median, corpus.bytes);
+        std::fprintf(out, ", \"min_seconds\": %.6f, \"max_seconds\": %.6f, \"mad_seconds\": %.6f, "
+                          "\"peak_rss_bytes\": %zu}%s\n",
+                     corpus.min_seconds, corpus.max_seconds, corpus.mad_seconds, corpus.peak_rss,
+                     i + 1 < corpora.size() ? "," : "");
+    }
+    CorpusResult total = totalOf(corpora);
+    std::fputs("  ],\n  \"total\": {", out);
+    writeRunFields(out, total.median, total.bytes);
+    std::fprintf(out, ", \"mad_seconds\": %.6f, \"peak_rss_bytes\": %zu}\n}\n", total.mad_seconds, total.peak_rss);
+    return path.empty() ? std::fflush(out) == 0 : std::fclose(out) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [-j N] [--files N] [--file-bytes N] [--functions N] [--nesting N] "
+                     "[--comments FRACTION] [--style snake|camel|short] [--seed N] [--languages c,cpp,...] "
+                     "[--repeat N] [--threads auto|1,2,4,...] [--out results.json] [--work-dir DIR] [--keep] "
+                     "[--baseline FILE [--tolerance FRACTION] [--memory-tolerance FRACTION]] [--alloc-check]"
+                  << std::endl;
+        return 1;
+    }
+
+    Json::Value baseline;
+    if (!options.baseline_path.empty()) {
+        std::error_code ec;
+        if (!fs::exists(options.baseline_path, ec)) {
+            std::cerr << "No baseline " << options.baseline_path << "; record one for this machine class "
+                         "(see bench/baselines/README.md). Skipping the comparison." << std::endl;
+            return kExitSkipped;
+        }
+        std::string error;
+        if (!Json::parseFile(options.baseline_path, baseline, error) || !applyBaselineConfig(baseline, options, error)) {
+            std::cerr << "Error: Invalid baseline " << options.baseline_path << ": " << error << std::endl;
+            return 1;
+        }
+    }
+
+    // Same setup as the cqa command, so the measured pipeline is the shipped one.
+    MemoryTracker::install();
+    if (options.alloc_check) {
+        // The profiler records every file, so it stays off while allocations are counted.
+        if (!MemoryTracker::enableCxxTracking()) {
+            std::cerr << "--alloc-check needs C++ allocation counting, which this build lacks (glibc only). Skipping."
+                      << std::endl;
+            return kExitSkipped;
+        }
+    } else {
+        Profiler::enable();
+    }
+    if (!options.threads.empty()) LockStats::enable();
+
+    bool temporary = options.work_dir.empty();
+    fs::path root = temporary ? fs::temp_directory_path() / ("cqa-bench-" + std::to_string(options.spec.seed))
+                              : fs::path(options.work_dir);
+
+    std::vector<CorpusResult> corpora;
+    std::vector<AllocationResult> allocations;
+    size_t totalBytes = 0;
+    for (const auto& language : options.languages) {
+        CorpusSpec spec = options.spec;
+        spec.language = language;
+        std::string directory = (root / language).string();
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+
+        CorpusResult corpus;
+        corpus.language = language;
+        corpus.bytes = CorpusGenerator(spec).writeTo(directory);
+        totalBytes += corpus.bytes;
+        if (options.alloc_check) {
+            allocations.push_back(checkAllocations(directory, language));
+            const AllocationResult& result = allocations.back();
+            std::cerr << language << ": " << result.files << " files, " << result.allocating_files
+                      << " allocating after warm-up, " << result.growth_files << " growing the results past the reservation";
+            if (result.allocating_files) {
+                std::cerr << " (worst: " << result.worst_file << ", " << result.worst_allocations << " allocations)";
+            }
+            std::cerr << "\n";
+            continue;
+        }
+        if (!options.threads.empty()) continue;
+
+        std::vector<RunResult> runs;
+        for (int r = 0; r < options.repeat; ++r) runs.push_back(runOnce(directory, options.jobs));
+        corpus.median = medianRun(runs);
+        corpus.min_seconds = runs.front().seconds;
+        corpus.max_seconds = runs.back().seconds;
+        std::vector<double> seconds;
+        for (const RunResult& run : runs) seconds.push_back(run.seconds);
+        corpus.mad_seconds = summarize(std::move(seconds)).mad;
+        corpus.peak_rss = MemoryTracker::peakResidentBytes();
+        std::cerr << language << ": " << corpus.median.files << " files, " << corpus.median.seconds * 1e3 << " ms\n";
+        corpora.push_back(std::move(corpus));
+    }
+
+    // The sweep analyzes every language's corpus in one run, as a mixed repository would be.
+    std::vector<ScalingPoint> scaling;
+    for (unsigned threads : options.threads) {
+        std::vector<RunResult> runs;
+        for (int r = 0; r < options.repeat; ++r) runs.push_back(runOnce(root.string(), threads));
+        ScalingPoint point;
+        point.threads = threads;
+        point.median = medianRun(runs);
+        double speedup = scaling.empty() ? 1.0 : scaling.front().median.seconds / point.median.seconds;
+        std::cerr << threads << " threads: " << point.median.seconds * 1e3 << " ms, speedup " << speedup << "\n";
+        scaling.push_back(std::move(point));
+    }
+
+    if (!options.keep) {
+        // Only remove what was generated; a user-supplied work directory itself is left alone.
+        std::error_code ec;
+        for (const auto& language : options.languages) fs::remove_all(root / language, ec);
+        if (temporary) fs::remove(root, ec);
+    }
+
+    if (options.alloc_check) {
+        if (!writeAllocationJson(options.out_path, allocations)) {
+            std::cerr << "Error: Could not write results: " << options.out_path << std::endl;
+            return 1;
+        }
+        for (const AllocationResult& result : allocations) {
+            if (result.allocating_files) {
+                std::cerr << "The per-file worker loop allocates after warm-up" << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    if (!writeJson(options.out_path, options, corpora, scaling, totalBytes)) {
+        std::cerr << "Error: Could not write results: " << options.out_path << std::endl;
+        return 1;
+    }
+    if (!options.baseline_path.empty()) {
+        size_t compared = 0;
+        if (!checkBaseline(baseline, options, corpora, compared)) {
+            std::cerr << "Performance regression against " << options.baseline_path << std::endl;
+            return 1;
+        }
+        if (compared == 0) {
+            std::cerr << options.baseline_path << " records no timings or peak RSS yet; record them on this machine "
+                         "class (see bench/baselines/README.md). Skipping the comparison." << std::endl;
+            return kExitSkipped;
+        }
+    }
+    return 0;
+}
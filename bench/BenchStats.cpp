@@ -0,0 +1,33 @@
+// bench/BenchStats.cpp
+#include "BenchStats.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+static double medianOfSorted(const std::vector<double>& sorted) {
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+}
+
+SampleStats summarize(std::vector<double> samples) {
+    SampleStats stats;
+    stats.count = samples.size();
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.median = medianOfSorted(samples);
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+
+    double squares = 0.0;
+    for (double value : samples) squares += (value - stats.mean) * (value - stats.mean);
+    stats.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0.0;
+
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for (double value : samples) deviations.push_back(std::fabs(value - stats.median));
+    std::sort(deviations.begin(), deviations.end());
+    stats.mad = medianOfSorted(deviations);
+    return stats;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file BenchStats.h
+ * @brief Robust summary statistics for benchmark samples.
+ *
+ * Timings on shared machines have long right tails, so comparisons use the
+ * median and the median absolute deviation (MAD) rather than mean and standard
+ * deviation; both are reported for completeness.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct SampleStats
+ * @brief Summary of a set of measurements (all in the samples' unit).
+ */
+struct SampleStats {
+    size_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double median = 0.0;
+    double mad = 0.0; ///< Median absolute deviation from the median.
+
+    /// @return MAD as a fraction of the median (0 when the median is 0).
+    double relativeMad() const { return median != 0.0 ? mad / median : 0.0; }
+};
+
+/// @return Summary statistics of `samples` (taken by value; the copy is sorted).
+SampleStats summarize(std::vector<double> samples);
+
+#endif // BENCH_STATS_H
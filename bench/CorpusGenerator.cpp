@@ -0,0 +1,355 @@
+// bench/CorpusGenerator.cpp
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// SplitMix64: tiny, fast and fully specified, so corpora are reproducible everywhere.
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    /// @return A value in [0, bound).
+    uint64_t below(uint64_t bound) { return bound ? next() % bound : 0; }
+
+    /// @return A value in [0.0, 1.0).
+    double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    uint64_t state;
+};
+
+uint64_t hashString(const std::string& value) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : value) hash = (hash ^ c) * 0x100000001b3ull;
+    return hash;
+}
+
+const char* const kWords[] = {
+    "compute", "total", "value", "buffer", "parse", "token", "render", "frame", "update", "state",
+    "merge", "result", "count", "index", "window", "cache", "entry", "resolve", "path", "node",
+    "visit", "child", "scale", "factor", "load", "config", "apply", "filter", "collect", "metric",
+    "flush", "queue", "retry", "limit", "encode", "stream", "align", "offset", "commit", "range"};
+constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+constexpr size_t kAverageLineBytes = 32;
+
+/**
+ * @class SourceWriter
+ * @brief Emits one file, hiding the per-language syntax of each construct.
+ */
+class SourceWriter {
+public:
+    SourceWriter(const CorpusSpec& spec, Random& random) : spec(spec), random(random) {
+        const std::string& lang = spec.language;
+        python = lang == "python";
+        hashComments = python;
+        cLike = lang == "c" || lang == "cpp" || lang == "java";
+    }
+
+    std::string build(size_t fileIndex) {
+        const std::string& lang = spec.language;
+        if (lang == "c") line("#include <stdio.h>");
+        if (lang == "cpp") line("#include <vector>");
+        if (lang == "go") line("package gen");
+        if (lang == "java") {
+            line("public class " + className(fileIndex) + " {");
+            indent++;
+        }
+        out += "\n";
+
+        int functions = std::max(1, spec.functions_per_file);
+        for (int f = 0; f < functions; ++f) {
+            // Size each function so the file ends close to file_bytes.
+            size_t remaining = spec.file_bytes > out.size() ? spec.file_bytes - out.size() : 0;
+            emitFunction(fileIndex * 1000 + f, remaining / (functions - f));
+            out += "\n";
+        }
+
+        if (lang == "java") {
+            indent--;
+            line("}");
+        }
+        return out;
+    }
+
+    static std::string className(size_t fileIndex) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "Gen%05zu", fileIndex);
+        return name;
+    }
+
+private:
+    const CorpusSpec& spec;
+    Random& random;
+    std::string out;
+    int indent = 0;
+    bool python = false;
+    bool hashComments = false;
+    bool cLike = false;
+    std::vector<std::string> locals;
+    std::string left, right;
+    size_t functionEnd = 0; ///< Output size at which the current function body stops growing.
+
+    /// @return True while the function body has room for about `lines` more lines.
+    bool hasRoom(size_t lines = 1) const { return out.size() + lines * kAverageLineBytes <= functionEnd; }
+
+    void line(const std::string& text) {
+        out.append(indent * 4, ' ');
+        out += text;
+        out += '\n';
+    }
+
+    std::string identifier(size_t words, size_t suffix) {
+        std::string name;
+        if (spec.identifier_style == IdentifierStyle::Short) {
+            for (size_t w = 0; w < words; ++w) name += kWords[random.below(kWordCount)][0];
+            return name + std::to_string(suffix);
+        }
+        for (size_t w = 0; w < words; ++w) {
+            std::string word = kWords[random.below(kWordCount)];
+            if (spec.identifier_style == IdentifierStyle::Camel && w > 0) {
+                word[0] = static_cast<char>(word[0] - 'a' + 'A');
+            } else if (w > 0) {
+                name += '_';
+            }
+            name += word;
+        }
+        return name + (spec.identifier_style == IdentifierStyle::Snake ? "_" : "") + std::to_string(suffix);
+    }
+
+    std::string localName(size_t index) {
+        if (spec.identifier_style == IdentifierStyle::Short) return std::string(1, "tnqrmwhs"[index % 8]);
+        return identifier(2, index);
+    }
+
+    std::string loopVariable(int depth) {
+        if (spec.identifier_style == IdentifierStyle::Short) return std::string(1, "ijkuvpgo"[depth % 8]);
+        return spec.identifier_style == IdentifierStyle::Snake ? "idx_" + std::to_string(depth)
+                                                               : "idx" + std::to_string(depth);
+    }
+
+    void maybeComment() {
+        // A geometric number of comment lines per code line gives the requested comment fraction.
+        double density = std::min(0.95, std::max(0.0, spec.comment_density));
+        while (random.unit() < density) {
+            std::string text = kWords[random.below(kWordCount)];
+            text += " the ";
+            text += kWords[random.below(kWordCount)];
+            line(std::string(hashComments ? "# " : "// ") + text);
+        }
+    }
+
+    std::string condition() {
+        const std::string& a = locals[random.below(locals.size())];
+        std::string base = a + " > " + std::to_string(random.below(100));
+        if (random.below(3) != 0) return base;
+        const std::string& b = locals[random.below(locals.size())];
+        return base + (python ? " and " : " && ") + b + " < " + right;
+    }
+
+    std::string statementText() {
+        const std::string& target = locals[random.below(locals.size())];
+        const std::string& source = locals[random.below(locals.size())];
+        static const char* const ops[] = {" + ", " - ", " * "};
+        std::string text = target + " = " + source + ops[random.below(3)] + std::to_string(random.below(10) + 1);
+        return python || spec.language == "go" ? text : text + ";";
+    }
+
+    void openBlock(const std::string& header) {
+        line(header);
+        indent++;
+    }
+
+    void closeBlock() {
+        indent--;
+        if (!python) line("}");
+    }
+
+    void emitIf(int depth) {
+        std::string cond = condition();
+        openBlock(python ? "if " + cond + ":" : cLike || spec.language == "javascript" || spec.language == "typescript"
+                                                    ? "if (" + cond + ") {"
+                                                    : "if " + cond + " {");
+        emitBlock(depth + 1);
+        if (random.below(2) == 0) {
+            indent--;
+            line(python ? "else:" : "} else {");
+            indent++;
+            emitBlock(depth + 1);
+        }
+        closeBlock();
+    }
+
+    void emitLoop(int depth) {
+        std::string var = loopVariable(depth);
+        const std::string& lang = spec.language;
+        std::string header;
+        if (python) {
+            header = "for " + var + " in range(" + right + "):";
+        } else if (lang == "rust") {
+            header = "for " + var + " in 0.." + right + " {";
+        } else if (lang == "go") {
+            header = "for " + var + " := 0; " + var + " < " + right + "; " + var + "++ {";
+        } else if (lang == "javascript" || lang == "typescript") {
+            header = "for (let " + var + " = 0; " + var + " < " + right + "; " + var + "++) {";
+        } else {
+            header = "for (int " + var + " = 0; " + var + " < " + right + "; " + var + "++) {";
+        }
+        openBlock(header);
+        emitBlock(depth + 1);
+        closeBlock();
+    }
+
+    /// Emits at least one statement, then more while the function has room.
+    void emitBlock(int depth) {
+        size_t statements = 0;
+        do {
+            maybeComment();
+            uint64_t choice = random.below(10);
+            if (depth < spec.nesting_depth && hasRoom(4) && choice < 2) {
+                emitIf(depth);
+            } else if (depth < spec.nesting_depth && hasRoom(4) && choice < 3) {
+                emitLoop(depth);
+            } else {
+                line(statementText());
+            }
+            statements++;
+        } while (hasRoom() && random.below(4) != 0 && statements < 8);
+    }
+
+    void emitFunction(size_t suffix, size_t bytes) {
+        functionEnd = out.size() + bytes;
+        const std::string& lang = spec.language;
+        std::string name = identifier(2 + random.below(2), suffix);
+        bool shortNames = spec.identifier_style == IdentifierStyle::Short;
+        left = shortNames ? "a" : (spec.identifier_style == IdentifierStyle::Snake ? "left_value" : "leftValue");
+        right = shortNames ? "b" : (spec.identifier_style == IdentifierStyle::Snake ? "right_value" : "rightValue");
+
+        maybeComment();
+        if (python) {
+            openBlock("def " + name + "(" + left + ", " + right + "):");
+        } else if (lang == "rust") {
+            openBlock("fn " + name + "(" + left + ": i64, " + right + ": i64) -> i64 {");
+        } else if (lang == "go") {
+            openBlock("func " + name + "(" + left + " int, " + right + " int) int {");
+        } else if (lang == "java") {
+            openBlock("static int " + name + "(int " + left + ", int " + right + ") {");
+        } else if (lang == "javascript" && spec.arrow_functions) {
+            openBlock("const " + name + " = (" + left + ", " + right + ") => {");
+        } else if (lang == "javascript") {
+            openBlock("function " + name + "(" + left + ", " + right + ") {");
+        } else if (lang == "typescript" && spec.arrow_functions) {
+            openBlock("const " + name + " = (" + left + ": number, " + right + ": number): number => {");
+        } else if (lang == "typescript") {
+            openBlock("function " + name + "(" + left + ": number, " + right + ": number): number {");
+        } else {
+            openBlock("int " + name + "(int " + left + ", int " + right + ") {");
+        }
+
+        locals.clear();
+        size_t localCount = 2 + random.below(3);
+        for (size_t i = 0; i < localCount; ++i) {
+            std::string local = localName(i);
+            std::string init = (i % 2 ? right : left) + " + " + std::to_string(i);
+            locals.push_back(local);
+            if (python) {
+                line(local + " = " + init);
+            } else if (lang == "rust") {
+                line("let mut " + local + " = " + init + ";");
+            } else if (lang == "go") {
+                line(local + " := " + init);
+            } else if (lang == "javascript") {
+                line("let " + local + " = " + init + ";");
+            } else if (lang == "typescript") {
+                line("let " + local + ": number = " + init + ";");
+            } else {
+                line("int " + local + " = " + init + ";");
+            }
+        }
+
+        do {
+            emitBlock(0);
+        } while (hasRoom(2));
+
+        line(python || lang == "go" ? "return " + locals[0] : "return " + locals[0] + ";");
+        closeBlock();
+        // The arrow function is the initializer of a declaration, which needs its ';'.
+        if (spec.arrow_functions && (lang == "javascript" || lang == "typescript")) out.insert(out.size() - 1, ";");
+    }
+};
+
+const char* extensionFor(const std::string& language) {
+    if (language == "c") return ".c";
+    if (language == "cpp") return ".cpp";
+    if (language == "python") return ".py";
+    if (language == "java") return ".java";
+    if (language == "rust") return ".rs";
+    if (language == "go") return ".go";
+    if (language == "javascript") return ".js";
+    return ".ts";
+}
+
+} // namespace
+
+CorpusGenerator::CorpusGenerator(const CorpusSpec& spec) : spec(spec) {}
+
+std::string CorpusGenerator::generateFile(size_t index) const {
+    Random random(spec.seed ^ hashString(spec.language) ^ (index * 0x9e3779b97f4a7c15ull));
+    SourceWriter writer(spec, random);
+    return writer.build(index);
+}
+
+std::string CorpusGenerator::fileName(size_t index) const {
+    return SourceWriter::className(index) + extensionFor(spec.language);
+}
+
+size_t CorpusGenerator::writeTo(const std::string& directory) const {
+    fs::create_directories(directory);
+    size_t total = 0;
+    for (size_t i = 0; i < spec.files; ++i) {
+        std::string text = generateFile(i);
+        std::ofstream file(fs::path(directory) / fileName(i), std::ios::binary);
+        file << text;
+        total += text.size();
+    }
+    return total;
+}
+
+const std::vector<std::string>& CorpusGenerator::languages() {
+    static const std::vector<std::string> names = {"c", "cpp", "python", "java", "rust", "go", "javascript", "typescript"};
+    return names;
+}
+
+bool CorpusGenerator::parseIdentifierStyle(const std::string& name, IdentifierStyle& style) {
+    if (name == "snake") {
+        style = IdentifierStyle::Snake;
+    } else if (name == "camel") {
+        style = IdentifierStyle::Camel;
+    } else if (name == "short") {
+        style = IdentifierStyle::Short;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* CorpusGenerator::identifierStyleName(IdentifierStyle style) {
+    switch (style) {
+        case IdentifierStyle::Snake: return "snake";
+        case IdentifierStyle::Camel: return "camel";
+        default:                     return "short";
+    }
+}
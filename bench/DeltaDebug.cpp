@@ -0,0 +1,69 @@
+// bench/DeltaDebug.cpp
+#include "DeltaDebug.h"
+#include <algorithm>
+
+namespace DeltaDebug {
+
+    Units splitLines(const std::string& text) {
+        Units lines;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            end = end == std::string::npos ? text.size() : end + 1;
+            lines.push_back(text.substr(start, end - start));
+            start = end;
+        }
+        return lines;
+    }
+
+    Units splitChars(const std::string& text) {
+        Units chars;
+        chars.reserve(text.size());
+        for (char c : text) chars.emplace_back(1, c);
+        return chars;
+    }
+
+    std::string join(const Units& units) {
+        std::string text;
+        for (const auto& unit : units) text += unit;
+        return text;
+    }
+
+    Units minimize(Units units, const Predicate& fails, size_t maxTests) {
+        size_t tests = 0;
+        size_t granularity = 2;
+        while (units.size() >= 2 && tests < maxTests) {
+            size_t chunk = (units.size() + granularity - 1) / granularity;
+            bool reduced = false;
+
+            // First try each chunk on its own, then everything except each chunk.
+            for (int complement = 0; complement < 2 && !reduced; ++complement) {
+                for (size_t start = 0; start < units.size() && tests < maxTests; start += chunk) {
+                    size_t end = std::min(units.size(), start + chunk);
+                    Units candidate;
+                    if (complement) {
+                        candidate.assign(units.begin(), units.begin() + start);
+                        candidate.insert(candidate.end(), units.begin() + end, units.end());
+                    } else {
+                        candidate.assign(units.begin() + start, units.begin() + end);
+                    }
+                    if (candidate.empty() || candidate.size() == units.size()) continue;
+                    ++tests;
+                    if (fails(candidate)) {
+                        units = std::move(candidate);
+                        granularity = complement ? std::max<size_t>(granularity - 1, 2) : 2;
+                        reduced = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!reduced) {
+                if (granularity >= units.size()) break;
+                granularity = std::min(units.size(), granularity * 2);
+            }
+        }
+        return units;
+    }
+
+} // namespace DeltaDebug
@@ -0,0 +1,47 @@
+/**
+ * @file DeltaDebug.h
+ * @brief Delta debugging (ddmin) for shrinking failing inputs.
+ *
+ * Given an input split into units (lines, characters, ...) and a predicate that
+ * says whether a candidate still fails, `minimize` returns a 1-minimal subset
+ * of the units: removing any single remaining unit makes the failure go away.
+ * This is Zeller and Hildebrandt's ddmin, testing subsets and then complements
+ * at increasing granularity.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef DELTA_DEBUG_H
+#define DELTA_DEBUG_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace DeltaDebug {
+
+    using Units = std::vector<std::string>;
+    using Predicate = std::function<bool(const Units&)>;
+
+    /// Splits text into lines, each keeping its trailing newline.
+    Units splitLines(const std::string& text);
+
+    /// Splits text into single characters.
+    Units splitChars(const std::string& text);
+
+    /// Concatenates units back into text.
+    std::string join(const Units& units);
+
+    /**
+     * @brief Shrinks `units` while `fails` keeps returning true.
+     * @param units An input for which `fails` is true.
+     * @param maxTests Upper bound on predicate calls; the best result so far is returned when reached.
+     * @return The smallest failing subset found, in original order.
+     */
+    Units minimize(Units units, const Predicate& fails, size_t maxTests);
+
+} // namespace DeltaDebug
+
+#endif // DELTA_DEBUG_H
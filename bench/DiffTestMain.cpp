@@ -0,0 +1,331 @@
+/**
+ * @file DiffTestMain.cpp
+ * @brief `cqa-difftest`: differential testing of analysis engines against the reference.
+ *
+ * Runs every registered engine (today: the production Analyzer) and the frozen
+ * ReferenceAnalyzer over the same parse trees and compares every FileMetrics
+ * and FunctionMetric field. Inputs are generated corpora across a range of
+ * seeds, nesting depths, identifier styles and comment densities, plus any
+ * real source trees given with `--path`. Each divergence is shrunk with delta
+ * debugging — first by lines, then by characters — to the smallest snippet that
+ * still shows the same kind of divergence, which is written to `--out-dir`.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#include "Analyzer.h"
+#include "CorpusGenerator.h"
+#include "DeltaDebug.h"
+#include "LanguageDescriptor.h"
+#include "Parser.h"
+#include "Pipeline.h"
+#include "ReferenceAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * @struct Engine
+ * @brief An analysis implementation under test. Add optimized engines here.
+ */
+struct Engine {
+    const char* name;
+    std::function<FileMetrics(TSNode root, const std::string& path, const std::string& source, Language language)>
+        analyze;
+};
+
+static const std::vector<Engine>& engines() {
+    static const std::vector<Engine> list = {
+        {"analyzer",
+         [](TSNode root, const std::string& path, const std::string& source, Language language) {
+             Analyzer analyzer(createStrategy(language));
+             return analyzer.analyze(root, path, source);
+         }},
+    };
+    return list;
+}
+
+/**
+ * @struct DiffOptions
+ * @brief Command-line options for cqa-difftest.
+ */
+struct DiffOptions {
+    std::vector<std::string> languages = CorpusGenerator::languages();
+    int seeds = 8;                 ///< Generated corpora per language, each with a different shape.
+    size_t files = 10;             ///< Files per generated corpus.
+    size_t file_bytes = 4096;
+    std::vector<std::string> paths; ///< Real source trees to include.
+    std::string out_dir = "difftest-failures";
+    bool minimize = true;
+    size_t max_failures = 10;      ///< Stop after this many divergent inputs.
+    size_t max_tests = 4000;       ///< Predicate budget per minimization.
+    std::vector<std::string> descriptors; ///< Language descriptors to load; they replace built-in strategies they redefine.
+};
+
+/**
+ * @struct Difference
+ * @brief One field that differs between the reference and an engine.
+ */
+struct Difference {
+    std::string field;     ///< e.g. "functions[3].complexity"
+    std::string kind;      ///< The field with indices removed, e.g. "functions[].complexity".
+    std::string reference;
+    std::string engine;
+};
+
+static std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static bool parseArguments(int argc, char* argv[], DiffOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--languages" && hasValue) {
+                options.languages = splitList(argv[++i]);
+                const auto& known = CorpusGenerator::languages();
+                for (const auto& language : options.languages) {
+                    if (std::find(known.begin(), known.end(), language) == known.end()) return false;
+                }
+            } else if (arg == "--descriptors" && hasValue) {
+                options.descriptors.push_back(argv[++i]);
+            } else if (arg == "--seeds" && hasValue) {
+                options.seeds = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--files" && hasValue) {
+                options.files = std::stoul(argv[++i]);
+            } else if (arg == "--file-bytes" && hasValue) {
+                options.file_bytes = std::stoul(argv[++i]);
+            } else if (arg == "--path" && hasValue) {
+                options.paths.push_back(argv[++i]);
+            } else if (arg == "--out-dir" && hasValue) {
+                options.out_dir = argv[++i];
+            } else if (arg == "--no-minimize") {
+                options.minimize = false;
+            } else if (arg == "--max-failures" && hasValue) {
+                options.max_failures = std::max(1ul, std::stoul(argv[++i]));
+            } else if (arg == "--max-tests" && hasValue) {
+                options.max_tests = std::stoul(argv[++i]);
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string toText(double value) {
+    std::ostringstream out;
+    out.precision(17);
+    out << value;
+    return out.str();
+}
+
+/// Optimized engines may sum in a different order, so doubles only need to agree to rounding.
+static bool sameDouble(double a, double b) {
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+static std::vector<Difference> compare(const FileMetrics& reference, const FileMetrics& engine) {
+    std::vector<Difference> diffs;
+    auto check = [&](const std::string& field, const std::string& kind, bool same, const std::string& expected,
+                     const std::string& actual) {
+        if (!same) diffs.push_back({field, kind, expected, actual});
+    };
+    auto checkInt = [&](const std::string& field, const std::string& kind, long expected, long actual) {
+        check(field, kind, expected == actual, std::to_string(expected), std::to_string(actual));
+    };
+    auto checkDouble = [&](const char* field, double expected, double actual) {
+        check(field, field, sameDouble(expected, actual), toText(expected), toText(actual));
+    };
+
+    check("file_path", "file_path", reference.path == engine.path, reference.filePath(), engine.filePath());
+    checkInt("functions.size", "functions.size", reference.functions.size(), engine.functions.size());
+    size_t common = std::min(reference.functions.size(), engine.functions.size());
+    for (size_t i = 0; i < common; ++i) {
+        FunctionView a = reference.functions[i];
+        FunctionView b = engine.functions[i];
+        std::string prefix = "functions[" + std::to_string(i) + "].";
+        check(prefix + "name", "functions[].name", a.name == b.name, std::string(a.name), std::string(b.name));
+        checkInt(prefix + "line_start", "functions[].line_start", a.line_start, b.line_start);
+        checkInt(prefix + "line_end", "functions[].line_end", a.line_end, b.line_end);
+        checkInt(prefix + "line_count", "functions[].line_count", a.line_count, b.line_count);
+        checkInt(prefix + "complexity", "functions[].complexity", a.complexity, b.complexity);
+    }
+    checkDouble("avg_function_length", reference.avg_function_length, engine.avg_function_length);
+    checkDouble("avg_function_complexity", reference.avg_function_complexity, engine.avg_function_complexity);
+    checkInt("total_lines", "total_lines", reference.total_lines, engine.total_lines);
+    checkInt("comment_lines", "comment_lines", reference.comment_lines, engine.comment_lines);
+    checkDouble("comment_coverage_ratio", reference.comment_coverage_ratio, engine.comment_coverage_ratio);
+    checkInt("naming_violations", "naming_violations", reference.naming_violations, engine.naming_violations);
+    checkInt("node_count", "node_count", reference.node_count, engine.node_count);
+    checkInt("max_depth", "max_depth", reference.max_depth, engine.max_depth);
+    checkDouble("shit_mountain_index", reference.shit_mountain_index, engine.shit_mountain_index);
+    return diffs;
+}
+
+/**
+ * @brief Parses `source` and compares one engine with the reference on it.
+ * Trees with syntax errors are compared too, since minimized snippets rarely parse cleanly.
+ * @return The differences; empty if the engines agree or the source yields no tree.
+ */
+static std::vector<Difference> diffSource(const Engine& engine, const std::string& path, const std::string& source,
+                                          const std::string& language) {
+    Language id = LanguageRegistry::fromName(language);
+    Parser parser;
+    parser.parse(source, id);
+    TSNode root = parser.getRootNode();
+    if (ts_node_is_null(root)) return {};
+    auto strategy = createStrategy(id);
+    FileMetrics expected = ReferenceAnalyzer(*strategy).analyze(root, path, source);
+    FileMetrics actual = engine.analyze(root, path, source, id);
+    return compare(expected, actual);
+}
+
+static void printDifferences(const std::vector<Difference>& diffs) {
+    for (const Difference& diff : diffs) {
+        std::cerr << "    " << diff.field << ": reference " << diff.reference << ", engine " << diff.engine << "\n";
+    }
+}
+
+/**
+ * @brief Shrinks a divergent source to a small snippet with the same first kind of divergence.
+ */
+static std::string minimize(const Engine& engine, const std::string& path, const std::string& source,
+                            const std::string& language, const std::string& kind, size_t maxTests) {
+    auto stillDiverges = [&](const DeltaDebug::Units& units) {
+        auto diffs = diffSource(engine, path, DeltaDebug::join(units), language);
+        return !diffs.empty() && diffs.front().kind == kind;
+    };
+    DeltaDebug::Units lines = DeltaDebug::minimize(DeltaDebug::splitLines(source), stillDiverges, maxTests);
+    std::string reduced = DeltaDebug::join(lines);
+    // Character-level passes are quadratic in the worst case, so only refine already small snippets.
+    if (reduced.size() <= 4096) {
+        reduced = DeltaDebug::join(DeltaDebug::minimize(DeltaDebug::splitChars(reduced), stillDiverges, maxTests));
+    }
+    return reduced;
+}
+
+/**
+ * @class Session
+ * @brief Checks inputs against every engine and records and minimizes divergences.
+ */
+class Session {
+public:
+    explicit Session(const DiffOptions& options) : options(options) {}
+
+    /// @return False once the failure limit is reached.
+    bool check(const std::string& name, const std::string& source, const std::string& language) {
+        ++inputs;
+        for (const Engine& engine : engines()) {
+            auto diffs = diffSource(engine, name, source, language);
+            if (diffs.empty()) continue;
+
+            ++failures;
+            std::cerr << "DIVERGENCE [" << engine.name << "] " << name << " (" << language << ")\n";
+            printDifferences(diffs);
+            if (options.minimize) record(engine, name, source, language, diffs.front().kind);
+            if (failures >= options.max_failures) return false;
+        }
+        return true;
+    }
+
+    size_t inputs = 0;
+    size_t failures = 0;
+
+private:
+    const DiffOptions& options;
+
+    void record(const Engine& engine, const std::string& name, const std::string& source, const std::string& language,
+                const std::string& kind) {
+        std::string snippet = minimize(engine, name, source, language, kind, options.max_tests);
+        std::error_code ec;
+        fs::create_directories(options.out_dir, ec);
+        fs::path out = fs::path(options.out_dir) /
+                       (std::to_string(failures) + "-" + engine.name + "-" + language + fs::path(name).extension().string());
+        std::ofstream(out, std::ios::binary) << snippet;
+        std::cerr << "  minimized to " << snippet.size() << " bytes: " << out.string() << "\n";
+        printDifferences(diffSource(engine, name, snippet, language));
+    }
+};
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char* argv[]) {
+    DiffOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--languages c,cpp,...] [--seeds N] [--files N] [--file-bytes N] "
+                     "[--path DIR]... [--descriptors PATH]... [--out-dir DIR] [--no-minimize] [--max-failures N] [--max-tests N]" << std::endl;
+        return 1;
+    }
+    // A descriptor redefining a built-in language is checked against the reference
+    // through its type-name lists, which validates the compiled symbol tables.
+    for (const auto& path : options.descriptors) {
+        std::vector<std::string> errors;
+        if (!LanguageDescriptors::loadPath(path, errors)) {
+            for (const auto& error : errors) std::cerr << "Error: Language descriptor " << error << std::endl;
+            return 1;
+        }
+    }
+
+    Session session(options);
+    bool more = true;
+
+    // Generated corpora: vary the shape with the seed so deep nesting, dense comments
+    // and short identifiers are all covered.
+    const IdentifierStyle styles[] = {IdentifierStyle::Snake, IdentifierStyle::Camel, IdentifierStyle::Short};
+    for (const auto& language : options.languages) {
+        for (int seed = 1; seed <= options.seeds && more; ++seed) {
+            CorpusSpec spec;
+            spec.language = language;
+            spec.files = options.files;
+            spec.file_bytes = options.file_bytes;
+            spec.seed = static_cast<uint64_t>(seed);
+            spec.nesting_depth = seed % 8;
+            spec.functions_per_file = 1 + seed * 3 % 25;
+            spec.comment_density = (seed % 5) * 0.15;
+            spec.identifier_style = styles[seed % 3];
+            CorpusGenerator generator(spec);
+            for (size_t i = 0; i < spec.files && more; ++i) {
+                std::string name = "seed" + std::to_string(seed) + "/" + generator.fileName(i);
+                more = session.check(name, generator.generateFile(i), language);
+            }
+        }
+    }
+
+    // Real source trees.
+    for (const auto& root : options.paths) {
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, ec), end; it != end && more; it.increment(ec)) {
+            if (ec || !it->is_regular_file()) continue;
+            std::string path = it->path().string();
+            Language language = getLanguageFromFile(path);
+            if (language == Language::Unsupported) continue;
+            more = session.check(path, readFile(it->path()), LanguageRegistry::name(language));
+        }
+    }
+
+    std::cerr << session.inputs << " inputs, " << engines().size() << " engine(s), " << session.failures
+              << " divergence(s)" << std::endl;
+    return session.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+/**
+ * @file MicroBenchMain.cpp
+ * @brief `cqa-microbench`: per-pass, per-language micro-benchmarks.
+ *
+ * Times Parser::parse, every Analyzer pass, calculateComplexity, each strategy's
+ * extractFunctionName and calculateFinalScore in isolation, on fixed inputs
+ * generated in memory by CorpusGenerator (no files, no network). Each benchmark
+ * is calibrated to a minimum repetition time, warmed up, then repeated; the
+ * report gives the median, MAD, min and mean time per operation, normalized per
+ * syntax tree node and per source byte.
+ *
+ * `--nesting` and `--functions` shape the input like cqa-bench's options, so the
+ * cost of deep trees can be measured: a pass or strategy whose per-node cost
+ * grows with depth shows up as rising ns/node as `--nesting` grows.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#include "AnalyzerProbe.h"
+#include "BenchStats.h"
+#include "CorpusGenerator.h"
+#include "Parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+/// Results are folded into this so the optimizer cannot drop the measured work.
+static volatile uint64_t g_sink = 0;
+
+/**
+ * @struct MicroOptions
+ * @brief Command-line options for cqa-microbench.
+ */
+struct MicroOptions {
+    std::vector<std::string> languages = CorpusGenerator::languages();
+    std::string filter;          ///< Only run benchmarks whose name contains this.
+    size_t input_bytes = 32 * 1024;
+    int functions = CorpusSpec().functions_per_file;
+    int nesting_depth = CorpusSpec().nesting_depth;
+    bool arrow_functions = false; ///< JavaScript/TypeScript functions as `const f = () => {}`.
+    uint64_t seed = 1;
+    int warmup = 2;              ///< Unrecorded repetitions before measuring.
+    int repetitions = 15;        ///< Recorded repetitions.
+    double min_time_ms = 10.0;   ///< Each repetition runs the operation at least this long.
+    std::string json_path;       ///< Also write results as JSON; empty disables.
+};
+
+/**
+ * @struct Fixture
+ * @brief One language's fixed input: source, parsed tree and function nodes.
+ */
+struct Fixture {
+    std::string language;
+    Language id = Language::Unsupported;
+    std::string source;
+    Parser parser;
+    TSNode root;
+    std::unique_ptr<Analyzer> analyzer;
+    std::vector<TSNode> functions;
+    std::vector<std::vector<TSNode>> ancestors; ///< Per function, outermost first, for extractFunctionName.
+    FileMetrics metrics; ///< Fully analyzed metrics, the input for scoring.
+    int nodes = 0;
+};
+
+/**
+ * @struct MicroResult
+ * @brief One benchmark's measurements, in nanoseconds per operation.
+ */
+struct MicroResult {
+    std::string name;
+    std::string language;
+    uint64_t iterations = 0; ///< Operations per repetition after calibration.
+    SampleStats ns;
+    double ns_per_node = 0.0;
+    double ns_per_byte = 0.0;
+};
+
+static std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static bool parseArguments(int argc, char* argv[], MicroOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--languages" && hasValue) {
+                options.languages = splitList(argv[++i]);
+                const auto& known = CorpusGenerator::languages();
+                for (const auto& language : options.languages) {
+                    if (std::find(known.begin(), known.end(), language) == known.end()) return false;
+                }
+            } else if (arg == "--filter" && hasValue) {
+                options.filter = argv[++i];
+            } else if (arg == "--input-bytes" && hasValue) {
+                options.input_bytes = std::stoul(argv[++i]);
+            } else if (arg == "--functions" && hasValue) {
+                options.functions = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--nesting" && hasValue) {
+                options.nesting_depth = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--arrow-functions") {
+                options.arrow_functions = true;
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--warmup" && hasValue) {
+                options.warmup = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--repetitions" && hasValue) {
+                options.repetitions = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--min-time-ms" && hasValue) {
+                options.min_time_ms = std::stod(argv[++i]);
+            } else if (arg == "--json" && hasValue) {
+                options.json_path = argv[++i];
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !options.languages.empty();
+}
+
+static void collectFunctions(TSNode node, const std::vector<std::string>& types, std::vector<TSNode>& path, Fixture& out) {
+    if (std::find(types.begin(), types.end(), ts_node_type(node)) != types.end()) {
+        out.functions.push_back(node);
+        out.ancestors.push_back(path);
+        return;
+    }
+    path.push_back(node);
+    for (uint32_t i = 0; i < ts_node_child_count(node); ++i) collectFunctions(ts_node_child(node, i), types, path, out);
+    path.pop_back();
+}
+
+static bool prepare(Fixture& fixture, const MicroOptions& options) {
+    CorpusSpec spec;
+    spec.language = fixture.language;
+    spec.file_bytes = options.input_bytes;
+    spec.functions_per_file = options.functions;
+    spec.nesting_depth = options.nesting_depth;
+    spec.arrow_functions = options.arrow_functions;
+    spec.seed = options.seed;
+    fixture.source = CorpusGenerator(spec).generateFile(0);
+    fixture.id = LanguageRegistry::fromName(fixture.language);
+    if (!fixture.parser.parse(fixture.source, fixture.id)) return false;
+    fixture.root = fixture.parser.getRootNode();
+    fixture.analyzer = std::make_unique<Analyzer>(createStrategy(fixture.id));
+    fixture.metrics = fixture.analyzer->analyze(fixture.root, "bench", fixture.source);
+    fixture.nodes = fixture.metrics.node_count;
+    std::vector<TSNode> path;
+    collectFunctions(fixture.root, AnalyzerProbe::strategy(*fixture.analyzer).getFunctionDefinitionTypes(), path,
+                     fixture);
+    return true;
+}
+
+/**
+ * @brief Runs `operation` in calibrated batches and summarizes the time per operation.
+ */
+static MicroResult measure(const std::string& name, const Fixture& fixture, const MicroOptions& options,
+                           const std::function<void()>& operation) {
+    MicroResult result;
+    result.name = name;
+    result.language = fixture.language;
+
+    auto timeBatch = [&](uint64_t iterations) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) operation();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    // Grow the batch until one repetition lasts at least min_time_ms.
+    uint64_t iterations = 1;
+    double minNs = options.min_time_ms * 1e6;
+    for (double ns = timeBatch(iterations); ns < minNs && iterations < (1ull << 30);) {
+        double factor = ns > 0 ? std::min(10.0, std::max(1.5, minNs * 1.2 / ns)) : 10.0;
+        iterations = static_cast<uint64_t>(iterations * factor) + 1;
+        ns = timeBatch(iterations);
+    }
+    result.iterations = iterations;
+
+    for (int w = 0; w < options.warmup; ++w) timeBatch(iterations);
+    std::vector<double> samples;
+    for (int r = 0; r < options.repetitions; ++r) samples.push_back(timeBatch(iterations) / iterations);
+    result.ns = summarize(samples);
+    result.ns_per_node = fixture.nodes ? result.ns.median / fixture.nodes : 0.0;
+    result.ns_per_byte = fixture.source.empty() ? 0.0 : result.ns.median / fixture.source.size();
+    return result;
+}
+
+static std::vector<MicroResult> runFixture(Fixture& fixture, const MicroOptions& options) {
+    Analyzer& analyzer = *fixture.analyzer;
+    const LanguageStrategy& strategy = AnalyzerProbe::strategy(analyzer);
+    const std::string& source = fixture.source;
+
+    std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+        {"parse", [&]() {
+             Parser parser;
+             g_sink = g_sink + parser.parse(source, fixture.id);
+         }},
+        {"analyzeFunctions", [&]() {
+             FileMetrics metrics;
+             AnalyzerProbe::analyzeFunctions(analyzer, fixture.root, metrics, source);
+             g_sink = g_sink + metrics.functions.size();
+         }},
+        {"calculateComplexity", [&]() {
+             for (TSNode node : fixture.functions) g_sink = g_sink + AnalyzerProbe::calculateComplexity(analyzer, node);
+         }},
+        {"analyzeFileWideMetrics", [&]() {
+             FileMetrics metrics;
+             AnalyzerProbe::analyzeFileWideMetrics(analyzer, fixture.root, metrics);
+             g_sink = g_sink + metrics.comment_lines;
+         }},
+        {"analyzeNaming", [&]() {
+             FileMetrics metrics;
+             AnalyzerProbe::analyzeNaming(analyzer, fixture.root, metrics, source);
+             g_sink = g_sink + metrics.naming_violations;
+         }},
+        {"extractFunctionName", [&]() {
+             for (size_t f = 0; f < fixture.functions.size(); ++f) {
+                 const std::vector<TSNode>& ancestors = fixture.ancestors[f];
+                 NodeContext context(ancestors.data(), ancestors.size());
+                 g_sink = g_sink + strategy.extractFunctionName(fixture.functions[f], source, context).size();
+             }
+         }},
+        {"calculateFinalScore", [&]() {
+             FileMetrics metrics = fixture.metrics;
+             AnalyzerProbe::calculateFinalScore(analyzer, metrics);
+             g_sink = g_sink + static_cast<uint64_t>(metrics.shit_mountain_index);
+         }},
+    };
+
+    std::vector<MicroResult> results;
+    for (const auto& [name, operation] : benchmarks) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) continue;
+        results.push_back(measure(name, fixture, options, operation));
+    }
+    return results;
+}
+
+static void printTable(const std::vector<MicroResult>& results) {
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(24) << "Benchmark" << std::setw(12) << "Language" << std::right
+              << std::setw(14) << "Median ns/op" << std::setw(8) << "MAD %" << std::setw(14) << "Min ns/op"
+              << std::setw(14) << "Mean ns/op" << std::setw(10) << "ns/node" << std::setw(10) << "ns/byte" << "\n";
+    for (const MicroResult& result : results) {
+        std::cout << std::left << std::setw(24) << result.name << std::setw(12) << result.language << std::right
+                  << std::setw(14) << result.ns.median << std::setw(8) << result.ns.relativeMad() * 100
+                  << std::setw(14) << result.ns.min << std::setw(14) << result.ns.mean << std::setprecision(3)
+                  << std::setw(10) << result.ns_per_node << std::setw(10) << result.ns_per_byte
+                  << std::setprecision(1) << "\n";
+    }
+}
+
+static bool writeJson(const std::string& path, const MicroOptions& options, const std::vector<MicroResult>& results) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fprintf(out, "{\n  \"schema\": 1,\n  \"config\": {\"input_bytes\": %zu, \"seed\": %llu, \"warmup\": %d, "
+                      "\"repetitions\": %d, \"min_time_ms\": %.3f},\n  \"results\": [\n",
+                 options.input_bytes, static_cast<unsigned long long>(options.seed), options.warmup,
+                 options.repetitions, options.min_time_ms);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const MicroResult& r = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"language\": \"%s\", \"iterations\": %llu, \"median_ns\": %.3f, "
+                          "\"mad_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f, "
+                          "\"ns_per_node\": %.5f, \"ns_per_byte\": %.5f}%s\n",
+                     r.name.c_str(), r.language.c_str(), static_cast<unsigned long long>(r.iterations), r.ns.median,
+                     r.ns.mad, r.ns.min, r.ns.max, r.ns.mean, r.ns.stddev, r.ns_per_node, r.ns_per_byte,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fputs("  ]\n}\n", out);
+    return std::fclose(out) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    MicroOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--languages c,cpp,...] [--filter NAME] [--input-bytes N] [--functions N] "
+                     "[--nesting N] [--arrow-functions] [--seed N] "
+                     "[--warmup N] [--repetitions N] [--min-time-ms MS] [--json results.json]" << std::endl;
+        return 1;
+    }
+
+    std::vector<MicroResult> results;
+    for (const auto& language : options.languages) {
+        Fixture fixture;
+        fixture.language = language;
+        if (!prepare(fixture, options)) {
+            std::cerr << "[Warning] Could not parse the " << language << " input; skipping." << std::endl;
+            continue;
+        }
+        std::cerr << language << ": " << fixture.source.size() << " bytes, " << fixture.nodes << " nodes, depth " << fixture.metrics.max_depth << ", "
+                  << fixture.functions.size() << " functions\n";
+        for (MicroResult& result : runFixture(fixture, options)) results.push_back(std::move(result));
+    }
+
+    printTable(results);
+    if (!options.json_path.empty() && !writeJson(options.json_path, options, results)) {
+        std::cerr << "Error: Could not write results: " << options.json_path << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+# bench/PgoBuild.cmake
+# Driven by the `pgo` target (cmake -P). Builds, under WORK_DIR:
+#   baseline/  an ordinary Release build, the reference for the throughput delta
+#   build/     first instrumented, then trained and rebuilt in place with the profile and LTO
+# Rebuilding in the same directory keeps object paths stable, which GCC needs to match .gcda files.
+#
+# Required: SOURCE_DIR, WORK_DIR, GENERATOR, C_COMPILER, CXX_COMPILER, COMPILER_ID. Optional: REPEAT.
+
+cmake_minimum_required(VERSION 3.16)
+
+foreach(var SOURCE_DIR WORK_DIR GENERATOR C_COMPILER CXX_COMPILER COMPILER_ID)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "PgoBuild.cmake: ${var} is not set")
+    endif()
+endforeach()
+if(NOT DEFINED REPEAT)
+    set(REPEAT 5)
+endif()
+
+set(BASELINE_DIR ${WORK_DIR}/baseline)
+set(BUILD_DIR ${WORK_DIR}/build)
+set(PROFILE_DIR ${WORK_DIR}/profile)
+set(TRAINING_DIR ${WORK_DIR}/training)
+
+# Runs a command and stops the whole build if it fails.
+function(run step)
+    message(STATUS "[pgo] ${step}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "[pgo] ${step} failed (${result})")
+    endif()
+endfunction()
+
+function(configure_and_build dir)
+    cmake_parse_arguments(ARG "" "" "OPTIONS;TARGETS" ${ARGN})
+    run("Configuring ${dir}" ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${dir} -G ${GENERATOR}
+        -DCMAKE_BUILD_TYPE=Release
+        -DCMAKE_C_COMPILER=${C_COMPILER}
+        -DCMAKE_CXX_COMPILER=${CXX_COMPILER}
+        -DCQA_BUILD_BENCHMARKS=ON
+        ${ARG_OPTIONS})
+    run("Building ${dir}" ${CMAKE_COMMAND} --build ${dir} --config Release --parallel --target ${ARG_TARGETS})
+endfunction()
+
+file(REMOVE_RECURSE ${PROFILE_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR})
+
+# 1. Reference build, also used to generate the training corpus.
+configure_and_build(${BASELINE_DIR} OPTIONS -DCQA_PGO= -DCQA_ENABLE_LTO=OFF TARGETS cqa-bench)
+
+# 2. Instrumented build.
+configure_and_build(${BUILD_DIR} OPTIONS -DCQA_PGO=generate -DCQA_PGO_PROFILE=${PROFILE_DIR} -DCQA_ENABLE_LTO=OFF
+                    TARGETS cqa)
+
+# 3. Training. The corpus uses a different seed from the benchmark, so the reported delta is
+#    not measured on the exact files the profile was trained on. It covers all eight grammars.
+file(REMOVE_RECURSE ${TRAINING_DIR})
+run("Generating the training corpus" ${BASELINE_DIR}/cqa-bench --seed 7 --files 60 --repeat 1
+    --work-dir ${TRAINING_DIR} --keep --out ${WORK_DIR}/training-corpus.json)
+# The directory run trains the worker pool, and the single-file run trains the
+# calling-thread fast path and --compact output.
+file(GLOB_RECURSE training_files ${TRAINING_DIR}/*)
+list(GET training_files 0 single_file)
+run("Training on the whole corpus" ${BUILD_DIR}/cqa ${TRAINING_DIR} OUTPUT_FILE ${WORK_DIR}/training-report.txt)
+run("Training on a single file" ${BUILD_DIR}/cqa --compact ${single_file} OUTPUT_QUIET)
+
+# 4. Clang writes raw profiles that must be merged; GCC reads its .gcda files directly.
+if(COMPILER_ID MATCHES "Clang")
+    get_filename_component(compiler_dir ${CXX_COMPILER} DIRECTORY)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS ${compiler_dir})
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "[pgo] llvm-profdata not found next to ${CXX_COMPILER} or on PATH")
+    endif()
+    file(GLOB raw_profiles ${PROFILE_DIR}/*.profraw)
+    set(profile ${PROFILE_DIR}/cqa.profdata)
+    run("Merging ${PROFILE_DIR}" ${LLVM_PROFDATA} merge -output=${profile} ${raw_profiles})
+else()
+    set(profile ${PROFILE_DIR})
+endif()
+
+# 5. Optimized rebuild, grammars included.
+configure_and_build(${BUILD_DIR} OPTIONS -DCQA_PGO=use -DCQA_PGO_PROFILE=${profile} -DCQA_ENABLE_LTO=ON
+                    TARGETS cqa cqa-bench)
+
+# 6. Throughput delta. cqa-bench --baseline prints one line per corpus and metric.
+run("Benchmarking the baseline build" ${BASELINE_DIR}/cqa-bench --repeat ${REPEAT} --out ${WORK_DIR}/baseline.json)
+message(STATUS "[pgo] Optimized build compared with the baseline build:")
+execute_process(COMMAND ${BUILD_DIR}/cqa-bench --baseline ${WORK_DIR}/baseline.json --repeat ${REPEAT} --out ${WORK_DIR}/optimized.json
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(WARNING "[pgo] The optimized build is slower than the baseline on some corpora; see the table above")
+endif()
+message(STATUS "[pgo] Optimized cqa: ${BUILD_DIR}/cqa")
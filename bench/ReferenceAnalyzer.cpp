@@ -0,0 +1,192 @@
+// bench/ReferenceAnalyzer.cpp
+// Copied from src/Analyzer.cpp; keep in sync only deliberately (see ReferenceAnalyzer.h).
+#include "ReferenceAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+static std::string getNodeText(TSNode node, const std::string &source)
+{
+    if (ts_node_is_null(node))
+        return "";
+    uint32_t start = ts_node_start_byte(node);
+    uint32_t end = ts_node_end_byte(node);
+    return source.substr(start, end - start);
+}
+
+ReferenceAnalyzer::ReferenceAnalyzer(const LanguageStrategy &strategy) : langStrategy(strategy) {}
+
+FileMetrics ReferenceAnalyzer::analyze(TSNode rootNode, const std::string &filePath, const std::string &sourceCode) const
+{
+    FileMetrics metrics;
+    metrics.path = PathTable::global().intern(filePath);
+    analyzeFunctions(rootNode, metrics, sourceCode);
+    analyzeFileWideMetrics(rootNode, metrics);
+    analyzeNaming(rootNode, metrics, sourceCode);
+    calculateFinalScore(metrics);
+    return metrics;
+}
+
+void ReferenceAnalyzer::analyzeFunctions(TSNode node, FileMetrics &metrics, const std::string &sourceCode) const
+{
+    const auto &funcTypes = langStrategy.getFunctionDefinitionTypes();
+    const char *nodeType = ts_node_type(node);
+    if (std::find(funcTypes.begin(), funcTypes.end(), std::string(nodeType)) != funcTypes.end())
+    {
+        if (!langStrategy.isSpecialFunction(node))
+        {
+            analyzeSingleFunction(node, metrics, sourceCode);
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < ts_node_child_count(node); ++i)
+    {
+        analyzeFunctions(ts_node_child(node, i), metrics, sourceCode);
+    }
+}
+
+void ReferenceAnalyzer::analyzeFileWideMetrics(TSNode node, FileMetrics &metrics, int depth) const
+{
+    metrics.node_count++;
+    metrics.max_depth = std::max(metrics.max_depth, depth);
+    if (ts_node_is_null(ts_node_parent(node)))
+    {
+        metrics.total_lines = ts_node_end_point(node).row + 1;
+    }
+    if (strcmp(ts_node_type(node), "comment") == 0)
+    {
+        metrics.comment_lines += (ts_node_end_point(node).row - ts_node_start_point(node).row + 1);
+    }
+    for (uint32_t i = 0; i < ts_node_child_count(node); ++i)
+    {
+        analyzeFileWideMetrics(ts_node_child(node, i), metrics, depth + 1);
+    }
+}
+
+void ReferenceAnalyzer::analyzeNaming(TSNode node, FileMetrics &metrics, const std::string &sourceCode) const
+{
+    const char *type = ts_node_type(node);
+    if (strcmp(type, "identifier") == 0)
+    {
+        std::string name = getNodeText(node, sourceCode);
+        if (name.length() <= 2)
+        {
+            static const std::set<std::string> whitelist = {
+                "i", "j", "k", "x", "y", "z", "os", "fs", "it", "c", "ts", "js"};
+            if (whitelist.find(name) == whitelist.end())
+            {
+                metrics.naming_violations++;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < ts_node_child_count(node); ++i)
+    {
+        analyzeNaming(ts_node_child(node, i), metrics, sourceCode);
+    }
+}
+
+void ReferenceAnalyzer::analyzeSingleFunction(TSNode funcNode, FileMetrics &metrics, const std::string &sourceCode) const
+{
+    FunctionMetric func;
+    func.line_start = ts_node_start_point(funcNode).row + 1;
+    func.line_end = ts_node_end_point(funcNode).row + 1;
+    func.line_count = func.line_end - func.line_start + 1;
+    // The ancestors come from tree-sitter itself, independently of the Analyzer's stack.
+    std::vector<TSNode> ancestors;
+    for (TSNode parent = ts_node_parent(funcNode); !ts_node_is_null(parent); parent = ts_node_parent(parent))
+        ancestors.insert(ancestors.begin(), parent);
+    func.name = langStrategy.extractFunctionName(funcNode, sourceCode, NodeContext(ancestors.data(), ancestors.size()));
+    if (func.name.empty())
+        func.name = "[anonymous/unknown]";
+    func.complexity = calculateComplexity(funcNode);
+    metrics.functions.push_back(func);
+}
+
+int ReferenceAnalyzer::calculateComplexity(TSNode node) const
+{
+    int complexity = 0;
+    const char *type = ts_node_type(node);
+    const auto &complexityTypes = langStrategy.getComplexityNodeTypes();
+    if (std::find(complexityTypes.begin(), complexityTypes.end(), std::string(type)) != complexityTypes.end())
+    {
+        complexity = 1;
+    }
+    else if (langStrategy.isLogicalOperator(node))
+    {
+        complexity = 1;
+    }
+    for (uint32_t i = 0; i < ts_node_child_count(node); ++i)
+    {
+        complexity += calculateComplexity(ts_node_child(node, i));
+    }
+    const auto &funcTypes = langStrategy.getFunctionDefinitionTypes();
+    if (std::find(funcTypes.begin(), funcTypes.end(), std::string(type)) != funcTypes.end())
+    {
+        return complexity + 1;
+    }
+    return complexity;
+}
+
+void ReferenceAnalyzer::calculateFinalScore(FileMetrics &metrics) const
+{
+    // --- Step 1: Calculate raw aggregated metrics (unchanged) ---
+    if (!metrics.functions.empty())
+    {
+        double total_length = 0, total_complexity = 0;
+        for (const auto &func : metrics.functions)
+        {
+            total_length += func.line_count;
+            total_complexity += func.complexity;
+        }
+        metrics.avg_function_length = total_length / metrics.functions.size();
+        metrics.avg_function_complexity = total_complexity / metrics.functions.size();
+    }
+    if (metrics.total_lines > 0)
+    {
+        metrics.comment_coverage_ratio = (double)metrics.comment_lines / metrics.total_lines * 100.0;
+    }
+
+    // --- Step 2: Calculate 0-100 quality scores for each dimension ---
+    double naming_score = std::max(0.0, 100.0 - (double)metrics.naming_violations * 5.0);
+
+    // --- Step 3: Apply the correct scoring model based on context ---
+
+    // MODEL A: For files with no analyzable functions (e.g., header files, interfaces)
+    if (metrics.functions.empty())
+    {
+        // For headers, high comment coverage is ALWAYS good. We use a simple linear score.
+        // A ratio of 30% or more gets a perfect score. This rewards well-documented headers.
+        double comment_score = std::min(100.0, (metrics.comment_coverage_ratio / 30.0) * 100.0);
+
+        // Quality is determined only by comments and naming.
+        double total_quality_score = (comment_score * 0.7) + (naming_score * 0.3);
+        metrics.shit_mountain_index = 100.0 - total_quality_score;
+        return;
+    }
+
+    // MODEL B: For files WITH analyzable functions (e.g., source files)
+    // Complexity Score (bell curve, 1 is best)
+    double complexity_score = std::max(0.0, 100.0 - (metrics.avg_function_complexity - 1.0) / (20.0 - 1.0) * 100.0);
+
+    // Length Score (bell curve, 10 is best)
+    double length_score = std::max(0.0, 100.0 - (metrics.avg_function_length - 10.0) / (100.0 - 10.0) * 100.0);
+
+    // Comment Score (bell curve, 15% is ideal)
+    double comment_score = std::max(0.0, 100.0 - std::abs(metrics.comment_coverage_ratio - 15.0) / 15.0 * 100.0);
+
+    // --- Step 4: Calculate final weighted score for Model B ---
+    const double COMPLEXITY_WEIGHT = 0.50;
+    const double LENGTH_WEIGHT = 0.15;
+    const double COMMENT_WEIGHT = 0.15;
+    const double NAMING_WEIGHT = 0.20;
+
+    double total_quality_score = (complexity_score * COMPLEXITY_WEIGHT) +
+                                 (length_score * LENGTH_WEIGHT) +
+                                 (comment_score * COMMENT_WEIGHT) +
+                                 (naming_score * NAMING_WEIGHT);
+
+    metrics.shit_mountain_index = 100.0 - total_quality_score;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file ReferenceAnalyzer.h
+ * @brief The original recursive analysis engine, frozen as a correctness oracle.
+ *
+ * This is a verbatim copy of the Analyzer passes and scoring model as they were
+ * before any optimization work: one recursive walk per pass, string-compared
+ * node types, no caching. It deliberately has no instrumentation and must not be
+ * "improved" — its only job is to define the right answer that `cqa-difftest`
+ * holds the production Analyzer (and any other engine) to. It shares the
+ * LanguageStrategy classes, so strategy changes are visible to both sides.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef REFERENCE_ANALYZER_H
+#define REFERENCE_ANALYZER_H
+
+#include "LanguageStrategy.h"
+#include "Metrics.h"
+#include <tree_sitter/api.h>
+#include <string>
+
+class ReferenceAnalyzer {
+public:
+    explicit ReferenceAnalyzer(const LanguageStrategy& strategy);
+    FileMetrics analyze(TSNode rootNode, const std::string& filePath, const std::string& sourceCode) const;
+
+private:
+    const LanguageStrategy& langStrategy;
+
+    void analyzeFunctions(TSNode node, FileMetrics& metrics, const std::string& sourceCode) const;
+    void analyzeSingleFunction(TSNode funcNode, FileMetrics& metrics, const std::string& sourceCode) const;
+    void analyzeFileWideMetrics(TSNode node, FileMetrics& metrics, int depth = 0) const;
+    void analyzeNaming(TSNode node, FileMetrics& metrics, const std::string& sourceCode) const;
+    int calculateComplexity(TSNode node) const;
+    void calculateFinalScore(FileMetrics& metrics) const;
+};
+
+#endif // REFERENCE_ANALYZER_H
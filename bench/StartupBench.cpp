@@ -0,0 +1,238 @@
+/**
+ * @file StartupBench.cpp
+ * @brief `cqa-startup-bench`: exec-to-exit latency of single-file `cqa` runs.
+ *
+ * Editor and pre-commit integrations start a fresh `cqa` process per file, so
+ * what they wait for is process startup, static initialization, grammar setup,
+ * the analysis and exit, not analysis throughput. This benchmark writes one
+ * generated file per language, then repeatedly spawns `cqa --compact <file>`
+ * and times each spawn until its exit status is collected. Spawning
+ * `true` the same way gives the floor set by the OS, which is reported
+ * alongside so that numbers from different machines can be read in context.
+ *
+ * POSIX only (posix_spawnp / waitpid).
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#include "BenchStats.h"
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+/**
+ * @struct StartupOptions
+ * @brief Command-line options for cqa-startup-bench.
+ */
+struct StartupOptions {
+    std::string cqa_path;         ///< Binary under test; empty uses `cqa` next to this executable.
+    std::vector<std::string> languages = CorpusGenerator::languages();
+    size_t file_bytes = 4096;     ///< Size of the analyzed file; small, as in an editor save.
+    uint64_t seed = 1;
+    int warmup = 3;               ///< Unrecorded runs, so the binary and file are in the page cache.
+    int runs = 30;
+    double max_median_ms = 0.0;   ///< Fail if any language's median exceeds this; 0 disables.
+    std::string json_path;        ///< Also write results as JSON; empty disables.
+};
+
+/**
+ * @struct StartupResult
+ * @brief Latencies of one command, in milliseconds.
+ */
+struct StartupResult {
+    std::string name;
+    SampleStats ms;
+};
+
+static std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static bool parseArguments(int argc, char* argv[], StartupOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--cqa" && hasValue) {
+                options.cqa_path = argv[++i];
+            } else if (arg == "--languages" && hasValue) {
+                options.languages = splitList(argv[++i]);
+                const auto& known = CorpusGenerator::languages();
+                for (const auto& language : options.languages) {
+                    if (std::find(known.begin(), known.end(), language) == known.end()) return false;
+                }
+            } else if (arg == "--file-bytes" && hasValue) {
+                options.file_bytes = std::stoul(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--warmup" && hasValue) {
+                options.warmup = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--runs" && hasValue) {
+                options.runs = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--max-median-ms" && hasValue) {
+                options.max_median_ms = std::stod(argv[++i]);
+            } else if (arg == "--json" && hasValue) {
+                options.json_path = argv[++i];
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !options.languages.empty();
+}
+
+/**
+ * @brief Spawns `argv` with stdout and stderr sent to /dev/null and waits for it.
+ * @return Milliseconds from spawn to reaped exit, or a negative value if it could not run or failed.
+ */
+static double timeProcess(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid;
+    int spawned = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    int status = 0;
+    if (spawned == 0) waitpid(pid, &status, 0);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (spawned != 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1.0;
+    return ms;
+}
+
+/**
+ * @brief Runs a command `warmup + runs` times and summarizes the recorded latencies.
+ * @return False if any run failed.
+ */
+static bool measure(const std::vector<std::string>& args, const StartupOptions& options, SampleStats& stats) {
+    std::vector<double> samples;
+    for (int r = 0; r < options.warmup + options.runs; ++r) {
+        double ms = timeProcess(args);
+        if (ms < 0) return false;
+        if (r >= options.warmup) samples.push_back(ms);
+    }
+    stats = summarize(std::move(samples));
+    return true;
+}
+
+static void printTable(const std::vector<StartupResult>& results) {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(14) << "Command" << std::right << std::setw(12) << "Median ms"
+              << std::setw(8) << "MAD %" << std::setw(10) << "Min ms" << std::setw(10) << "Max ms" << "\n";
+    for (const StartupResult& result : results) {
+        std::cout << std::left << std::setw(14) << result.name << std::right << std::setw(12) << result.ms.median
+                  << std::setw(8) << result.ms.relativeMad() * 100 << std::setw(10) << result.ms.min
+                  << std::setw(10) << result.ms.max << "\n";
+    }
+}
+
+static bool writeJson(const std::string& path, const StartupOptions& options, const std::vector<StartupResult>& results) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fprintf(out, "{\n  \"schema\": 1,\n  \"config\": {\"file_bytes\": %zu, \"seed\": %llu, \"warmup\": %d, "
+                      "\"runs\": %d},\n  \"results\": [\n",
+                 options.file_bytes, static_cast<unsigned long long>(options.seed), options.warmup, options.runs);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const StartupResult& r = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"median_ms\": %.4f, \"mad_ms\": %.4f, \"min_ms\": %.4f, "
+                          "\"max_ms\": %.4f, \"mean_ms\": %.4f}%s\n",
+                     r.name.c_str(), r.ms.median, r.ms.mad, r.ms.min, r.ms.max, r.ms.mean,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fputs("  ]\n}\n", out);
+    return std::fclose(out) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    StartupOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--cqa PATH] [--languages c,cpp,...] [--file-bytes N] [--seed N] "
+                     "[--warmup N] [--runs N] [--max-median-ms MS] [--json results.json]" << std::endl;
+        return 1;
+    }
+    if (options.cqa_path.empty()) {
+        std::error_code ec;
+        options.cqa_path = (fs::absolute(argv[0], ec).parent_path() / "cqa").string();
+    }
+
+    fs::path directory = fs::temp_directory_path() / ("cqa-startup-bench-" + std::to_string(getpid()));
+    fs::create_directories(directory);
+
+    std::vector<StartupResult> results;
+    StartupResult floor;
+    floor.name = "true";
+    if (!measure({"true"}, options, floor.ms)) {
+        std::cerr << "Error: Could not spawn true" << std::endl;
+        return 1;
+    }
+    results.push_back(floor);
+
+    bool ok = true;
+    for (const auto& language : options.languages) {
+        CorpusSpec spec;
+        spec.language = language;
+        spec.files = 1;
+        spec.file_bytes = options.file_bytes;
+        spec.seed = options.seed;
+        CorpusGenerator generator(spec);
+        fs::path file = directory / generator.fileName(0);
+        std::ofstream(file, std::ios::binary) << generator.generateFile(0);
+
+        StartupResult result;
+        result.name = language;
+        if (!measure({options.cqa_path, "--compact", file.string()}, options, result.ms)) {
+            std::cerr << "Error: " << options.cqa_path << " failed on " << file.string() << std::endl;
+            ok = false;
+            break;
+        }
+        if (options.max_median_ms > 0 && result.ms.median > options.max_median_ms) {
+            std::cerr << "[Warning] " << language << ": median " << result.ms.median << " ms exceeds "
+                      << options.max_median_ms << " ms" << std::endl;
+            ok = false;
+        }
+        results.push_back(std::move(result));
+    }
+
+    std::error_code ec;
+    fs::remove_all(directory, ec);
+
+    printTable(results);
+    if (!options.json_path.empty() && !writeJson(options.json_path, options, results)) {
+        std::cerr << "Error: Could not write results: " << options.json_path << std::endl;
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+# bench/TraceCodegenCheck.cmake
+# Run by the trace-codegen test (cmake -P). Checks the promise in src/Trace.h: with
+# CQA_ENABLE_TRACING=0, the instrumented sources compile to exactly the code they would
+# have if the CQA_TRACE_* lines had never been written. For each source it builds, under WORK_DIR:
+#   traced/    the source as it is, with CQA_ENABLE_TRACING=0
+#   stripped/  a copy with every CQA_TRACE_* statement line removed
+# and compares the disassembly of every function in the two objects.
+#
+# Required: SOURCE_DIR, WORK_DIR, CXX_COMPILER, OBJDUMP, INCLUDE_DIR (tree-sitter headers).
+# Optional: SOURCES (relative to SOURCE_DIR, default: every instrumented source).
+
+cmake_minimum_required(VERSION 3.16)
+
+foreach(var SOURCE_DIR WORK_DIR CXX_COMPILER OBJDUMP INCLUDE_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "TraceCodegenCheck.cmake: ${var} is not set")
+    endif()
+endforeach()
+if(NOT DEFINED SOURCES)
+    set(SOURCES src/Analyzer.cpp src/Parser.cpp src/Pipeline.cpp src/main.cpp)
+endif()
+
+# Returns the disassembly of an object without its header, which names the object file.
+function(disassemble object out_var)
+    execute_process(COMMAND ${OBJDUMP} -d --no-show-raw-insn ${object}
+                    OUTPUT_VARIABLE listing RESULT_VARIABLE result ERROR_VARIABLE error)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "[trace-codegen] objdump failed on ${object}: ${error}")
+    endif()
+    string(FIND "${listing}" "Disassembly of section" start)
+    if(start LESS 0)
+        message(FATAL_ERROR "[trace-codegen] ${object} has no code")
+    endif()
+    string(SUBSTRING "${listing}" ${start} -1 listing)
+    set(${out_var} "${listing}" PARENT_SCOPE)
+endfunction()
+
+# Lists the functions whose disassembly differs, for the failure message.
+# first_var and second_var name variables holding disassemble() output.
+function(differing_functions first_var second_var out_var)
+    # Offsets shift after the first difference, so compare the instructions only.
+    string(REGEX REPLACE "\n *[0-9a-f]+:\t" "\n" first "${${first_var}}")
+    string(REGEX REPLACE "\n *[0-9a-f]+:\t" "\n" second "${${second_var}}")
+    set(names)
+    foreach(listing first second)
+        # One "<symbol>:" header per function; split on it and key each body by its symbol.
+        string(REGEX MATCHALL "\n[0-9a-f]+ <[^>\n]+>:\n" headers "${${listing}}")
+        foreach(header ${headers})
+            string(REGEX REPLACE "\n[0-9a-f]+ <([^>\n]+)>:\n" "\\1" name "${header}")
+            list(APPEND names "${name}")
+        endforeach()
+    endforeach()
+    list(REMOVE_DUPLICATES names)
+    set(differing)
+    foreach(name ${names})
+        foreach(listing first second)
+            string(FIND "${${listing}}" "<${name}>:\n" at)
+            if(at LESS 0)
+                set(body_${listing} "")
+            else()
+                string(SUBSTRING "${${listing}}" ${at} -1 body)
+                string(FIND "${body}" "\n\n" end)
+                string(SUBSTRING "${body}" 0 ${end} body_${listing})
+            endif()
+        endforeach()
+        if(NOT body_first STREQUAL body_second)
+            list(APPEND differing "${name}")
+        endif()
+    endforeach()
+    set(${out_var} "${differing}" PARENT_SCOPE)
+endfunction()
+
+set(failed FALSE)
+foreach(source ${SOURCES})
+    get_filename_component(name ${source} NAME)
+    get_filename_component(stem ${source} NAME_WE)
+    file(READ ${SOURCE_DIR}/${source} text)
+
+    # Every hook is a statement on a line of its own; CQA_ENABLE_TRACING=0 must leave no trace of it.
+    string(REGEX MATCHALL "\n[ \t]*CQA_TRACE_[A-Z_]+\\(" hooks "${text}")
+    list(LENGTH hooks hook_count)
+    if(hook_count EQUAL 0)
+        message(FATAL_ERROR "[trace-codegen] ${source} has no CQA_TRACE_* lines to check")
+    endif()
+    string(REGEX REPLACE "\n[ \t]*CQA_TRACE_[A-Z_]+\\([^\n]*\\);[ \t]*" "" stripped "${text}")
+    if(stripped MATCHES "CQA_TRACE_[A-Z_]+\\(")
+        message(FATAL_ERROR "[trace-codegen] ${source} uses a CQA_TRACE_* hook that is not a statement line of its own")
+    endif()
+
+    # Same file name in both directories, so file-derived symbols (static initializers) match.
+    file(MAKE_DIRECTORY ${WORK_DIR}/traced ${WORK_DIR}/stripped)
+    file(WRITE ${WORK_DIR}/stripped/${name} "${stripped}")
+    configure_file(${SOURCE_DIR}/${source} ${WORK_DIR}/traced/${name} COPYONLY)
+
+    foreach(variant traced stripped)
+        execute_process(
+            COMMAND ${CXX_COMPILER} -std=c++17 -O2 -DCQA_ENABLE_TRACING=0
+                    -I${SOURCE_DIR}/src -I${INCLUDE_DIR}
+                    -c ${WORK_DIR}/${variant}/${name} -o ${WORK_DIR}/${variant}/${stem}.o
+            RESULT_VARIABLE result ERROR_VARIABLE error)
+        if(NOT result EQUAL 0)
+            message(FATAL_ERROR "[trace-codegen] Compiling the ${variant} ${name} failed:\n${error}")
+        endif()
+    endforeach()
+
+    disassemble(${WORK_DIR}/traced/${stem}.o traced_code)
+    disassemble(${WORK_DIR}/stripped/${stem}.o stripped_code)
+    if(traced_code STREQUAL stripped_code)
+        message(STATUS "[trace-codegen] ${source}: ${hook_count} hooks compile to nothing")
+    else()
+        differing_functions(traced_code stripped_code functions)
+        string(REPLACE ";" "\n  " functions "${functions}")
+        message(SEND_ERROR "[trace-codegen] ${source}: CQA_ENABLE_TRACING=0 still changes the code of:\n  ${functions}")
+        set(failed TRUE)
+    endif()
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "[trace-codegen] Disabled tracing hooks are not free; see above")
+endif()
@@ -0,0 +1,141 @@
+/**
+ * @file AnalyzeFuzzer.cpp
+ * @brief libFuzzer harness for Parser::parse plus Analyzer::analyze, built once per language.
+ *
+ * Besides ordinary edge coverage, every run reports three cost ratios to
+ * libFuzzer as extra features: analyzer node visits per tree node, CPU time per
+ * input byte, and parse-tree bytes per input byte. Each ratio is bucketed
+ * logarithmically into libFuzzer's extra-counter section, so an input that
+ * reaches a new, higher bucket counts as new coverage and is kept. The fuzzer
+ * therefore climbs towards inputs that make a pass super-linear, such as
+ * repeated child scans or parent lookups, rather than only towards new code.
+ *
+ * An input whose ratios exceed the limits below is treated as a finding. It is
+ * written to `$CQA_FUZZ_REGRESSION_DIR` (if set) and the harness aborts, so
+ * libFuzzer also saves it as a crash artifact. Limits can be overridden with
+ * `CQA_FUZZ_MAX_VISITS_PER_NODE`, `CQA_FUZZ_MAX_NS_PER_BYTE` and
+ * `CQA_FUZZ_MAX_TREE_BYTES_PER_BYTE`.
+ *
+ * Without libFuzzer (non-Clang builds), ReplayMain.cpp drives the same entry
+ * point over saved regression inputs.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#include "Analyzer.h"
+#include "MemoryTracker.h"
+#include "Parser.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+
+#ifndef CQA_FUZZ_LANGUAGE
+#error "Build with -DCQA_FUZZ_LANGUAGE=\"<language>\" (see CQA_BUILD_FUZZERS in CMakeLists.txt)"
+#endif
+
+namespace {
+
+// Below this size fixed per-file costs dominate every ratio, so only coverage counts.
+constexpr size_t kMinMeasuredBytes = 128;
+// Time is noisy; only judge it on inputs large enough to take measurable time.
+constexpr size_t kMinTimedBytes = 1024;
+constexpr size_t kBuckets = 32;
+
+enum Feedback { VisitsPerNode, NsPerByte, TreeBytesPerByte, kFeedbackCount };
+
+// libFuzzer scans this section after every run and treats each non-zero byte as a feature.
+#if defined(__APPLE__)
+__attribute__((used, section("__DATA,__libfuzzer_extra_counters")))
+#elif defined(__clang__)
+__attribute__((used, section("__libfuzzer_extra_counters")))
+#endif
+uint8_t g_feedback[kFeedbackCount][kBuckets];
+
+struct Limits {
+    double visits_per_node = 64.0;
+    double ns_per_byte = 50000.0;
+    double tree_bytes_per_byte = 4096.0;
+} g_limits;
+
+void readLimit(const char* name, double& limit) {
+    if (const char* value = std::getenv(name)) limit = std::atof(value);
+}
+
+/// Marks the log2 bucket of `ratio` (scaled by 4 so ratios below 1 still spread out).
+void report(Feedback kind, double ratio) {
+    size_t bucket = ratio > 0 ? static_cast<size_t>(std::log2(ratio * 4.0 + 1.0)) : 0;
+    g_feedback[kind][bucket < kBuckets ? bucket : kBuckets - 1] = 1;
+}
+
+uint64_t threadCpuNs() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000u + now.tv_nsec;
+}
+
+/// Saves a finding as `<language>-<fnv1a hash>` so repeated hits overwrite one file.
+void saveRegression(const uint8_t* data, size_t size) {
+    const char* directory = std::getenv("CQA_FUZZ_REGRESSION_DIR");
+    if (!directory) return;
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ data[i]) * 1099511628211ull;
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%016llx", static_cast<unsigned long long>(hash));
+    std::string path = std::string(directory) + "/" + CQA_FUZZ_LANGUAGE + name;
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data), size);
+    std::fprintf(stderr, "Saved regression input: %s\n", path.c_str());
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+    // Account tree-sitter's allocations so tree size per byte can be measured.
+    MemoryTracker::install();
+    readLimit("CQA_FUZZ_MAX_VISITS_PER_NODE", g_limits.visits_per_node);
+    readLimit("CQA_FUZZ_MAX_NS_PER_BYTE", g_limits.ns_per_byte);
+    readLimit("CQA_FUZZ_MAX_TREE_BYTES_PER_BYTE", g_limits.tree_bytes_per_byte);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string source(reinterpret_cast<const char*>(data), size);
+
+    MemoryTracker::Window window = MemoryTracker::beginWindow();
+    uint64_t start = threadCpuNs();
+    static const Language language = LanguageRegistry::fromName(CQA_FUZZ_LANGUAGE);
+    Parser parser;
+    parser.parse(source, language);
+    TSNode root = parser.getRootNode();
+    if (ts_node_is_null(root)) return 0;
+
+    // Trees with syntax errors are analyzed too: the Analyzer must stay linear on any tree.
+    Analyzer analyzer(createStrategy(language));
+    FileMetrics metrics = analyzer.analyze(root, "fuzz-input", source);
+    uint64_t elapsed = threadCpuNs() - start;
+    MemoryTracker::Usage usage[MemoryTracker::kHeapCount];
+    MemoryTracker::endWindow(window, usage);
+
+    if (size < kMinMeasuredBytes || metrics.node_count == 0) return 0;
+    double visitsPerNode = static_cast<double>(analyzer.nodesVisited()) / metrics.node_count;
+    double nsPerByte = static_cast<double>(elapsed) / size;
+    double treeBytesPerByte = static_cast<double>(usage[MemoryTracker::TreeSitter].peak) / size;
+    report(VisitsPerNode, visitsPerNode);
+    report(NsPerByte, nsPerByte);
+    report(TreeBytesPerByte, treeBytesPerByte);
+
+    bool slow = size >= kMinTimedBytes && nsPerByte > g_limits.ns_per_byte;
+    if (visitsPerNode > g_limits.visits_per_node || slow || treeBytesPerByte > g_limits.tree_bytes_per_byte) {
+        std::fprintf(stderr,
+                     "Super-linear input (%s, %zu bytes, %d nodes): %.1f visits/node, %.0f ns/byte, "
+                     "%.0f tree bytes/byte\n",
+                     CQA_FUZZ_LANGUAGE, size, metrics.node_count, visitsPerNode, nsPerByte, treeBytesPerByte);
+        saveRegression(data, size);
+        std::abort();
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+// fuzz/ReplayMain.cpp
+// Stand-in for libFuzzer's driver on compilers without -fsanitize=fuzzer: runs the
+// harness once over every file given (directories are walked recursively), so saved
+// regression inputs can be replayed in any build.
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void runFile(const fs::path& path, size_t& count) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    ++count;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <input file or directory>..." << std::endl;
+        return 1;
+    }
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    size_t count = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::error_code ec;
+        if (fs::is_directory(argv[i], ec)) {
+            for (const auto& entry : fs::recursive_directory_iterator(argv[i], ec)) {
+                if (entry.is_regular_file()) runFile(entry.path(), count);
+            }
+        } else {
+            runFile(argv[i], count);
+        }
+    }
+    std::cerr << "Replayed " << count << " inputs without findings." << std::endl;
+    return 0;
+}
@@ -11,24 +11,27 @@
  */
 
 #include "Analyzer.h"
+#include "LanguageDescriptor.h"
 #include "LanguageStrategy.h"
+#include "Trace.h"
 #include <cstring>
 #include <algorithm>
 #include <vector>
 #include <memory>
 #include <numeric>
+#include <iterator>
 #include <string>
-#include <set>
+#include <string_view>
 
 // --- Helper Functions ---
 
 /**
  * @brief Extracts the source text corresponding to a given tree-sitter node.
  */
-static std::string getNodeText(TSNode node, const std::string &source)
+static std::string_view getNodeText(TSNode node, std::string_view source)
 {
     if (ts_node_is_null(node))
-        return "";
+        return std::string_view();
     uint32_t start = ts_node_start_byte(node);
     uint32_t end = ts_node_end_byte(node);
     return source.substr(start, end - start);
@@ -93,6 +96,18 @@ bool LanguageStrategy::isLogicalOperator(TSNode node) const
     return false;
 }
 
+bool LanguageStrategy::isFunctionDefinition(TSNode node) const
+{
+    const auto &types = getFunctionDefinitionTypes();
+    return std::find(types.begin(), types.end(), ts_node_type(node)) != types.end();
+}
+
+bool LanguageStrategy::isComplexityNode(TSNode node) const
+{
+    const auto &types = getComplexityNodeTypes();
+    return std::find(types.begin(), types.end(), ts_node_type(node)) != types.end();
+}
+
 // Default implementation: by default, no functions are considered special.
 bool LanguageStrategy::isSpecialFunction(TSNode functionNode) const
 {
@@ -117,8 +132,8 @@ bool CStrategy::isSpecialFunction(TSNode functionNode) const
            hasChildOfTypeRecursive(declarator, "destructor_name");
 }
 
-std::vector<std::string> CStrategy::getFunctionDefinitionTypes() const { return {"function_definition"}; }
-std::string CStrategy::extractFunctionName(TSNode node, const std::string &source) const
+const std::vector<std::string> &CStrategy::getFunctionDefinitionTypes() const { static const std::vector<std::string> types = {"function_definition"}; return types; }
+std::string_view CStrategy::extractFunctionName(TSNode node, std::string_view source, const NodeContext &) const
 {
     TSNode declaratorNode = ts_node_child_by_field_name(node, "declarator", 10);
     if (!ts_node_is_null(declaratorNode))
@@ -131,35 +146,36 @@ std::string CStrategy::extractFunctionName(TSNode node, const std::string &sourc
     }
     return "[extraction_failed]";
 }
-std::vector<std::string> CStrategy::getComplexityNodeTypes() const
+const std::vector<std::string> &CStrategy::getComplexityNodeTypes() const
 {
-    return {"if_statement", "for_statement", "while_statement", "do_statement", "case_statement", "catch_clause", "conditional_expression"};
+    static const std::vector<std::string> types = {"if_statement", "for_statement", "while_statement", "do_statement", "case_statement", "catch_clause", "conditional_expression"};
+    return types;
 }
 
 // --- Python Strategy ---
-std::vector<std::string> PythonStrategy::getFunctionDefinitionTypes() const { return {"function_definition"}; }
-std::string PythonStrategy::extractFunctionName(TSNode node, const std::string &source) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
-std::vector<std::string> PythonStrategy::getComplexityNodeTypes() const { return {"if_statement", "for_statement", "while_statement", "except_clause", "conditional_expression", "elif_clause"}; }
+const std::vector<std::string> &PythonStrategy::getFunctionDefinitionTypes() const { static const std::vector<std::string> types = {"function_definition"}; return types; }
+std::string_view PythonStrategy::extractFunctionName(TSNode node, std::string_view source, const NodeContext &) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
+const std::vector<std::string> &PythonStrategy::getComplexityNodeTypes() const { static const std::vector<std::string> types = {"if_statement", "for_statement", "while_statement", "except_clause", "conditional_expression", "elif_clause"}; return types; }
 bool PythonStrategy::isLogicalOperator(TSNode node) const { return strcmp(ts_node_type(node), "boolean_operator") == 0; }
 
 // --- Java Strategy ---
-std::vector<std::string> JavaStrategy::getFunctionDefinitionTypes() const { return {"method_declaration", "constructor_declaration"}; }
-std::string JavaStrategy::extractFunctionName(TSNode node, const std::string &source) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
-std::vector<std::string> JavaStrategy::getComplexityNodeTypes() const { return {"if_statement", "for_statement", "while_statement", "do_statement", "switch_expression", "catch_clause", "ternary_expression"}; }
+const std::vector<std::string> &JavaStrategy::getFunctionDefinitionTypes() const { static const std::vector<std::string> types = {"method_declaration", "constructor_declaration"}; return types; }
+std::string_view JavaStrategy::extractFunctionName(TSNode node, std::string_view source, const NodeContext &) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
+const std::vector<std::string> &JavaStrategy::getComplexityNodeTypes() const { static const std::vector<std::string> types = {"if_statement", "for_statement", "while_statement", "do_statement", "switch_expression", "catch_clause", "ternary_expression"}; return types; }
 
 // --- Rust Strategy ---
-std::vector<std::string> RustStrategy::getFunctionDefinitionTypes() const { return {"function_item"}; }
-std::string RustStrategy::extractFunctionName(TSNode node, const std::string &source) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
-std::vector<std::string> RustStrategy::getComplexityNodeTypes() const { return {"if_expression", "for_expression", "while_expression", "match_arm", "loop_expression"}; }
+const std::vector<std::string> &RustStrategy::getFunctionDefinitionTypes() const { static const std::vector<std::string> types = {"function_item"}; return types; }
+std::string_view RustStrategy::extractFunctionName(TSNode node, std::string_view source, const NodeContext &) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
+const std::vector<std::string> &RustStrategy::getComplexityNodeTypes() const { static const std::vector<std::string> types = {"if_expression", "for_expression", "while_expression", "match_arm", "loop_expression"}; return types; }
 
 // --- Go Strategy ---
-std::vector<std::string> GoStrategy::getFunctionDefinitionTypes() const { return {"function_declaration", "method_declaration"}; }
-std::string GoStrategy::extractFunctionName(TSNode node, const std::string &source) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
-std::vector<std::string> GoStrategy::getComplexityNodeTypes() const { return {"if_statement", "for_statement", "switch_statement", "select_statement"}; }
+const std::vector<std::string> &GoStrategy::getFunctionDefinitionTypes() const { static const std::vector<std::string> types = {"function_declaration", "method_declaration"}; return types; }
+std::string_view GoStrategy::extractFunctionName(TSNode node, std::string_view source, const NodeContext &) const { return getNodeText(ts_node_child_by_field_name(node, "name", 4), source); }
+const std::vector<std::string> &GoStrategy::getComplexityNodeTypes() const { static const std::vector<std::string> types = {"if_statement", "for_statement", "switch_statement", "select_statement"}; return types; }
 
 // --- JavaScript / TypeScript Strategy ---
-std::vector<std::string> JSStrategy::getFunctionDefinitionTypes() const { return {"function_declaration", "function", "arrow_function", "method_definition"}; }
-std::string JSStrategy::extractFunctionName(TSNode node, const std::string &source) const
+const std::vector<std::string> &JSStrategy::getFunctionDefinitionTypes() const { static const std::vector<std::string> types = {"function_declaration", "function", "arrow_function", "method_definition"}; return types; }
+std::string_view JSStrategy::extractFunctionName(TSNode node, std::string_view source, const NodeContext &context) const
 {
     const char *type = ts_node_type(node);
     TSNode nameNode = ts_node_child_by_field_name(node, "name", 4);
@@ -167,7 +183,7 @@ std::string JSStrategy::extractFunctionName(TSNode node, const std::string &sour
         return getNodeText(nameNode, source);
     if (strcmp(type, "arrow_function") == 0)
     {
-        TSNode parent = ts_node_parent(node);
+        TSNode parent = context.parent();
         if (parent.id && (strcmp(ts_node_type(parent), "variable_declarator") == 0))
         {
             return getNodeText(ts_node_child_by_field_name(parent, "name", 4), source);
@@ -175,27 +191,36 @@ std::string JSStrategy::extractFunctionName(TSNode node, const std::string &sour
     }
     return "[anonymous function]";
 }
-std::vector<std::string> JSStrategy::getComplexityNodeTypes() const { return {"if_statement", "for_statement", "for_in_statement", "while_statement", "do_statement", "switch_case", "catch_clause", "ternary_expression"}; }
+const std::vector<std::string> &JSStrategy::getComplexityNodeTypes() const { static const std::vector<std::string> types = {"if_statement", "for_statement", "for_in_statement", "while_statement", "do_statement", "switch_case", "catch_clause", "ternary_expression"}; return types; }
 
 // --- Strategy Factory ---
-std::unique_ptr<LanguageStrategy> createStrategy(const std::string &language)
+std::unique_ptr<LanguageStrategy> createStrategy(Language language)
 {
-    if (language == "c")
+    if (std::unique_ptr<LanguageStrategy> strategy = LanguageDescriptors::createStrategy(language))
+    {
+        return strategy;
+    }
+    switch (language)
+    {
+    case Language::C:
         return std::make_unique<CStrategy>();
-    if (language == "cpp")
+    case Language::Cpp:
         return std::make_unique<CppStrategy>();
-    if (language == "python")
+    case Language::Python:
         return std::make_unique<PythonStrategy>();
-    if (language == "java")
+    case Language::Java:
         return std::make_unique<JavaStrategy>();
-    if (language == "rust")
+    case Language::Rust:
         return std::make_unique<RustStrategy>();
-    if (language == "go")
+    case Language::Go:
         return std::make_unique<GoStrategy>();
-    if (language == "javascript")
+    case Language::JavaScript:
         return std::make_unique<JSStrategy>();
-    if (language == "typescript")
+    case Language::TypeScript:
         return std::make_unique<TSStrategy>();
+    default:
+        break;
+    }
     return nullptr;
 }
 
@@ -205,41 +230,78 @@ std::unique_ptr<LanguageStrategy> createStrategy(const std::string &language)
 
 Analyzer::Analyzer(std::unique_ptr<LanguageStrategy> strategy) : langStrategy(std::move(strategy)) {}
 
-FileMetrics Analyzer::analyze(TSNode rootNode, const std::string &filePath, const std::string &sourceCode)
+FileMetrics Analyzer::analyze(TSNode rootNode, const std::string &filePath, std::string_view sourceCode)
+{
+    return analyze(rootNode, PathTable::global().intern(filePath), sourceCode);
+}
+
+FileMetrics Analyzer::analyze(TSNode rootNode, PathId path, std::string_view sourceCode)
 {
     FileMetrics metrics;
-    metrics.file_path = filePath;
+    analyze(rootNode, path, sourceCode, metrics);
+    return metrics;
+}
+
+void Analyzer::analyze(TSNode rootNode, PathId path, std::string_view sourceCode, FileMetrics &metrics)
+{
+    // Start from a blank record, but keep the function table's buffers: a caller that
+    // reuses one FileMetrics allocates nothing once they are large enough.
+    FunctionTable functions = std::move(metrics.functions);
+    functions.clear();
+    metrics = FileMetrics();
+    metrics.functions = std::move(functions);
+    metrics.path = path;
+    visits = 0;
+    ancestors.clear();
     if (langStrategy)
     {
-        analyzeFunctions(rootNode, metrics, sourceCode);
-        analyzeFileWideMetrics(rootNode, metrics);
-        analyzeNaming(rootNode, metrics, sourceCode);
+        {
+            CQA_TRACE_SCOPE(Functions);
+            analyzeFunctions(rootNode, metrics, sourceCode);
+        }
+        CQA_TRACE_COUNTER(Functions, metrics.functions.size());
+        {
+            CQA_TRACE_SCOPE(FileWide);
+            analyzeFileWideMetrics(rootNode, metrics);
+        }
+        CQA_TRACE_COUNTER(TreeNodes, metrics.node_count);
+        {
+            CQA_TRACE_SCOPE(Naming);
+            analyzeNaming(rootNode, metrics, sourceCode);
+        }
+    }
+    {
+        CQA_TRACE_SCOPE(Score);
+        calculateFinalScore(metrics);
     }
-    calculateFinalScore(metrics);
-    return metrics;
 }
 
-void Analyzer::analyzeFunctions(TSNode node, FileMetrics &metrics, const std::string &sourceCode)
+void Analyzer::analyzeFunctions(TSNode node, FileMetrics &metrics, std::string_view sourceCode)
 {
-    const auto &funcTypes = langStrategy->getFunctionDefinitionTypes();
-    const char *nodeType = ts_node_type(node);
-    if (std::find(funcTypes.begin(), funcTypes.end(), std::string(nodeType)) != funcTypes.end())
+    ++visits;
+    if (langStrategy->isFunctionDefinition(node))
     {
         if (!langStrategy->isSpecialFunction(node))
         {
-            analyzeSingleFunction(node, metrics, sourceCode);
+            analyzeSingleFunction(node, NodeContext(ancestors.data(), ancestors.size()), metrics, sourceCode);
         }
         return;
     }
+    ancestors.push_back(node);
     for (uint32_t i = 0; i < ts_node_child_count(node); ++i)
     {
         analyzeFunctions(ts_node_child(node, i), metrics, sourceCode);
     }
+    ancestors.pop_back();
 }
 
-void Analyzer::analyzeFileWideMetrics(TSNode node, FileMetrics &metrics)
+void Analyzer::analyzeFileWideMetrics(TSNode node, FileMetrics &metrics, int depth)
 {
-    if (ts_node_is_null(ts_node_parent(node)))
+    ++visits;
+    metrics.node_count++;
+    metrics.max_depth = std::max(metrics.max_depth, depth);
+    // The walk starts at the root; asking ts_node_parent() would cost O(depth) per node.
+    if (depth == 0)
     {
         metrics.total_lines = ts_node_end_point(node).row + 1;
     }
@@ -249,21 +311,22 @@ void Analyzer::analyzeFileWideMetrics(TSNode node, FileMetrics &metrics)
     }
     for (uint32_t i = 0; i < ts_node_child_count(node); ++i)
     {
-        analyzeFileWideMetrics(ts_node_child(node, i), metrics);
+        analyzeFileWideMetrics(ts_node_child(node, i), metrics, depth + 1);
     }
 }
 
-void Analyzer::analyzeNaming(TSNode node, FileMetrics &metrics, const std::string &sourceCode)
+void Analyzer::analyzeNaming(TSNode node, FileMetrics &metrics, std::string_view sourceCode)
 {
+    ++visits;
     const char *type = ts_node_type(node);
     if (strcmp(type, "identifier") == 0)
     {
-        std::string name = getNodeText(node, sourceCode);
+        std::string_view name = getNodeText(node, sourceCode);
         if (name.length() <= 2)
         {
-            static const std::set<std::string> whitelist = {
+            static constexpr std::string_view whitelist[] = {
                 "i", "j", "k", "x", "y", "z", "os", "fs", "it", "c", "ts", "js"};
-            if (whitelist.find(name) == whitelist.end())
+            if (std::find(std::begin(whitelist), std::end(whitelist), name) == std::end(whitelist))
             {
                 metrics.naming_violations++;
             }
@@ -275,25 +338,21 @@ void Analyzer::analyzeNaming(TSNode node, FileMetrics &metrics, const std::strin
     }
 }
 
-void Analyzer::analyzeSingleFunction(TSNode funcNode, FileMetrics &metrics, const std::string &sourceCode)
+void Analyzer::analyzeSingleFunction(TSNode funcNode, const NodeContext &context, FileMetrics &metrics, std::string_view sourceCode)
 {
-    FunctionMetric func;
-    func.line_start = ts_node_start_point(funcNode).row + 1;
-    func.line_end = ts_node_end_point(funcNode).row + 1;
-    func.line_count = func.line_end - func.line_start + 1;
-    func.name = langStrategy->extractFunctionName(funcNode, sourceCode);
-    if (func.name.empty())
-        func.name = "[anonymous/unknown]";
-    func.complexity = calculateComplexity(funcNode);
-    metrics.functions.push_back(func);
+    int lineStart = ts_node_start_point(funcNode).row + 1;
+    int lineEnd = ts_node_end_point(funcNode).row + 1;
+    std::string_view name = langStrategy->extractFunctionName(funcNode, sourceCode, context);
+    if (name.empty())
+        name = "[anonymous/unknown]";
+    metrics.functions.append(name, lineStart, lineEnd, calculateComplexity(funcNode));
 }
 
 int Analyzer::calculateComplexity(TSNode node)
 {
+    ++visits;
     int complexity = 0;
-    const char *type = ts_node_type(node);
-    const auto &complexityTypes = langStrategy->getComplexityNodeTypes();
-    if (std::find(complexityTypes.begin(), complexityTypes.end(), std::string(type)) != complexityTypes.end())
+    if (langStrategy->isComplexityNode(node))
     {
         complexity = 1;
     }
@@ -305,8 +364,7 @@ int Analyzer::calculateComplexity(TSNode node)
     {
         complexity += calculateComplexity(ts_node_child(node, i));
     }
-    const auto &funcTypes = langStrategy->getFunctionDefinitionTypes();
-    if (std::find(funcTypes.begin(), funcTypes.end(), std::string(type)) != funcTypes.end())
+    if (langStrategy->isFunctionDefinition(node))
     {
         return complexity + 1;
     }
@@ -318,12 +376,12 @@ void Analyzer::calculateFinalScore(FileMetrics &metrics)
     // --- Step 1: Calculate raw aggregated metrics (unchanged) ---
     if (!metrics.functions.empty())
     {
+        // Sum the columns directly rather than materializing a row per function.
         double total_length = 0, total_complexity = 0;
-        for (const auto &func : metrics.functions)
-        {
-            total_length += func.line_count;
-            total_complexity += func.complexity;
-        }
+        for (uint32_t length : metrics.functions.lineCounts())
+            total_length += length;
+        for (uint16_t complexity : metrics.functions.complexityColumn())
+            total_complexity += complexity;
         metrics.avg_function_length = total_length / metrics.functions.size();
         metrics.avg_function_complexity = total_complexity / metrics.functions.size();
     }
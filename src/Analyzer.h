@@ -5,27 +5,46 @@
 #include "Metrics.h"
 #include "LanguageStrategy.h"
 #include <tree_sitter/api.h>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <vector>
 
 class Analyzer {
 public:
     Analyzer(std::unique_ptr<LanguageStrategy> strategy);
-    FileMetrics analyze(TSNode rootNode, const std::string& filePath, const std::string& sourceCode);
+    FileMetrics analyze(TSNode rootNode, PathId path, std::string_view sourceCode);
+    // Interns the path first; for callers that do not hold a PathId.
+    FileMetrics analyze(TSNode rootNode, const std::string& filePath, std::string_view sourceCode);
+    // Overwrites `metrics` in place, reusing its buffers; the allocation-free form for per-thread loops.
+    void analyze(TSNode rootNode, PathId path, std::string_view sourceCode, FileMetrics& metrics);
+
+    // Syntax tree nodes visited by all passes of the last analyze() call. A linear
+    // implementation visits each node a small, constant number of times; the fuzzers
+    // use the ratio to node_count to find inputs that make a pass super-linear.
+    uint64_t nodesVisited() const { return visits; }
 
 private:
+    // The micro-benchmarks (bench/AnalyzerProbe.h) time each pass in isolation.
+    friend class AnalyzerProbe;
+
     std::unique_ptr<LanguageStrategy> langStrategy;
+    uint64_t visits = 0;
+    // Ancestors of the node analyzeFunctions() is visiting, outermost first. Strategies
+    // see them through a NodeContext; the buffer is kept between files.
+    std::vector<TSNode> ancestors;
 
     // --- Traversal and Analysis Methods ---
     // Finds and analyzes all functions.
-    void analyzeFunctions(TSNode node, FileMetrics& metrics, const std::string& sourceCode);
-    void analyzeSingleFunction(TSNode funcNode, FileMetrics& metrics, const std::string& sourceCode);
+    void analyzeFunctions(TSNode node, FileMetrics& metrics, std::string_view sourceCode);
+    void analyzeSingleFunction(TSNode funcNode, const NodeContext& context, FileMetrics& metrics, std::string_view sourceCode);
 
-    // Analyzes file-wide metrics like comments and total lines.
-    void analyzeFileWideMetrics(TSNode node, FileMetrics& metrics);
+    // Analyzes file-wide metrics like comments, total lines and the tree shape.
+    void analyzeFileWideMetrics(TSNode node, FileMetrics& metrics, int depth = 0);
 
     // Finds and analyzes all identifiers for naming conventions.
-    void analyzeNaming(TSNode node, FileMetrics& metrics, const std::string& sourceCode);
+    void analyzeNaming(TSNode node, FileMetrics& metrics, std::string_view sourceCode);
 
     // --- Metric Calculation Methods ---
     int calculateComplexity(TSNode node);
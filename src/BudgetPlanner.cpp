@@ -0,0 +1,128 @@
+// src/BudgetPlanner.cpp
+#include "BudgetPlanner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace fs = std::filesystem;
+
+namespace BudgetPlanner {
+
+    namespace {
+
+        /// The prior when the cache knows nothing at all: the middle of the scale.
+        constexpr double kNeutralPrior = 50.0;
+        /// Points per doubling of the file size beyond kSizeUnit.
+        constexpr double kSizeWeight = 3.0;
+        constexpr double kSizeUnit = 4096.0;
+        /// Points per doubling of the number of recent commits touching the file.
+        constexpr double kChurnWeight = 3.0;
+
+        std::string quoteArgument(const std::string& argument) {
+#if defined(_WIN32)
+            return "\"" + argument + "\"";
+#else
+            std::string quoted = "'";
+            for (char c : argument) quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+            return quoted + "'";
+#endif
+        }
+
+        /// Runs a command and collects its standard output; stderr is discarded.
+        bool capture(const std::string& command, std::string& output) {
+#if defined(_WIN32)
+            std::FILE* pipe = popen((command + " 2>NUL").c_str(), "r");
+#else
+            std::FILE* pipe = popen((command + " 2>/dev/null").c_str(), "r");
+#endif
+            if (!pipe) return false;
+            char buffer[4096];
+            for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0;) output.append(buffer, n);
+            return pclose(pipe) == 0;
+        }
+
+        std::string normalized(const fs::path& path) {
+            std::error_code ec;
+            fs::path absolute = fs::absolute(path, ec);
+            return (ec ? path : absolute).lexically_normal().string();
+        }
+
+    } // namespace
+
+    Churn gitChurn(const std::string& directory, unsigned commits) {
+        Churn churn;
+        std::error_code ec;
+        std::string start = fs::is_directory(directory, ec) ? directory : fs::path(directory).parent_path().string();
+        if (start.empty()) start = ".";
+        std::string git = "git -c core.quotepath=off -C " + quoteArgument(start);
+
+        std::string root;
+        if (!capture(git + " rev-parse --show-toplevel", root)) return churn;
+        while (!root.empty() && (root.back() == '\n' || root.back() == '\r')) root.pop_back();
+
+        std::string log;
+        if (!capture(git + " log -n " + std::to_string(commits) + " --format= --name-only", log)) return churn;
+        fs::path top(root);
+        for (size_t begin = 0; begin < log.size();) {
+            size_t end = log.find('\n', begin);
+            if (end == std::string::npos) end = log.size();
+            if (end > begin) ++churn[normalized(top / log.substr(begin, end - begin))];
+            begin = end + 1;
+        }
+        return churn;
+    }
+
+    void order(std::vector<Candidate>& candidates, const ResultCache* cache, const Churn& churn) {
+        // Priors per language id, from the cache's mean scores by language name.
+        double priors[LanguageRegistry::kMaxLanguages];
+        double fallback = kNeutralPrior;
+        std::unordered_map<std::string, double> means;
+        if (cache) means = cache->languageMeans();
+        if (!means.empty()) {
+            fallback = 0.0;
+            for (const auto& [language, mean] : means) fallback += mean;
+            fallback /= means.size();
+        }
+        for (size_t i = 0; i < LanguageRegistry::kMaxLanguages; ++i) {
+            auto it = means.find(LanguageRegistry::name(static_cast<Language>(i)));
+            priors[i] = it == means.end() ? fallback : it->second;
+        }
+
+        std::string filePath;
+        for (Candidate& candidate : candidates) {
+            filePath.clear();
+            PathTable::global().appendPath(candidate.path, filePath);
+
+            double estimate = candidate.language == Language::Unsupported
+                                  ? fallback
+                                  : priors[LanguageRegistry::index(candidate.language)];
+            estimate += kSizeWeight * std::log2(1.0 + candidate.bytes / kSizeUnit);
+            if (!churn.empty()) {
+                auto it = churn.find(normalized(filePath));
+                if (it != churn.end()) estimate += kChurnWeight * std::log2(1.0 + it->second);
+            }
+
+            const ResultCache::Entry* cached = cache ? cache->find(filePath) : nullptr;
+            if (!cached) {
+                candidate.expected_smi = estimate;
+            } else if (cached->bytes == candidate.bytes) {
+                candidate.expected_smi = cached->smi;
+            } else {
+                candidate.expected_smi = (cached->smi + estimate) / 2.0;
+            }
+        }
+
+        // Larger files first among equals: they take longest, so they should not be left to the end.
+        std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            if (a.expected_smi != b.expected_smi) return a.expected_smi > b.expected_smi;
+            return a.bytes > b.bytes;
+        });
+    }
+
+} // namespace BudgetPlanner
@@ -0,0 +1,63 @@
+/**
+ * @file BudgetPlanner.h
+ * @brief Orders files for anytime analysis under a time budget, likely-worst first.
+ *
+ * A `--budget` run may stop before every file is analyzed. It should then have
+ * spent the time on the files most likely to rank worst. Each file gets an
+ * expected Shit Mountain Index:
+ *  - a file the result cache has seen at its current size is expected to score
+ *    what it scored last time;
+ *  - any other file is estimated from a prior, the mean cached score of its
+ *    language, plus terms that grow with its size and with its git churn (the
+ *    number of recent commits that touched it). Large files and files that
+ *    change often are where long, complex functions accumulate;
+ *  - a cached file whose size changed averages the two.
+ *
+ * The weights are heuristics. They only decide the order, never a reported score.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef BUDGET_PLANNER_H
+#define BUDGET_PLANNER_H
+
+#include "LanguageRegistry.h"
+#include "PathTable.h"
+#include "ResultCache.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BudgetPlanner {
+
+    /// Recent commits considered for churn; bounds the cost of `git log` on long histories.
+    constexpr unsigned kChurnCommits = 1000;
+
+    struct Candidate {
+        PathId path = PathTable::kNoPath;
+        Language language = Language::Unsupported;
+        uint64_t bytes = 0;
+        double expected_smi = 0.0; ///< Filled in by order().
+    };
+
+    /// Commit counts by absolute, lexically normalized path.
+    using Churn = std::unordered_map<std::string, uint32_t>;
+
+    /**
+     * @brief Counts how many of the last `commits` commits touched each file of the
+     * git repository containing `directory`.
+     * @return An empty map if git is unavailable or `directory` is not in a repository.
+     */
+    Churn gitChurn(const std::string& directory, unsigned commits = kChurnCommits);
+
+    /**
+     * @brief Estimates every candidate's score and sorts them worst first.
+     * @param cache Scores of earlier runs; may be null.
+     */
+    void order(std::vector<Candidate>& candidates, const ResultCache* cache, const Churn& churn);
+
+} // namespace BudgetPlanner
+
+#endif // BUDGET_PLANNER_H
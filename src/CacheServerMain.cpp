@@ -0,0 +1,136 @@
+/**
+ * @file CacheServerMain.cpp
+ * @brief `cqa-cache-server`: a minimal remote result cache server for `cqa --remote-cache`.
+ *
+ * Speaks the subset of Bazel's HTTP remote cache protocol that cqa uses:
+ * `GET`/`HEAD` of `.../ac/<sha256>` return an entry or 404, and `PUT` stores one.
+ * Entries are files below the cache directory, written to a temporary file and
+ * renamed into place, so a reader never sees a partial entry and the directory
+ * can be shared or pruned by age with ordinary tools. Each connection is served
+ * on its own thread, and clients keep their connections between batches. That is
+ * enough for tests and for a team's CI; a larger fleet should use a full cache
+ * server such as bazel-remote.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#include "HttpServer.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    std::atomic<bool> g_stopRequested{false};
+    std::atomic<uint64_t> g_nextTemporary{0};
+
+    void requestStop(int) {
+        g_stopRequested = true;
+    }
+
+    /// @return The entry's file for a request path ending in `/ac/<64 hex digits>`, or an empty path.
+    fs::path entryPath(const fs::path& root, const std::string& requestPath) {
+        const std::string marker = "/ac/";
+        size_t at = requestPath.rfind(marker);
+        if (at == std::string::npos) return {};
+        std::string key = requestPath.substr(at + marker.size());
+        if (key.size() != 64 || key.find_first_not_of("0123456789abcdef") != std::string::npos) return {};
+        // Fan out by the first two digits so no directory grows too large.
+        return root / "ac" / key.substr(0, 2) / key;
+    }
+
+    HttpResponse handle(const fs::path& root, const HttpRequest& request) {
+        HttpResponse response;
+        response.content_type = "application/octet-stream";
+        fs::path entry = entryPath(root, request.path);
+        if (entry.empty()) {
+            response.status = 404;
+            return response;
+        }
+
+        if (request.method == "GET" || request.method == "HEAD") {
+            std::ifstream file(entry, std::ios::binary);
+            if (!file.is_open()) {
+                response.status = 404;
+                return response;
+            }
+            response.body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        } else if (request.method == "PUT") {
+            std::error_code ec;
+            fs::create_directories(entry.parent_path(), ec);
+            // Connections are served concurrently, so two uploads of one entry must not share a file.
+            fs::path temporary = entry;
+            temporary += ".tmp." + std::to_string(g_nextTemporary++);
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(request.body.data(), static_cast<std::streamsize>(request.body.size()));
+            file.close();
+            if (!file || std::rename(temporary.string().c_str(), entry.string().c_str()) != 0) {
+                fs::remove(temporary, ec);
+                response.status = 500;
+            }
+        } else {
+            response.status = 405;
+        }
+        return response;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string bindAddress = "127.0.0.1";
+    int port = 8093;
+    std::string directory;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bind" && hasValue) {
+            bindAddress = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            port = std::atoi(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-' && directory.empty()) {
+            directory = arg;
+        } else {
+            directory.clear();
+            break;
+        }
+    }
+    if (directory.empty() || port < 0 || port > 65535) {
+        std::cerr << "Usage: " << argv[0] << " [--bind ADDRESS] [--port N] <cache_directory>" << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (!fs::is_directory(directory, ec)) {
+        std::cerr << "Error: Not a directory: " << directory << std::endl;
+        return 1;
+    }
+
+    fs::path root(directory);
+    HttpServer server;
+    std::string error;
+    if (!server.start(bindAddress, static_cast<uint16_t>(port),
+                      [&root](const HttpRequest& request) { return handle(root, request); }, error)) {
+        std::cerr << "Error: Could not serve on " << bindAddress << ":" << port << ": " << error << std::endl;
+        return 1;
+    }
+    std::cout << "Serving " << directory << " on http://" << bindAddress << ":" << server.port() << "/" << std::endl;
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    while (!g_stopRequested) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    server.stop();
+    return 0;
+}
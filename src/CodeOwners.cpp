@@ -0,0 +1,317 @@
+// src/CodeOwners.cpp
+#include "CodeOwners.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    /// Absolute and lexically normal, without a trailing separator.
+    fs::path normalized(const fs::path& path) {
+        std::error_code ec;
+        fs::path absolute = fs::absolute(path.empty() ? fs::path(".") : path, ec);
+        fs::path result = (ec ? path : absolute).lexically_normal();
+        if (!result.has_filename() && result.has_relative_path()) result = result.parent_path();
+        return result;
+    }
+
+    bool hasWildcard(std::string_view segment) {
+        for (size_t i = 0; i < segment.size(); ++i) {
+            if (segment[i] == '\\') ++i;
+            else if (segment[i] == '*' || segment[i] == '?') return true;
+        }
+        return false;
+    }
+
+    std::string unescape(std::string_view segment) {
+        std::string out;
+        for (size_t i = 0; i < segment.size(); ++i) {
+            if (segment[i] == '\\' && i + 1 < segment.size()) ++i;
+            out += segment[i];
+        }
+        return out;
+    }
+
+    /// Splits a line into whitespace-separated tokens. `\ ` keeps a space in a token; escapes are kept for the pattern.
+    std::vector<std::string> tokenize(const std::string& line) {
+        std::vector<std::string> tokens;
+        std::string current;
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            if (c == '\\' && i + 1 < line.size()) {
+                current += c;
+                current += line[++i];
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                if (!current.empty()) tokens.push_back(std::move(current));
+                current.clear();
+            } else if (c == '#' && current.empty()) {
+                break; // A comment, to the end of the line.
+            } else {
+                current += c;
+            }
+        }
+        if (!current.empty()) tokens.push_back(std::move(current));
+        return tokens;
+    }
+
+} // namespace
+
+bool CodeOwners::globMatch(std::string_view pattern, std::string_view text) {
+    // Iterative wildcard matching: on a mismatch, let the last `*` absorb one more character.
+    size_t p = 0, t = 0;
+    size_t starPattern = std::string_view::npos, starText = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = ++p;
+            starText = t;
+            continue;
+        }
+        if (p < pattern.size()) {
+            bool escaped = pattern[p] == '\\' && p + 1 < pattern.size();
+            char expected = escaped ? pattern[p + 1] : pattern[p];
+            if ((!escaped && expected == '?') || expected == text[t]) {
+                p += escaped ? 2 : 1;
+                ++t;
+                continue;
+            }
+        }
+        if (starPattern == std::string_view::npos) return false;
+        p = starPattern;
+        t = ++starText;
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+bool CodeOwners::compile(std::string_view pattern, std::vector<std::string> owners, std::string& error) {
+    if (pattern[0] == '!') {
+        error = "negated patterns are not supported";
+        return false;
+    }
+    Rule rule;
+    rule.owners = std::move(owners);
+    std::string_view text = pattern;
+    if (text.size() > 1 && text.back() == '/') {
+        rule.directory_only = true;
+        text.remove_suffix(1);
+    }
+    // A slash anywhere but at the end anchors the pattern at the root; otherwise it matches at any depth.
+    bool anchored = text.find('/') != std::string_view::npos;
+    if (!anchored) rule.segments.push_back({SegmentKind::AnyDepth, ""});
+    for (size_t start = 0; start <= text.size();) {
+        size_t end = std::min(text.find('/', start), text.size());
+        std::string_view segment = text.substr(start, end - start);
+        start = end + 1;
+        if (segment.empty()) continue;
+        if (segment == "**") {
+            // Consecutive `**` are one.
+            if (rule.segments.empty() || rule.segments.back().kind != SegmentKind::AnyDepth) {
+                rule.segments.push_back({SegmentKind::AnyDepth, ""});
+            }
+        } else if (hasWildcard(segment)) {
+            rule.segments.push_back({SegmentKind::Glob, std::string(segment)});
+        } else {
+            rule.segments.push_back({SegmentKind::Literal, unescape(segment)});
+        }
+    }
+    // "/" alone owns the whole tree, like "/**".
+    if (rule.segments.empty()) rule.segments.push_back({SegmentKind::AnyDepth, ""});
+    const Segment& last = rule.segments.back();
+    rule.descendants = !(last.kind == SegmentKind::Glob && last.text == "*");
+
+    // Register the rule under its literal prefix, leaving at least one segment for the automaton.
+    size_t prefix = 0;
+    while (prefix + 1 < rule.segments.size() && rule.segments[prefix].kind == SegmentKind::Literal) ++prefix;
+    uint32_t node = 0;
+    for (size_t i = 0; i < prefix; ++i) {
+        auto [it, inserted] = trie[node].children.emplace(rule.segments[i].text, static_cast<uint32_t>(trie.size()));
+        uint32_t child = it->second;
+        if (inserted) trie.emplace_back();
+        node = child;
+    }
+    trie[node].starts.push_back({static_cast<int>(rules.size()), static_cast<uint32_t>(prefix)});
+    rules.push_back(std::move(rule));
+    return true;
+}
+
+bool CodeOwners::load(const std::string& path, std::string& error) {
+    rules.clear();
+    trie.assign(1, TrieNode());
+    states.clear();
+    directoryStates.clear();
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    fs::path location = normalized(path).parent_path();
+    std::string directory = location.filename().string();
+    root = (directory == ".github" || directory == "docs" ? location.parent_path() : location).string();
+
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); ++number) {
+        std::vector<std::string> tokens = tokenize(line);
+        if (tokens.empty()) continue;
+        // GitLab section headers: "[Section]", "^[Optional section]", possibly with default owners.
+        if (tokens[0][0] == '[' || tokens[0].compare(0, 2, "^[") == 0) continue;
+        std::string pattern = std::move(tokens[0]);
+        tokens.erase(tokens.begin());
+        if (!compile(pattern, std::move(tokens), error)) {
+            error = path + ":" + std::to_string(number) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CodeOwners::addThread(DirectoryState& state, Thread thread) const {
+    const Rule& rule = rules[thread.rule];
+    for (;;) {
+        if (thread.rule <= state.inherited) return;
+        if (thread.position == rule.segments.size()) {
+            // The rule matches this directory itself.
+            if (rule.descendants) state.inherited = thread.rule;
+            return;
+        }
+        state.threads.push_back(thread);
+        // `**` may also match no segment at all, except at the end: `docs/**` owns what is
+        // inside docs/, and `**/` every directory but not the root.
+        if (rule.segments[thread.position].kind != SegmentKind::AnyDepth) return;
+        if (thread.position + 1 == rule.segments.size()) return;
+        ++thread.position;
+    }
+}
+
+CodeOwners::DirectoryState CodeOwners::rootState() const {
+    DirectoryState state;
+    state.trie = 0;
+    for (const Thread& thread : trie[0].starts) addThread(state, thread);
+    std::sort(state.threads.begin(), state.threads.end(), [](const Thread& a, const Thread& b) {
+        return a.rule != b.rule ? a.rule > b.rule : a.position > b.position;
+    });
+    return state;
+}
+
+CodeOwners::DirectoryState CodeOwners::step(const DirectoryState& parent, std::string_view name) const {
+    DirectoryState state;
+    state.inherited = parent.inherited;
+    if (parent.trie >= 0) {
+        auto it = trie[parent.trie].children.find(std::string(name));
+        if (it != trie[parent.trie].children.end()) state.trie = static_cast<int32_t>(it->second);
+    }
+    for (const Thread& thread : parent.threads) {
+        const Segment& segment = rules[thread.rule].segments[thread.position];
+        if (segment.kind == SegmentKind::AnyDepth) {
+            addThread(state, thread);
+            // A trailing `**` has now matched a segment, so this directory matches.
+            if (thread.position + 1 == rules[thread.rule].segments.size()) {
+                addThread(state, {thread.rule, thread.position + 1});
+            }
+        } else if (segment.kind == SegmentKind::Literal ? segment.text == name : globMatch(segment.text, name)) {
+            addThread(state, {thread.rule, thread.position + 1});
+        }
+    }
+    if (state.trie >= 0) {
+        for (const Thread& thread : trie[state.trie].starts) addThread(state, thread);
+    }
+
+    // A rule that already owns this whole directory outranks every earlier one.
+    int inherited = state.inherited;
+    state.threads.erase(std::remove_if(state.threads.begin(), state.threads.end(),
+                                       [inherited](const Thread& thread) { return thread.rule <= inherited; }),
+                        state.threads.end());
+    std::sort(state.threads.begin(), state.threads.end(), [](const Thread& a, const Thread& b) {
+        return a.rule != b.rule ? a.rule > b.rule : a.position > b.position;
+    });
+    state.threads.erase(std::unique(state.threads.begin(), state.threads.end()), state.threads.end());
+    return state;
+}
+
+uint32_t CodeOwners::stateOf(PathId directory) {
+    auto it = directoryStates.find(directory);
+    if (it != directoryStates.end()) return it->second;
+
+    PathTable& paths = PathTable::global();
+    fs::path relative = normalized(paths.path(directory)).lexically_relative(root);
+    DirectoryState state;
+    if (relative.empty() || *relative.begin() == "..") {
+        state.outside = true;
+    } else if (relative == ".") {
+        state = rootState();
+    } else {
+        // Derive the state from the parent's, which is computed (once) the same way.
+        std::string name = directory == PathTable::kRoot ? "" : paths.basename(directory);
+        bool derived = false;
+        if (!name.empty() && name != "." && name != "..") {
+            uint32_t parent = stateOf(paths.parent(directory));
+            if (!states[parent].outside) {
+                state = step(states[parent], name);
+                derived = true;
+            }
+        }
+        if (!derived) {
+            state = rootState();
+            for (const fs::path& part : relative) state = step(state, part.string());
+        }
+    }
+    states.push_back(std::move(state));
+    directoryStates.emplace(directory, static_cast<uint32_t>(states.size() - 1));
+    return static_cast<uint32_t>(states.size() - 1);
+}
+
+int CodeOwners::ruleFor(PathId file) {
+    PathTable& paths = PathTable::global();
+    const DirectoryState& state = states[stateOf(paths.parent(file))];
+    if (state.outside) return kNoRule;
+
+    std::string name = paths.basename(file);
+    int best = state.inherited;
+    for (const Thread& thread : state.threads) {
+        if (thread.rule <= best) break;
+        const Rule& rule = rules[thread.rule];
+        if (rule.directory_only || thread.position + 1 != rule.segments.size()) continue;
+        const Segment& segment = rule.segments[thread.position];
+        if (segment.kind == SegmentKind::AnyDepth ||
+            (segment.kind == SegmentKind::Literal ? segment.text == name : globMatch(segment.text, name))) {
+            best = thread.rule;
+        }
+    }
+    return best;
+}
+
+std::vector<OwnerRollup> CodeOwners::rollUp(const std::vector<FileMetrics>& files, size_t worstFiles) {
+    static const std::vector<std::string> kUnowned{"(unowned)"};
+    std::map<std::string, OwnerRollup> byOwner;
+    for (const FileMetrics& metrics : files) {
+        int rule = ruleFor(metrics.path);
+        const std::vector<std::string>& names = rule == kNoRule || owners(rule).empty() ? kUnowned : owners(rule);
+        for (const std::string& owner : names) {
+            OwnerRollup& rollup = byOwner[owner];
+            rollup.owner = owner;
+            ++rollup.files;
+            rollup.lines += static_cast<uint64_t>(std::max(metrics.total_lines, 0));
+            rollup.mean_smi += metrics.shit_mountain_index;
+            rollup.weighted_smi += metrics.shit_mountain_index * std::max(metrics.total_lines, 0);
+            if (rollup.worst.size() < worstFiles) rollup.worst.push_back(&metrics);
+        }
+    }
+
+    std::vector<OwnerRollup> result;
+    result.reserve(byOwner.size());
+    for (auto& [owner, rollup] : byOwner) {
+        // Empty files carry no weight; an owner of nothing but empty files falls back to the mean.
+        rollup.weighted_smi = rollup.lines ? rollup.weighted_smi / rollup.lines : rollup.mean_smi / rollup.files;
+        rollup.mean_smi /= rollup.files;
+        result.push_back(std::move(rollup));
+    }
+    std::stable_sort(result.begin(), result.end(), [](const OwnerRollup& a, const OwnerRollup& b) {
+        bool aUnowned = a.owner == kUnowned[0], bUnowned = b.owner == kUnowned[0];
+        if (aUnowned != bUnowned) return bUnowned;
+        return a.weighted_smi > b.weighted_smi;
+    });
+    return result;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file CodeOwners.h
+ * @brief CODEOWNERS files compiled into a per-directory matcher, and debt rolled up by owner.
+ *
+ * A CODEOWNERS line is a pattern followed by owners, and the last matching line
+ * wins. Testing every path against every line costs patterns x paths.
+ * load() instead compiles all lines into one matcher:
+ *  - each pattern becomes a sequence of path segments: literals, single-segment
+ *    globs (`*`, `?`), and `**`, which spans any number of segments;
+ *  - the leading literal segments of anchored patterns (`/src/net/`, `docs/api/`)
+ *    go into a trie of directory names, so a pattern is only considered inside the
+ *    directory its literal prefix names. Unanchored patterns (`*.js`, `build/`) sit
+ *    at the root and are considered everywhere;
+ *  - the rest of each pattern runs as a small automaton over segments. A
+ *    directory's automaton states are computed once, from its parent's, and the
+ *    files in it only test the states that are one segment from a match.
+ * A pattern that matches a directory owns everything below it, except a
+ * pattern whose last segment is a lone `*`: as on GitHub, that owns only the
+ * files directly in the directory before it. Once a rule owns a directory,
+ * automaton states of earlier rules are dropped, since they can no longer win.
+ *
+ * Patterns are relative to the repository root. That is the directory holding
+ * the CODEOWNERS file, or its parent when the file is in `.github/` or `docs/`.
+ * Negation (`!`) is rejected as it is on GitHub. GitLab `[Section]` headers are
+ * skipped, and the lines under them apply as usual.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef CODE_OWNERS_H
+#define CODE_OWNERS_H
+
+#include "Metrics.h"
+#include "PathTable.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct OwnerRollup
+ * @brief One owner's share of the analyzed files.
+ */
+struct OwnerRollup {
+    std::string owner;                 ///< As written in CODEOWNERS, or "(unowned)".
+    size_t files = 0;
+    uint64_t lines = 0;
+    double mean_smi = 0.0;
+    double weighted_smi = 0.0;         ///< SMI weighted by each file's line count.
+    std::vector<const FileMetrics*> worst; ///< The owner's worst files, worst first.
+};
+
+class CodeOwners {
+public:
+    static constexpr int kNoRule = -1;
+
+    /**
+     * @brief Reads and compiles a CODEOWNERS file, replacing any earlier one.
+     * @param error Receives "path:line: message" on failure.
+     */
+    bool load(const std::string& path, std::string& error);
+
+    /// @return The index of the last rule matching the file, or kNoRule. Not thread-safe: it fills the directory cache.
+    int ruleFor(PathId file);
+
+    /// @return The owners a rule lists; a rule may list none, which leaves its files unowned.
+    const std::vector<std::string>& owners(int rule) const { return rules[rule].owners; }
+
+    size_t ruleCount() const { return rules.size(); }
+
+    /// Directories whose automaton states have been computed so far.
+    size_t directoriesEvaluated() const { return states.size(); }
+
+    /**
+     * @brief Sums the files of every owner. A file with several owners counts for each.
+     * @param files Files in ranking order, worst first; the rollups point into it.
+     * @param worstFiles How many of each owner's worst files to list.
+     * @return Owners by line-weighted SMI, worst first. Unowned files come last.
+     */
+    std::vector<OwnerRollup> rollUp(const std::vector<FileMetrics>& files, size_t worstFiles);
+
+private:
+    enum class SegmentKind : uint8_t { Literal, Glob, AnyDepth };
+
+    struct Segment {
+        SegmentKind kind;
+        std::string text; ///< Unescaped for literals; the raw pattern for globs.
+    };
+
+    struct Rule {
+        std::vector<Segment> segments;
+        std::vector<std::string> owners;
+        bool directory_only = false; ///< The pattern ended in `/`.
+        bool descendants = true;     ///< A match on a directory owns everything below it.
+    };
+
+    /// A rule's automaton after consuming a directory's path: segments[position] is next.
+    struct Thread {
+        int rule;
+        uint32_t position;
+        bool operator==(const Thread& other) const { return rule == other.rule && position == other.position; }
+    };
+
+    struct TrieNode {
+        std::unordered_map<std::string, uint32_t> children;
+        std::vector<Thread> starts; ///< Rules whose literal prefix ends here, at their first non-prefix segment.
+    };
+
+    struct DirectoryState {
+        int inherited = kNoRule;     ///< Last rule matching this directory or an ancestor.
+        int32_t trie = -1;           ///< The trie node for this directory, if its path is a literal prefix.
+        bool outside = false;        ///< Not below the repository root; nothing matches.
+        std::vector<Thread> threads; ///< Closed over `**`, rules above `inherited` only, highest rule first.
+    };
+
+    std::string root; ///< Absolute, normalized repository root.
+    std::vector<Rule> rules;
+    std::vector<TrieNode> trie;
+    std::vector<DirectoryState> states;
+    std::unordered_map<PathId, uint32_t> directoryStates; ///< PathId of a directory -> index in `states`.
+
+    bool compile(std::string_view pattern, std::vector<std::string> owners, std::string& error);
+    DirectoryState rootState() const;
+    DirectoryState step(const DirectoryState& parent, std::string_view name) const;
+    void addThread(DirectoryState& state, Thread thread) const;
+    uint32_t stateOf(PathId directory);
+    static bool globMatch(std::string_view pattern, std::string_view text);
+};
+
+#endif // CODE_OWNERS_H
@@ -0,0 +1,295 @@
+// src/CqaApi.cpp
+// Implementation of the libcqa C API (cqa.h) on top of Parser and Analyzer.
+#include "cqa.h"
+#include "Analyzer.h"
+#include "LockStats.h"
+#include "Parser.h"
+#include "Pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /// Per-input outcome of a batch, filled by whichever thread claimed the input.
+    struct Slot {
+        cqa_file_status status = CQA_FILE_OK;
+        FileMetrics metrics;
+    };
+
+    /// Like getLanguageFromFile(), but sniffs the buffer rather than reading the file.
+    Language inputLanguage(const cqa_input& input) {
+        if (input.language) return LanguageRegistry::fromName(input.language);
+        if (!input.path) return Language::Unsupported;
+        Language language = LanguageRegistry::fromExtension(input.path);
+        if (language == Language::Unsupported && input.data && LanguageRegistry::needsSniffing(input.path)) {
+            language = LanguageRegistry::sniff(std::string_view(input.data, input.size));
+        }
+        return language;
+    }
+
+    cqa_file_status analyzeInput(const cqa_input& input, AnalysisWorkspace& workspace, FileMetrics& metrics) {
+        Language language = inputLanguage(input);
+        Analyzer* analyzer = workspace.analyzer(language);
+        if (!analyzer) return CQA_FILE_UNSUPPORTED_LANGUAGE;
+
+        // Parsed and analyzed in place; the caller's buffer is never copied.
+        std::string_view source(input.data ? input.data : "", input.size);
+        cqa_file_status status = CQA_FILE_PARSE_ERROR;
+        if (workspace.parser.parse(source, language)) {
+            // Results carry no path, so a long-running embedder does not grow the shared path table.
+            analyzer->analyze(workspace.parser.getRootNode(), PathTable::kNoPath, source, metrics);
+            status = CQA_FILE_OK;
+        }
+        workspace.parser.reset();
+        return status;
+    }
+
+    /// Grows a library-owned array to hold at least `needed` elements.
+    template <typename T>
+    bool reserve(T*& array, size_t& capacity, size_t needed) {
+        if (needed <= capacity && array) return true;
+        size_t grown = std::max<size_t>(needed, 1);
+        void* memory = std::realloc(array, grown * sizeof(T));
+        if (!memory) return false;
+        array = static_cast<T*>(memory);
+        capacity = grown;
+        return true;
+    }
+
+} // namespace
+
+/**
+ * The worker pool. Threads sleep between batches; a batch hands out inputs through
+ * an atomic cursor, and each thread keeps one AnalysisWorkspace (parser and analyzers)
+ * for the context's lifetime. Result slots are kept across batches too, so with
+ * caller-provided arrays a warmed-up context analyzes a batch without allocating.
+ */
+struct cqa_context {
+    std::vector<std::unique_ptr<AnalysisWorkspace>> workspaces; ///< One per thread; index 0 belongs to the caller.
+    std::vector<std::thread> workers;
+
+    LockStats::Mutex batchMutex{"libcqa batch"}; ///< Serializes cqa_analyze() calls.
+    LockStats::Mutex mutex{"libcqa pool"};
+    std::condition_variable_any wake;
+    std::condition_variable_any finished;
+    uint64_t generation = 0; ///< Bumped for every batch; guarded by `mutex`.
+    unsigned busy = 0;       ///< Workers still draining the batch; guarded by `mutex`.
+    bool stopping = false;   ///< Guarded by `mutex`.
+
+    // The current batch; written before `generation` is bumped.
+    const cqa_input* inputs = nullptr;
+    size_t count = 0;
+    std::vector<Slot> slots; ///< Only grows, so its buffers are reused by later batches.
+    std::atomic<size_t> next{0};
+    std::atomic<int> failure{CQA_OK};
+
+    void drain(AnalysisWorkspace& workspace) {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            Slot& slot = slots[i];
+            try {
+                slot.status = analyzeInput(inputs[i], workspace, slot.metrics);
+            } catch (const std::bad_alloc&) {
+                failure.store(CQA_ERROR_OUT_OF_MEMORY);
+            } catch (...) {
+                failure.store(CQA_ERROR_INTERNAL);
+            }
+        }
+    }
+
+    void workerLoop(unsigned index) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<LockStats::Mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            drain(*workspaces[index]);
+            std::lock_guard<LockStats::Mutex> lock(mutex);
+            if (--busy == 0) finished.notify_one();
+        }
+    }
+
+    /// Stops the worker threads and joins them.
+    void stop() {
+        {
+            std::lock_guard<LockStats::Mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+        workers.clear();
+    }
+
+    void run(const cqa_input* batch, size_t batchSize) {
+        inputs = batch;
+        count = batchSize;
+        if (slots.size() < count) slots.resize(count);
+        next.store(0);
+        failure.store(CQA_OK);
+        {
+            std::lock_guard<LockStats::Mutex> lock(mutex);
+            busy = static_cast<unsigned>(workers.size());
+            ++generation;
+        }
+        wake.notify_all();
+        drain(*workspaces[0]);
+        std::unique_lock<LockStats::Mutex> lock(mutex);
+        finished.wait(lock, [&] { return busy == 0; });
+    }
+};
+
+extern "C" {
+
+uint32_t cqa_version(void) {
+    return CQA_API_VERSION;
+}
+
+const char* cqa_status_string(cqa_status status) {
+    switch (status) {
+        case CQA_OK: return "ok";
+        case CQA_ERROR_INVALID_ARGUMENT: return "invalid argument";
+        case CQA_ERROR_BUFFER_TOO_SMALL: return "result buffer too small";
+        case CQA_ERROR_OUT_OF_MEMORY: return "out of memory";
+        case CQA_ERROR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+const char* cqa_detect_language(const char* path) {
+    if (!path) return nullptr;
+    Language language = LanguageRegistry::fromExtension(path);
+    return language == Language::Unsupported ? nullptr : LanguageRegistry::name(language);
+}
+
+cqa_status cqa_context_create(unsigned threads, cqa_context** context) {
+    if (!context) return CQA_ERROR_INVALID_ARGUMENT;
+    *context = nullptr;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    try {
+        auto created = std::make_unique<cqa_context>();
+        for (unsigned i = 0; i < threads; ++i) created->workspaces.push_back(std::make_unique<AnalysisWorkspace>());
+        created->workers.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; ++i) {
+            try {
+                created->workers.emplace_back(&cqa_context::workerLoop, created.get(), i);
+            } catch (...) {
+                // Out of threads: the ones already running must be joined before the context goes.
+                created->stop();
+                throw;
+            }
+        }
+        *context = created.release();
+        return CQA_OK;
+    } catch (const std::bad_alloc&) {
+        return CQA_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return CQA_ERROR_INTERNAL;
+    }
+}
+
+void cqa_context_destroy(cqa_context* context) {
+    if (!context) return;
+    context->stop();
+    delete context;
+}
+
+cqa_status cqa_analyze(cqa_context* context, const cqa_input* inputs, size_t count, cqa_results* results) {
+    if (!context || !results || (count && !inputs)) return CQA_ERROR_INVALID_ARGUMENT;
+    for (size_t i = 0; i < count; ++i) {
+        if (!inputs[i].data && inputs[i].size) return CQA_ERROR_INVALID_ARGUMENT;
+    }
+
+    try {
+        // The slots belong to the context, so they are read under the batch lock as well.
+        std::lock_guard<LockStats::Mutex> lock(context->batchMutex);
+        context->run(inputs, count);
+        int failure = context->failure.load();
+        if (failure != CQA_OK) return static_cast<cqa_status>(failure);
+
+        const std::vector<Slot>& slots = context->slots;
+        size_t functionCount = 0;
+        size_t namesSize = 0;
+        for (size_t i = 0; i < count; ++i) {
+            // Slots of failed inputs still hold the metrics of an earlier batch.
+            const Slot& slot = slots[i];
+            if (slot.status != CQA_FILE_OK) continue;
+            functionCount += slot.metrics.functions.size();
+            namesSize += slot.metrics.functions.nameBytes() + slot.metrics.functions.size();
+        }
+        // Offsets in the result structs are 32-bit to keep them compact.
+        if (functionCount > UINT32_MAX || namesSize > UINT32_MAX) return CQA_ERROR_INVALID_ARGUMENT;
+        results->file_count = count;
+        results->function_count = functionCount;
+        results->names_size = namesSize;
+
+        if (!results->files || results->library_owned) {
+            results->library_owned = 1;
+            if (!reserve(results->files, results->file_capacity, count) ||
+                !reserve(results->functions, results->function_capacity, functionCount) ||
+                !reserve(results->names, results->names_capacity, namesSize)) {
+                return CQA_ERROR_OUT_OF_MEMORY;
+            }
+        } else if (results->file_capacity < count || (functionCount && !results->functions) ||
+                   results->function_capacity < functionCount || (namesSize && !results->names) ||
+                   results->names_capacity < namesSize) {
+            return CQA_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        uint32_t function = 0;
+        uint32_t offset = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const FileMetrics& metrics = slots[i].metrics;
+            cqa_file_result& file = results->files[i];
+            std::memset(&file, 0, sizeof(file));
+            file.status = slots[i].status;
+            file.function_begin = function;
+            if (slots[i].status != CQA_FILE_OK) continue;
+
+            file.function_count = static_cast<uint32_t>(metrics.functions.size());
+            file.total_lines = metrics.total_lines;
+            file.comment_lines = metrics.comment_lines;
+            file.naming_violations = metrics.naming_violations;
+            file.avg_function_length = metrics.avg_function_length;
+            file.avg_function_complexity = metrics.avg_function_complexity;
+            file.comment_coverage_ratio = metrics.comment_coverage_ratio;
+            file.shit_mountain_index = metrics.shit_mountain_index;
+            for (const FunctionView metric : metrics.functions) {
+                cqa_function_result& out = results->functions[function++];
+                out.name_offset = offset;
+                out.name_length = static_cast<uint32_t>(metric.name.size());
+                out.line_start = metric.line_start;
+                out.line_end = metric.line_end;
+                out.line_count = metric.line_count;
+                out.complexity = metric.complexity;
+                std::memcpy(results->names + offset, metric.name.data(), metric.name.size());
+                results->names[offset + metric.name.size()] = '\0';
+                offset += out.name_length + 1;
+            }
+        }
+        return CQA_OK;
+    } catch (const std::bad_alloc&) {
+        return CQA_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return CQA_ERROR_INTERNAL;
+    }
+}
+
+void cqa_results_free(cqa_results* results) {
+    if (!results || !results->library_owned) return;
+    std::free(results->files);
+    std::free(results->functions);
+    std::free(results->names);
+    std::memset(results, 0, sizeof(*results));
+}
+
+} // extern "C"
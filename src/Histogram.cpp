@@ -0,0 +1,88 @@
+// src/Histogram.cpp
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint64_t kSubBucketCount = uint64_t(1) << Histogram::kSubBucketBits;
+constexpr uint64_t kHalfCount = kSubBucketCount / 2;
+constexpr uint64_t kMaxValue = (uint64_t(1) << Histogram::kMaxValueBits) - 1;
+
+int mostSignificantBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+}
+
+} // namespace
+
+// --- HistogramSnapshot ---
+
+HistogramSnapshot::HistogramSnapshot() : counts(Histogram::kBucketCount, 0) {}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+    total += other.total;
+    valueSum += other.valueSum;
+}
+
+uint64_t HistogramSnapshot::countAtOrBelow(uint64_t value) const {
+    uint64_t below = 0;
+    for (size_t i = 0; i < counts.size() && Histogram::bucketUpperBound(i) <= value; ++i) {
+        below += counts[i];
+    }
+    return below;
+}
+
+uint64_t HistogramSnapshot::quantile(double q) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return Histogram::bucketUpperBound(i);
+    }
+    return kMaxValue;
+}
+
+// --- Histogram ---
+
+Histogram::Histogram() : counts(new std::atomic<uint64_t>[kBucketCount]) {
+    for (size_t i = 0; i < kBucketCount; ++i) counts[i].store(0, std::memory_order_relaxed);
+}
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    value = std::min(value, kMaxValue);
+    if (value < kSubBucketCount) return static_cast<size_t>(value);
+    // Shift so the top kSubBucketBits-1 bits select a sub-bucket within the power-of-two range.
+    int exponent = mostSignificantBit(value) - (kSubBucketBits - 1);
+    return static_cast<size_t>(kSubBucketCount + (exponent - 1) * kHalfCount + ((value >> exponent) - kHalfCount));
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < kSubBucketCount) return index;
+    uint64_t offset = index - kSubBucketCount;
+    int exponent = static_cast<int>(offset / kHalfCount) + 1;
+    uint64_t mantissa = offset % kHalfCount + kHalfCount;
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    // Single writer: a relaxed load/store pair is enough and avoids a locked instruction.
+    std::atomic<uint64_t>& bucket = counts[bucketIndex(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    valueSum.store(valueSum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot copy;
+    // Derive the total from the copied buckets so it stays consistent under concurrent recording.
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        copy.counts[i] = counts[i].load(std::memory_order_relaxed);
+        copy.total += copy.counts[i];
+    }
+    copy.valueSum = valueSum.load(std::memory_order_relaxed);
+    return copy;
+}
@@ -0,0 +1,326 @@
+// src/HttpClient.cpp
+#include "HttpClient.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+constexpr size_t kMaxHeaderBytes = 64 * 1024;
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(begin, end - begin + 1);
+}
+
+enum class Parse { Incomplete, Complete, Malformed };
+
+/**
+ * @brief Parses the response at the front of `data`.
+ * @param closed The connection has ended, which completes a body that runs to the end of the connection.
+ * @param consumed Receives the response's length in `data`.
+ * @param keepAlive Receives whether the server keeps the connection open afterwards.
+ */
+Parse parseResponse(const std::string& data, bool headRequest, bool closed, HttpResponse& response,
+                    size_t& consumed, bool& keepAlive) {
+    size_t headerEnd = data.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return data.size() > kMaxHeaderBytes ? Parse::Malformed : Parse::Incomplete;
+
+    size_t lineEnd = data.find("\r\n");
+    std::string statusLine = data.substr(0, lineEnd);
+    size_t space = statusLine.find(' ');
+    if (statusLine.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) return Parse::Malformed;
+    response.status = std::atoi(statusLine.c_str() + space + 1);
+    bool http11 = statusLine.compare(0, space, "HTTP/1.1") == 0;
+
+    std::string contentLength, transferEncoding, connection;
+    for (size_t pos = lineEnd + 2; pos < headerEnd;) {
+        size_t next = data.find("\r\n", pos);
+        std::string line = data.substr(pos, next - pos);
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            std::string name = toLower(trim(line.substr(0, colon)));
+            std::string value = trim(line.substr(colon + 1));
+            if (name == "content-length") contentLength = value;
+            else if (name == "transfer-encoding") transferEncoding = toLower(value);
+            else if (name == "connection") connection = toLower(value);
+            else if (name == "content-type") response.content_type = value;
+        }
+        pos = next + 2;
+    }
+    keepAlive = http11 ? connection != "close" : connection == "keep-alive";
+
+    size_t bodyStart = headerEnd + 4;
+    response.body.clear();
+    if (headRequest || response.status == 204 || response.status == 304 || response.status / 100 == 1) {
+        consumed = bodyStart;
+    } else if (transferEncoding.find("chunked") != std::string::npos) {
+        size_t pos = bodyStart;
+        for (;;) {
+            size_t sizeEnd = data.find("\r\n", pos);
+            if (sizeEnd == std::string::npos) return Parse::Incomplete;
+            char* end = nullptr;
+            unsigned long long size = std::strtoull(data.c_str() + pos, &end, 16);
+            if (end == data.c_str() + pos) return Parse::Malformed;
+            pos = sizeEnd + 2;
+            if (size == 0) {
+                // Trailers, if any, end with an empty line.
+                size_t trailerEnd = data.find("\r\n", pos);
+                while (trailerEnd != std::string::npos && trailerEnd != pos) {
+                    pos = trailerEnd + 2;
+                    trailerEnd = data.find("\r\n", pos);
+                }
+                if (trailerEnd == std::string::npos) return Parse::Incomplete;
+                consumed = trailerEnd + 2;
+                break;
+            }
+            if (data.size() < pos + size + 2) return Parse::Incomplete;
+            response.body.append(data, pos, size);
+            pos += size + 2;
+        }
+    } else if (!contentLength.empty()) {
+        size_t length = std::strtoull(contentLength.c_str(), nullptr, 10);
+        if (data.size() - bodyStart < length) return Parse::Incomplete;
+        response.body = data.substr(bodyStart, length);
+        consumed = bodyStart + length;
+    } else {
+        // No length: the body is everything up to the end of the connection.
+        if (!closed) return Parse::Incomplete;
+        response.body = data.substr(bodyStart);
+        consumed = data.size();
+        keepAlive = false;
+    }
+    return Parse::Complete;
+}
+
+} // namespace
+
+bool HttpClient::open(const std::string& url, std::string& error) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        error = "only http:// URLs are supported: " + url;
+        return false;
+    }
+    size_t slash = url.find('/', scheme.size());
+    std::string authority = url.substr(scheme.size(), slash == std::string::npos ? std::string::npos : slash - scheme.size());
+    base = slash == std::string::npos ? "" : url.substr(slash);
+    while (!base.empty() && base.back() == '/') base.pop_back();
+
+    // "[v6]:port", "host:port" or a bare host.
+    size_t portColon = authority.rfind(':');
+    if (portColon != std::string::npos && authority.find(']', portColon) != std::string::npos) portColon = std::string::npos;
+    host = authority.substr(0, portColon);
+    port = 80;
+    if (portColon != std::string::npos) {
+        std::string digits = authority.substr(portColon + 1);
+        char* end = nullptr;
+        unsigned long value = std::strtoul(digits.c_str(), &end, 10);
+        if (digits.empty() || *end != '\0' || value == 0 || value > 65535) {
+            error = "invalid port in URL: " + url;
+            return false;
+        }
+        port = static_cast<uint16_t>(value);
+    }
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    if (host.empty()) {
+        error = "missing host in URL: " + url;
+        return false;
+    }
+    return true;
+}
+
+#if !defined(_WIN32)
+
+HttpClient::~HttpClient() {
+    for (int fd : idle) close(fd);
+}
+
+int HttpClient::takeIdle() {
+    std::lock_guard<std::mutex> lock(idleMutex);
+    if (idle.empty()) return -1;
+    int fd = idle.back();
+    idle.pop_back();
+    return fd;
+}
+
+void HttpClient::putIdle(int fd) {
+    std::lock_guard<std::mutex> lock(idleMutex);
+    idle.push_back(fd);
+}
+
+int HttpClient::connectSocket(int waitMs, std::string& error) const {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int status = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+    if (status != 0) {
+        error = host + ": " + gai_strerror(status);
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) continue;
+        // Non-blocking throughout: connecting is bounded by the timeout, and a batch is
+        // written and read at the same time so neither side's buffers can fill up and stall.
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            int result = errno;
+            if (result == EINPROGRESS) {
+                pollfd pfd{fd, POLLOUT, 0};
+                socklen_t length = sizeof(result);
+                if (poll(&pfd, 1, waitMs) <= 0) {
+                    result = ETIMEDOUT;
+                } else if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &result, &length) != 0) {
+                    result = errno;
+                }
+            }
+            if (result != 0) {
+                error = host + ":" + std::to_string(port) + ": " + std::strerror(result);
+                close(fd);
+                fd = -1;
+            }
+        }
+    }
+    freeaddrinfo(addresses);
+    return fd;
+}
+
+bool HttpClient::exchange(const std::vector<HttpRequest>& requests, std::vector<HttpResponse>& responses,
+                          std::string& error) {
+    responses.clear();
+    std::string authority = (host.find(':') != std::string::npos ? "[" + host + "]" : host) + ":" + std::to_string(port);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(exchangeTimeoutMs);
+    // Every wait is bounded by the timeout and by what is left of the exchange's deadline.
+    auto waitMs = [&] {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(timeoutMs, left.count())));
+    };
+    while (responses.size() < requests.size()) {
+        int fd = takeIdle();
+        bool reused = fd >= 0;
+        if (!reused) fd = connectSocket(waitMs(), error);
+        if (fd < 0) return false;
+
+        size_t first = responses.size();
+        std::string out;
+        for (size_t i = first; i < requests.size(); ++i) {
+            const HttpRequest& request = requests[i];
+            out += request.method + " " + base + request.path + " HTTP/1.1\r\nHost: " + authority + "\r\n";
+            for (const auto& [name, value] : request.headers) out += name + ": " + value + "\r\n";
+            if (!request.body.empty() || request.method == "PUT" || request.method == "POST") {
+                out += "Content-Length: " + std::to_string(request.body.size()) + "\r\n";
+            }
+            out += "\r\n";
+            out += request.body;
+        }
+
+        size_t sent = 0;
+        std::string in;
+        bool closed = false;
+        bool closing = false; ///< The last response said the server closes the connection after it.
+        char chunk[16384];
+        while (responses.size() < requests.size() && !closing) {
+            HttpResponse response;
+            size_t consumed = 0;
+            bool keepAlive = true;
+            Parse parsed = parseResponse(in, requests[responses.size()].method == "HEAD", closed, response,
+                                         consumed, keepAlive);
+            if (parsed == Parse::Malformed) {
+                error = "malformed response from " + authority;
+                close(fd);
+                return false;
+            }
+            if (parsed == Parse::Complete) {
+                responses.push_back(std::move(response));
+                in.erase(0, consumed);
+                closing = !keepAlive;
+                continue;
+            }
+            if (closed) break;
+
+            pollfd pfd{fd, static_cast<short>(POLLIN | (sent < out.size() ? POLLOUT : 0)), 0};
+            int ready = poll(&pfd, 1, waitMs());
+            if (ready <= 0) {
+                error = ready == 0 ? "timed out waiting for " + authority : std::strerror(errno);
+                close(fd);
+                return false;
+            }
+            if ((pfd.revents & POLLOUT) && sent < out.size()) {
+                ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+                if (n > 0) {
+                    sent += static_cast<size_t>(n);
+                } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    sent = out.size(); // The server stopped reading; collect what it answered.
+                }
+            }
+            if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n > 0) {
+                    in.append(chunk, static_cast<size_t>(n));
+                } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    closed = true;
+                }
+            }
+        }
+        // Keep the connection for the next batch only if it is idle and the server keeps it open.
+        if (responses.size() == requests.size() && !closing && !closed && in.empty()) {
+            putIdle(fd);
+        } else {
+            close(fd);
+        }
+        if (responses.size() == first) {
+            // The server may have closed a kept connection while it sat idle; that is not an error.
+            if (reused) continue;
+            error = "connection to " + authority + " closed without a response";
+            return false;
+        }
+    }
+    return true;
+}
+
+#else
+
+HttpClient::~HttpClient() = default;
+
+int HttpClient::connectSocket(int, std::string& error) const {
+    error = "the built-in HTTP client is not supported on Windows";
+    return -1;
+}
+
+bool HttpClient::exchange(const std::vector<HttpRequest>&, std::vector<HttpResponse>&, std::string& error) {
+    error = "the built-in HTTP client is not supported on Windows";
+    return false;
+}
+
+#endif
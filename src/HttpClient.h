@@ -0,0 +1,77 @@
+/**
+ * @file HttpClient.h
+ * @brief A minimal, dependency-free HTTP/1.1 client for one origin.
+ *
+ * Used by the remote result cache. Requests are sent in batches: every request
+ * of a batch is written to one connection before the responses are read
+ * (pipelining), so a batch costs one round trip rather than one per request.
+ * Connections the server keeps alive are reused by later batches, so a run pays
+ * for one TCP handshake per thread rather than one per batch. A server that
+ * closes the connection part way through a batch, as HTTP/1.0 servers do after
+ * each response, gets the rest on a new connection, and so does a batch whose
+ * reused connection the server had already closed as idle. Plain
+ * `http://` only; put a TLS-terminating proxy in front of a remote server.
+ * Only POSIX sockets are supported.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include "HttpServer.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class HttpClient {
+public:
+    HttpClient() = default;
+    ~HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    /**
+     * @brief Sets the server from a URL of the form `http://host[:port][/base/path]`.
+     * Nothing is connected until the first exchange.
+     * @return False if the URL is malformed or not `http://`.
+     */
+    bool open(const std::string& url, std::string& error);
+
+    /// Bounds connecting and every wait for the server; the default is five seconds.
+    void setTimeout(int milliseconds) { timeoutMs = milliseconds; }
+
+    /// Bounds a whole exchange, so a server that trickles bytes cannot stall it; the default is ten seconds.
+    void setExchangeTimeout(int milliseconds) { exchangeTimeoutMs = milliseconds; }
+
+    /**
+     * @brief Sends a batch of requests and collects their responses, in order.
+     * Request paths are taken relative to the URL's path.
+     * Requests are resent on a new connection if the server closes the old one
+     * early, so they should be idempotent (GET, HEAD, PUT). Safe to call from
+     * several threads; each batch uses a connection of its own.
+     * @param responses Receives one response per request answered.
+     * @return False on a network error or timeout; `responses` then holds the
+     * responses received before it.
+     */
+    bool exchange(const std::vector<HttpRequest>& requests, std::vector<HttpResponse>& responses, std::string& error);
+
+private:
+    std::string host;
+    uint16_t port = 80;
+    std::string base; ///< The URL's path without a trailing slash; may be empty.
+    int timeoutMs = 5000;
+    int exchangeTimeoutMs = 10000;
+    std::mutex idleMutex;
+    std::vector<int> idle; ///< Open connections the server keeps alive, ready for the next batch.
+
+    /// Connects, waiting at most `waitMs`.
+    int connectSocket(int waitMs, std::string& error) const;
+    /// @return An idle connection, or -1 if there is none.
+    int takeIdle();
+    void putIdle(int fd);
+};
+
+#endif // HTTP_CLIENT_H
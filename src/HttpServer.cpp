@@ -0,0 +1,230 @@
+// src/HttpServer.cpp
+#include "HttpServer.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+constexpr size_t kMaxHeaderBytes = 64 * 1024;
+constexpr size_t kMaxBodyBytes = 256 * 1024 * 1024;
+constexpr int kPollIntervalMs = 200;
+constexpr int kIdleTimeoutMs = 2000; ///< How long a connection may sit between (or within) requests.
+constexpr size_t kMaxConnections = 64;
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+const char* HttpServer::statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        default:  return "Internal Server Error";
+    }
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+#if !defined(_WIN32)
+
+bool HttpServer::start(const std::string& bindAddress, uint16_t port, Handler requestHandler, std::string& error) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1) {
+        error = "invalid bind address: " + bindAddress;
+    } else if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+               listen(listenFd, 64) != 0) {
+        error = std::strerror(errno);
+    } else {
+        socklen_t length = sizeof(address);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+        boundPort = ntohs(address.sin_port);
+        handler = std::move(requestHandler);
+        running = true;
+        acceptThread = std::thread(&HttpServer::acceptLoop, this);
+        return true;
+    }
+    close(listenFd);
+    listenFd = -1;
+    return false;
+}
+
+void HttpServer::stop() {
+    if (!running.exchange(false)) return;
+    if (acceptThread.joinable()) acceptThread.join();
+    close(listenFd);
+    listenFd = -1;
+}
+
+void HttpServer::acceptLoop() {
+    while (running) {
+        reapConnections(false);
+        if (connections.size() >= kMaxConnections) {
+            // Further clients wait in the listen backlog until a connection ends.
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, kPollIntervalMs) <= 0) continue;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        Connection& connection = connections.emplace_back();
+        connection.thread = std::thread([this, fd, &connection] {
+            serveConnection(fd);
+            close(fd);
+            connection.done = true;
+        });
+    }
+    reapConnections(true);
+}
+
+void HttpServer::reapConnections(bool all) {
+    for (auto it = connections.begin(); it != connections.end();) {
+        if (all || it->done) {
+            it->thread.join();
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void HttpServer::serveConnection(int fd) {
+    // Requests may be pipelined: `data` holds everything received past the previous request.
+    std::string data;
+    char chunk[8192];
+    for (;;) {
+        size_t headerEnd;
+        while ((headerEnd = data.find("\r\n\r\n")) == std::string::npos) {
+            if (data.size() > kMaxHeaderBytes || !running) return;
+            // A silent client must not hold a connection thread for long.
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, kIdleTimeoutMs) <= 0) return;
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return;
+            data.append(chunk, static_cast<size_t>(n));
+        }
+
+        HttpRequest request;
+        HttpResponse response;
+        bool keepAlive = false;
+        size_t consumed = headerEnd + 4;
+        size_t lineEnd = data.find("\r\n");
+        std::string requestLine = data.substr(0, lineEnd);
+        size_t firstSpace = requestLine.find(' ');
+        size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+        if (firstSpace == std::string::npos || secondSpace == std::string::npos) {
+            response.status = 400;
+        } else {
+            request.method = requestLine.substr(0, firstSpace);
+            request.path = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+            size_t pos = lineEnd + 2;
+            while (pos < headerEnd) {
+                size_t next = data.find("\r\n", pos);
+                std::string line = data.substr(pos, next - pos);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    request.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+                }
+                pos = next + 2;
+            }
+            // HTTP/1.1 keeps the connection open unless asked not to; HTTP/1.0 only when asked to.
+            auto connection = request.headers.find("connection");
+            std::string option = connection == request.headers.end() ? "" : toLower(connection->second);
+            keepAlive = requestLine.compare(secondSpace + 1, std::string::npos, "HTTP/1.1") == 0
+                            ? option != "close"
+                            : option == "keep-alive";
+
+            size_t contentLength = 0;
+            auto it = request.headers.find("content-length");
+            if (it != request.headers.end()) contentLength = std::strtoull(it->second.c_str(), nullptr, 10);
+            if (contentLength > kMaxBodyBytes) {
+                response.status = 413;
+                keepAlive = false;
+            } else {
+                while (data.size() - consumed < contentLength) {
+                    pollfd pfd{fd, POLLIN, 0};
+                    if (poll(&pfd, 1, kIdleTimeoutMs) <= 0) return;
+                    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                    if (n <= 0) return;
+                    data.append(chunk, static_cast<size_t>(n));
+                }
+                request.body = data.substr(consumed, contentLength);
+                consumed += contentLength;
+                response = handler(request);
+            }
+        }
+        data.erase(0, consumed);
+
+        std::string reply = "HTTP/1.1 " + std::to_string(response.status) + " " + statusText(response.status) + "\r\n" +
+                            "Content-Type: " + response.content_type + "\r\n" +
+                            "Content-Length: " + std::to_string(response.body.size()) + "\r\n" +
+                            (keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+        if (request.method != "HEAD") reply += response.body;
+        size_t sent = 0;
+        while (sent < reply.size()) {
+            ssize_t n = send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            sent += static_cast<size_t>(n);
+        }
+        if (!keepAlive) return;
+    }
+}
+
+#else
+
+bool HttpServer::start(const std::string&, uint16_t, Handler, std::string& error) {
+    error = "the built-in HTTP server is not supported on Windows";
+    return false;
+}
+
+void HttpServer::stop() {}
+void HttpServer::acceptLoop() {}
+void HttpServer::serveConnection(int) {}
+void HttpServer::reapConnections(bool) {}
+
+#endif
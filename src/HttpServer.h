@@ -0,0 +1,96 @@
+/**
+ * @file HttpServer.h
+ * @brief A minimal, dependency-free HTTP/1.1 server for local endpoints.
+ *
+ * Used to expose live metrics (`--serve-metrics`) and by the bundled remote
+ * cache server (`cqa-cache-server`). It accepts connections on a background
+ * thread and serves each on a thread of its own, up to 64 at a time, so the
+ * handler must be thread-safe. A connection may carry several requests,
+ * pipelined or not (HTTP/1.1 keep-alive), which lets a cache client send a whole
+ * batch of lookups in one round trip and keep the connection for the next batch;
+ * a connection idle for two seconds is closed. It is intended for trusted
+ * networks, not as a general-purpose web server. Only POSIX sockets are supported.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+#include <thread>
+
+/**
+ * @struct HttpRequest
+ * @brief A parsed request. Header names are lower-cased.
+ */
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> headers;
+    std::string body;
+};
+
+/**
+ * @struct HttpResponse
+ * @brief The handler's reply.
+ */
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "text/plain; charset=utf-8";
+    std::string body;
+};
+
+class HttpServer {
+public:
+    using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+    HttpServer() = default;
+    ~HttpServer();
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    /**
+     * @brief Binds, listens and starts the accept thread.
+     * @param bindAddress IPv4 address to bind, e.g. "127.0.0.1".
+     * @param port Port to listen on; 0 picks a free port (see `port()`).
+     * @param error Receives a description when starting fails.
+     * @return True if the server is running.
+     */
+    bool start(const std::string& bindAddress, uint16_t port, Handler handler, std::string& error);
+
+    /// Stops accepting connections and joins the accept and connection threads.
+    void stop();
+
+    /// @return The port actually bound.
+    uint16_t port() const { return boundPort; }
+
+    static const char* statusText(int status);
+
+private:
+    struct Connection {
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    Handler handler;
+    std::thread acceptThread;
+    std::list<Connection> connections; ///< Only touched by the accept thread.
+    std::atomic<bool> running{false};
+    int listenFd = -1;
+    uint16_t boundPort = 0;
+
+    void acceptLoop();
+    void serveConnection(int fd);
+
+    /// Joins the threads of finished connections, or of all connections.
+    void reapConnections(bool all);
+};
+
+#endif // HTTP_SERVER_H
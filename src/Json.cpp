@@ -0,0 +1,227 @@
+// src/Json.cpp
+#include "Json.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Deeply nested input is rejected rather than allowed to exhaust the stack.
+constexpr int kMaxDepth = 256;
+
+class Reader {
+public:
+    explicit Reader(const std::string& text) : text(text) {}
+
+    bool document(Json::Value& value, std::string& error) {
+        skipSpace();
+        bool ok = parseValue(value, 0) && (skipSpace(), pos == text.size() || fail("unexpected trailing data"));
+        if (!ok) error = "line " + std::to_string(line()) + ": " + message;
+        return ok;
+    }
+
+private:
+    const std::string& text;
+    size_t pos = 0;
+    std::string message;
+
+    bool fail(const char* what) {
+        message = what;
+        return false;
+    }
+
+    size_t line() const {
+        size_t lines = 1;
+        for (size_t i = 0; i < pos && i < text.size(); ++i) lines += text[i] == '\n';
+        return lines;
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && std::strchr(" \t\r\n", text[pos]) && text[pos] != '\0') ++pos;
+    }
+
+    bool consume(char expected) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != expected) return false;
+        ++pos;
+        return true;
+    }
+
+    bool literal(const char* word) {
+        size_t length = std::strlen(word);
+        if (text.compare(pos, length, word) != 0) return fail("invalid literal");
+        pos += length;
+        return true;
+    }
+
+    bool parseValue(Json::Value& value, int depth) {
+        if (depth > kMaxDepth) return fail("nesting too deep");
+        skipSpace();
+        if (pos >= text.size()) return fail("unexpected end of input");
+        switch (text[pos]) {
+        case '{': return parseObject(value, depth);
+        case '[': return parseArray(value, depth);
+        case '"': value.type = Json::Type::String; return parseString(value.string);
+        case 't': value.type = Json::Type::Bool; value.boolean = true; return literal("true");
+        case 'f': value.type = Json::Type::Bool; value.boolean = false; return literal("false");
+        case 'n': value.type = Json::Type::Null; return literal("null");
+        default: return parseNumber(value);
+        }
+    }
+
+    bool parseObject(Json::Value& value, int depth) {
+        value.type = Json::Type::Object;
+        ++pos;
+        if (consume('}')) return true;
+        do {
+            skipSpace();
+            std::string key;
+            if (pos >= text.size() || text[pos] != '"') return fail("expected a member name");
+            if (!parseString(key)) return false;
+            if (!consume(':')) return fail("expected ':'");
+            value.object.emplace_back(std::move(key), Json::Value());
+            if (!parseValue(value.object.back().second, depth + 1)) return false;
+        } while (consume(','));
+        return consume('}') || fail("expected ',' or '}'");
+    }
+
+    bool parseArray(Json::Value& value, int depth) {
+        value.type = Json::Type::Array;
+        ++pos;
+        if (consume(']')) return true;
+        do {
+            value.array.emplace_back();
+            if (!parseValue(value.array.back(), depth + 1)) return false;
+        } while (consume(','));
+        return consume(']') || fail("expected ',' or ']'");
+    }
+
+    bool parseNumber(Json::Value& value) {
+        size_t start = pos;
+        if (text[pos] == '-') ++pos;
+        if (pos >= text.size() || !std::isdigit(static_cast<unsigned char>(text[pos]))) return fail("invalid value");
+        while (pos < text.size() && std::strchr("0123456789+-.eE", text[pos]) && text[pos] != '\0') ++pos;
+        std::string digits = text.substr(start, pos - start);
+        char* end = nullptr;
+        value.type = Json::Type::Number;
+        value.number = std::strtod(digits.c_str(), &end);
+        return *end == '\0' || fail("invalid number");
+    }
+
+    static void appendUtf8(std::string& out, unsigned codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned& codepoint) {
+        if (pos + 4 > text.size()) return fail("truncated \\u escape");
+        codepoint = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text[pos++];
+            codepoint <<= 4;
+            if (c >= '0' && c <= '9') codepoint |= c - '0';
+            else if (c >= 'a' && c <= 'f') codepoint |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') codepoint |= c - 'A' + 10;
+            else return fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        ++pos; // opening quote
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char escape = text[pos++];
+            switch (escape) {
+            case '"': case '\\': case '/': out += escape; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned codepoint;
+                if (!parseHex4(codepoint)) return false;
+                // Combine a surrogate pair; a lone surrogate is kept as-is.
+                if (codepoint >= 0xD800 && codepoint < 0xDC00 && text.compare(pos, 2, "\\u") == 0) {
+                    pos += 2;
+                    unsigned low;
+                    if (!parseHex4(low)) return false;
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        appendUtf8(out, codepoint);
+                        codepoint = low;
+                    }
+                }
+                appendUtf8(out, codepoint);
+                break;
+            }
+            default: return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+};
+
+} // namespace
+
+namespace Json {
+
+    const Value* Value::find(const std::string& key) const {
+        if (type != Type::Object) return nullptr;
+        for (const auto& member : object) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+
+    double Value::numberOr(const std::string& key, double fallback) const {
+        const Value* member = find(key);
+        return member && member->type == Type::Number ? member->number : fallback;
+    }
+
+    std::string Value::stringOr(const std::string& key, const std::string& fallback) const {
+        const Value* member = find(key);
+        return member && member->type == Type::String ? member->string : fallback;
+    }
+
+    bool parse(const std::string& text, Value& value, std::string& error) {
+        value = Value();
+        return Reader(text).document(value, error);
+    }
+
+    bool parseFile(const std::string& path, Value& value, std::string& error) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return parse(contents.str(), value, error);
+    }
+
+} // namespace Json
@@ -0,0 +1,63 @@
+/**
+ * @file Json.h
+ * @brief A small JSON reader for the files the tools read back: benchmark
+ * baselines and similar configuration.
+ *
+ * The whole document is parsed into a tree of `Json::Value`s. Object members
+ * keep their file order. Numbers are held as doubles. The reader is strict
+ * (RFC 8259, no comments or trailing commas) and reports the first error with
+ * its line number.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Json {
+
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    /**
+     * @struct Value
+     * @brief One parsed JSON value; only the fields matching `type` are meaningful.
+     */
+    struct Value {
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<Value> array;
+        std::vector<std::pair<std::string, Value>> object;
+
+        /// @return The member named `key`, or nullptr if this is not an object or has no such member.
+        const Value* find(const std::string& key) const;
+
+        /// @return The member `key` as a number, or `fallback` if it is missing or not a number.
+        double numberOr(const std::string& key, double fallback) const;
+
+        /// @return The member `key` as a string, or `fallback` if it is missing or not a string.
+        std::string stringOr(const std::string& key, const std::string& fallback) const;
+    };
+
+    /**
+     * @brief Parses a complete JSON document.
+     * @param error Receives a message with the line number on failure.
+     * @return False if the text is not valid JSON.
+     */
+    bool parse(const std::string& text, Value& value, std::string& error);
+
+    /**
+     * @brief Reads and parses a JSON file.
+     * @return False if the file cannot be read or is not valid JSON.
+     */
+    bool parseFile(const std::string& path, Value& value, std::string& error);
+
+} // namespace Json
+
+#endif // JSON_H
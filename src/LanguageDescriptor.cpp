@@ -0,0 +1,508 @@
+// src/LanguageDescriptor.cpp
+#include "LanguageDescriptor.h"
+#include "Json.h"
+#include "Sha256.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace LanguageDescriptors {
+
+    /// One step of a name or skip path, resolved against the grammar.
+    struct Step {
+        enum class Kind : uint8_t { Field, Parent, Find };
+        Kind kind = Kind::Field;
+        TSFieldId field = 0;
+        std::vector<TSSymbol> symbols; ///< Parent and Find: every symbol with the step's type name.
+    };
+
+    using Path = std::vector<Step>;
+
+    struct SkipRule {
+        Path path;
+        std::vector<TSSymbol> contains;
+    };
+
+    struct FunctionRule {
+        std::vector<Path> names; ///< Tried in order; the first that reaches a node wins.
+        std::vector<SkipRule> skips;
+    };
+
+    struct LogicalRule {
+        TSFieldId field = 0;              ///< 0: every node of the rule's type is a logical operator.
+        std::vector<TSSymbol> operators;  ///< Tokens in `field` that count.
+    };
+
+    /// Per-symbol entry of the flag table.
+    struct SymbolInfo {
+        uint8_t flags = 0;
+        uint16_t function_rule = 0;
+        uint16_t logical_rule = 0;
+    };
+
+    enum : uint8_t { kFunction = 1, kComplexity = 2, kLogical = 4 };
+
+    struct Compiled {
+        std::vector<std::string> function_types;   ///< Names, for LanguageStrategy's list getters.
+        std::vector<std::string> complexity_types;
+        std::string unnamed;
+        std::vector<SymbolInfo> symbols;            ///< Indexed by TSSymbol.
+        std::vector<FunctionRule> function_rules;
+        std::vector<LogicalRule> logical_rules;
+        std::string digest;                         ///< SHA-256 of the descriptor file.
+    };
+
+    namespace {
+
+        /// Indexed by Language; null where no descriptor was loaded.
+        std::shared_ptr<const Compiled> g_compiled[LanguageRegistry::kMaxLanguages];
+
+        /// Resolves names against one grammar, remembering the first error.
+        struct Compiler {
+            const TSLanguage* grammar;
+            std::string language;
+            std::string error;
+
+            std::vector<TSSymbol> symbolsNamed(const std::string& type, const std::string& where) {
+                std::vector<TSSymbol> symbols;
+                uint32_t count = ts_language_symbol_count(grammar);
+                for (uint32_t symbol = 0; symbol < count; ++symbol) {
+                    const char* name = ts_language_symbol_name(grammar, static_cast<TSSymbol>(symbol));
+                    if (name && type == name) symbols.push_back(static_cast<TSSymbol>(symbol));
+                }
+                if (symbols.empty() && error.empty()) {
+                    error = where + ": node type '" + type + "' is not in the " + language + " grammar";
+                }
+                return symbols;
+            }
+
+            TSFieldId field(const std::string& name, const std::string& where) {
+                TSFieldId id = ts_language_field_id_for_name(grammar, name.data(), static_cast<uint32_t>(name.size()));
+                if (id == 0 && error.empty()) error = where + ": field '" + name + "' is not in the " + language + " grammar";
+                return id;
+            }
+
+            Path path(const Json::Value& steps, const std::string& where) {
+                Path compiled;
+                if (steps.type != Json::Type::Array || steps.array.empty()) {
+                    if (error.empty()) error = where + ": expected a non-empty array of steps";
+                    return compiled;
+                }
+                for (const Json::Value& step : steps.array) {
+                    size_t colon = step.string.find(':');
+                    std::string kind = step.string.substr(0, colon);
+                    std::string argument = colon == std::string::npos ? std::string() : step.string.substr(colon + 1);
+                    Step resolved;
+                    if (step.type != Json::Type::String || argument.empty()) {
+                        kind.clear();
+                    } else if (kind == "field") {
+                        resolved.kind = Step::Kind::Field;
+                        resolved.field = field(argument, where);
+                    } else if (kind == "parent" || kind == "find") {
+                        resolved.kind = kind == "parent" ? Step::Kind::Parent : Step::Kind::Find;
+                        resolved.symbols = symbolsNamed(argument, where);
+                    } else {
+                        kind.clear();
+                    }
+                    if (kind.empty() && error.empty()) {
+                        error = where + ": step '" + step.string + "' is not field:F, parent:T or find:T";
+                    }
+                    compiled.push_back(std::move(resolved));
+                }
+                return compiled;
+            }
+        };
+
+        bool stringList(const Json::Value* value, std::vector<std::string>& out, const std::string& where, std::string& error) {
+            if (!value) return true;
+            if (value->type != Json::Type::Array) {
+                error = where + ": expected an array of strings";
+                return false;
+            }
+            for (const Json::Value& item : value->array) {
+                if (item.type != Json::Type::String || item.string.empty()) {
+                    error = where + ": expected an array of strings";
+                    return false;
+                }
+                out.push_back(item.string);
+            }
+            return true;
+        }
+
+        const TSLanguage* loadLibrary(const fs::path& library, const std::string& symbol, std::string& error) {
+#if !defined(_WIN32)
+            // Never closed: the grammar's tables live in the library for the rest of the run.
+            void* handle = dlopen(library.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (!handle) {
+                error = dlerror();
+                return nullptr;
+            }
+            auto function = reinterpret_cast<const TSLanguage* (*)()>(dlsym(handle, symbol.c_str()));
+            if (!function) {
+                error = library.string() + " has no symbol " + symbol;
+                return nullptr;
+            }
+            return function();
+#else
+            (void)library;
+            (void)symbol;
+            error = "grammar libraries are not supported on this platform";
+            return nullptr;
+#endif
+        }
+
+        /// A grammar the runtime cannot use (an incompatible ABI version) is rejected by the parser.
+        bool compatible(const TSLanguage* grammar) {
+            TSParser* probe = ts_parser_new();
+            bool accepted = ts_parser_set_language(probe, grammar);
+            ts_parser_delete(probe);
+            return accepted;
+        }
+
+        const TSLanguage* resolveGrammar(const Json::Value& descriptor, const std::string& name,
+                                         const fs::path& directory, std::string& error) {
+            const Json::Value* grammar = descriptor.find("grammar");
+            if (!grammar) {
+                // Redefining a known language may keep its grammar.
+                if (LanguageRegistry::fromName(name) == Language::Unsupported) error = "grammar: required for a new language";
+                return nullptr;
+            }
+            if (grammar->type == Json::Type::String) {
+                Language builtin = LanguageRegistry::fromName(grammar->string);
+                if (!LanguageRegistry::isBuiltin(builtin)) {
+                    error = "grammar: '" + grammar->string + "' is not a built-in language";
+                    return nullptr;
+                }
+                return LanguageRegistry::grammar(builtin);
+            }
+            std::string library = grammar->stringOr("library", "");
+            if (grammar->type != Json::Type::Object || library.empty()) {
+                error = "grammar: expected a built-in language name or {\"library\": ..., \"symbol\": ...}";
+                return nullptr;
+            }
+            fs::path libraryPath(library);
+            if (libraryPath.is_relative()) libraryPath = directory / libraryPath;
+            std::string symbol = grammar->stringOr("symbol", "tree_sitter_" + name);
+            std::string loadError;
+            const TSLanguage* loaded = loadLibrary(libraryPath, symbol, loadError);
+            if (!loaded) {
+                error = "grammar: " + loadError;
+            } else if (!compatible(loaded)) {
+                error = "grammar: " + libraryPath.string() + " was built for an incompatible tree-sitter version";
+                loaded = nullptr;
+            }
+            return loaded;
+        }
+
+        /// Builds the symbol tables for `descriptor` against `grammar`.
+        bool compile(const Json::Value& descriptor, const std::string& name, const TSLanguage* grammar,
+                     Compiled& out, std::string& error) {
+            Compiler compiler{grammar, name, std::string()};
+            out.symbols.resize(ts_language_symbol_count(grammar));
+            out.unnamed = descriptor.stringOr("unnamed", "");
+
+            const Json::Value* functions = descriptor.find("functions");
+            if (!functions || functions->type != Json::Type::Array || functions->array.empty()) {
+                error = "functions: expected a non-empty array";
+                return false;
+            }
+            for (size_t i = 0; i < functions->array.size(); ++i) {
+                const Json::Value& function = functions->array[i];
+                std::string where = "functions[" + std::to_string(i) + "]";
+                std::string type = function.stringOr("type", "");
+                if (type.empty()) {
+                    error = where + ": missing \"type\"";
+                    return false;
+                }
+                FunctionRule rule;
+                if (const Json::Value* names = function.find("name")) {
+                    if (names->type != Json::Type::Array) {
+                        error = where + ".name: expected an array of paths";
+                        return false;
+                    }
+                    for (const Json::Value& path : names->array) rule.names.push_back(compiler.path(path, where + ".name"));
+                }
+                if (const Json::Value* skips = function.find("skip_if")) {
+                    if (skips->type != Json::Type::Array) {
+                        error = where + ".skip_if: expected an array";
+                        return false;
+                    }
+                    for (const Json::Value& skip : skips->array) {
+                        SkipRule compiled;
+                        const Json::Value* path = skip.find("path");
+                        compiled.path = compiler.path(path ? *path : Json::Value(), where + ".skip_if");
+                        std::vector<std::string> contains;
+                        if (!stringList(skip.find("contains"), contains, where + ".skip_if.contains", error)) return false;
+                        for (const std::string& node : contains) {
+                            std::vector<TSSymbol> symbols = compiler.symbolsNamed(node, where + ".skip_if");
+                            compiled.contains.insert(compiled.contains.end(), symbols.begin(), symbols.end());
+                        }
+                        rule.skips.push_back(std::move(compiled));
+                    }
+                }
+                uint16_t index = static_cast<uint16_t>(out.function_rules.size());
+                for (TSSymbol symbol : compiler.symbolsNamed(type, where)) {
+                    out.symbols[symbol].flags |= kFunction;
+                    out.symbols[symbol].function_rule = index;
+                }
+                out.function_rules.push_back(std::move(rule));
+                out.function_types.push_back(type);
+            }
+
+            if (!stringList(descriptor.find("complexity"), out.complexity_types, "complexity", error)) return false;
+            for (const std::string& type : out.complexity_types) {
+                for (TSSymbol symbol : compiler.symbolsNamed(type, "complexity")) out.symbols[symbol].flags |= kComplexity;
+            }
+
+            if (const Json::Value* logical = descriptor.find("logical_operators")) {
+                if (logical->type != Json::Type::Array) {
+                    error = "logical_operators: expected an array";
+                    return false;
+                }
+                for (size_t i = 0; i < logical->array.size(); ++i) {
+                    const Json::Value& entry = logical->array[i];
+                    std::string where = "logical_operators[" + std::to_string(i) + "]";
+                    std::string type = entry.stringOr("type", "");
+                    if (type.empty()) {
+                        error = where + ": missing \"type\"";
+                        return false;
+                    }
+                    LogicalRule rule;
+                    std::string field = entry.stringOr("field", "");
+                    if (!field.empty()) {
+                        rule.field = compiler.field(field, where);
+                        std::vector<std::string> operators;
+                        if (!stringList(entry.find("operators"), operators, where + ".operators", error)) return false;
+                        if (operators.empty()) {
+                            error = where + ": a \"field\" needs \"operators\"";
+                            return false;
+                        }
+                        for (const std::string& op : operators) {
+                            std::vector<TSSymbol> symbols = compiler.symbolsNamed(op, where);
+                            rule.operators.insert(rule.operators.end(), symbols.begin(), symbols.end());
+                        }
+                    }
+                    uint16_t index = static_cast<uint16_t>(out.logical_rules.size());
+                    for (TSSymbol symbol : compiler.symbolsNamed(type, where)) {
+                        out.symbols[symbol].flags |= kLogical;
+                        out.symbols[symbol].logical_rule = index;
+                    }
+                    out.logical_rules.push_back(std::move(rule));
+                }
+            }
+
+            if (out.function_rules.size() > UINT16_MAX || out.logical_rules.size() > UINT16_MAX) {
+                error = "too many rules";
+                return false;
+            }
+            error = compiler.error;
+            return error.empty();
+        }
+
+        bool loadDescriptor(const fs::path& file, std::string& error) {
+            std::ifstream input(file, std::ios::binary);
+            if (!input.is_open()) {
+                error = "cannot open " + file.string();
+                return false;
+            }
+            std::ostringstream text;
+            text << input.rdbuf();
+            Json::Value descriptor;
+            if (!Json::parse(text.str(), descriptor, error)) return false;
+            if (descriptor.type != Json::Type::Object) {
+                error = "expected a JSON object";
+                return false;
+            }
+            std::string name = descriptor.stringOr("name", "");
+            if (name.empty()) {
+                error = "missing \"name\"";
+                return false;
+            }
+            std::vector<std::string> extensions;
+            if (!stringList(descriptor.find("extensions"), extensions, "extensions", error)) return false;
+            for (const std::string& extension : extensions) {
+                if (extension.size() < 2 || extension[0] != '.') {
+                    error = "extensions: '" + extension + "' does not start with '.'";
+                    return false;
+                }
+            }
+
+            const TSLanguage* grammar = resolveGrammar(descriptor, name, file.parent_path(), error);
+            if (!error.empty()) return false;
+            const TSLanguage* target = grammar ? grammar : LanguageRegistry::grammar(LanguageRegistry::fromName(name));
+            auto compiled = std::make_shared<Compiled>();
+            if (!compile(descriptor, name, target, *compiled, error)) return false;
+            compiled->digest = Sha256::hex(text.str());
+
+            // Registered only once the whole descriptor compiled, so a broken file changes nothing.
+            Language language = LanguageRegistry::define(name, grammar);
+            if (language == Language::Unsupported) {
+                error = "too many languages (at most " + std::to_string(LanguageRegistry::kMaxLanguages) + ")";
+                return false;
+            }
+            for (const std::string& extension : extensions) LanguageRegistry::addExtension(extension, language);
+            g_compiled[LanguageRegistry::index(language)] = std::move(compiled);
+            return true;
+        }
+
+        bool hasSymbol(const std::vector<TSSymbol>& symbols, TSNode node) {
+            return std::find(symbols.begin(), symbols.end(), ts_node_symbol(node)) != symbols.end();
+        }
+
+        /// The first node, in pre-order, at or below `node` that has one of `symbols`.
+        /// Walked with a cursor: ts_node_child() is linear in the child's index, and recursing
+        /// would put the tree's depth on the stack.
+        TSNode findFirst(TSNode node, const std::vector<TSSymbol>& symbols) {
+            TSTreeCursor cursor = ts_tree_cursor_new(node);
+            TSNode found = TSNode();
+            for (;;) {
+                TSNode current = ts_tree_cursor_current_node(&cursor);
+                if (hasSymbol(symbols, current)) {
+                    found = current;
+                    break;
+                }
+                if (ts_tree_cursor_goto_first_child(&cursor)) continue;
+                // The cursor is rooted at `node`, so climbing stops there.
+                bool advanced = ts_tree_cursor_goto_next_sibling(&cursor);
+                while (!advanced && ts_tree_cursor_goto_parent(&cursor)) {
+                    advanced = ts_tree_cursor_goto_next_sibling(&cursor);
+                }
+                if (!advanced) break;
+            }
+            ts_tree_cursor_delete(&cursor);
+            return found;
+        }
+
+        /// Walks a path from `node`; a null node if a step finds nothing.
+        /// `context` holds the ancestors of `node`, which `parent:` steps use while they still apply.
+        TSNode follow(TSNode node, const Path& path, const NodeContext& context) {
+            size_t up = 0;
+            bool onChain = true;
+            for (const Step& step : path) {
+                if (ts_node_is_null(node)) break;
+                switch (step.kind) {
+                    case Step::Kind::Field:
+                        node = ts_node_child_by_field_id(node, step.field);
+                        onChain = false;
+                        break;
+                    case Step::Kind::Parent:
+                        node = onChain && up < context.depth() ? context.ancestor(up++) : ts_node_parent(node);
+                        if (!ts_node_is_null(node) && !hasSymbol(step.symbols, node)) node = TSNode();
+                        break;
+                    case Step::Kind::Find:
+                        node = findFirst(node, step.symbols);
+                        onChain = false;
+                        break;
+                }
+            }
+            return node;
+        }
+
+    } // namespace
+
+    bool load(const std::string& path, std::string& error) {
+        if (loadDescriptor(path, error)) return true;
+        error = path + ": " + error;
+        return false;
+    }
+
+    bool loadPath(const std::string& path, std::vector<std::string>& errors) {
+        std::error_code ec;
+        std::vector<fs::path> files;
+        if (fs::is_directory(path, ec)) {
+            for (const auto& entry : fs::directory_iterator(path, ec)) {
+                if (entry.path().extension() == ".json" && entry.is_regular_file(ec)) files.push_back(entry.path());
+            }
+            // Later files win on a shared extension, so make "later" mean something.
+            std::sort(files.begin(), files.end());
+        } else {
+            files.push_back(path);
+        }
+        if (ec) {
+            errors.push_back(path + ": " + ec.message());
+            return false;
+        }
+        size_t failures = errors.size();
+        for (const fs::path& file : files) {
+            std::string error;
+            if (!load(file.string(), error)) errors.push_back(error);
+        }
+        return errors.size() == failures;
+    }
+
+    std::string fingerprint(Language language) {
+        if (language == Language::Unsupported || !g_compiled[LanguageRegistry::index(language)]) return "";
+        return g_compiled[LanguageRegistry::index(language)]->digest;
+    }
+
+    std::unique_ptr<LanguageStrategy> createStrategy(Language language) {
+        if (language == Language::Unsupported || !g_compiled[LanguageRegistry::index(language)]) return nullptr;
+        return std::make_unique<DescriptorStrategy>(g_compiled[LanguageRegistry::index(language)]);
+    }
+
+} // namespace LanguageDescriptors
+
+using namespace LanguageDescriptors;
+
+DescriptorStrategy::DescriptorStrategy(std::shared_ptr<const Compiled> tables) : compiled(std::move(tables)) {}
+
+uint8_t DescriptorStrategy::flags(TSNode node) const {
+    TSSymbol symbol = ts_node_symbol(node);
+    // ERROR nodes have a reserved symbol past the end of the grammar's table.
+    return symbol < compiled->symbols.size() ? compiled->symbols[symbol].flags : 0;
+}
+
+const std::vector<std::string>& DescriptorStrategy::getFunctionDefinitionTypes() const {
+    return compiled->function_types;
+}
+
+const std::vector<std::string>& DescriptorStrategy::getComplexityNodeTypes() const {
+    return compiled->complexity_types;
+}
+
+bool DescriptorStrategy::isFunctionDefinition(TSNode node) const {
+    return flags(node) & kFunction;
+}
+
+bool DescriptorStrategy::isComplexityNode(TSNode node) const {
+    return flags(node) & kComplexity;
+}
+
+bool DescriptorStrategy::isLogicalOperator(TSNode node) const {
+    if (!(flags(node) & kLogical)) return false;
+    const LogicalRule& rule = compiled->logical_rules[compiled->symbols[ts_node_symbol(node)].logical_rule];
+    if (rule.field == 0) return true;
+    TSNode op = ts_node_child_by_field_id(node, rule.field);
+    return !ts_node_is_null(op) && hasSymbol(rule.operators, op);
+}
+
+bool DescriptorStrategy::isSpecialFunction(TSNode functionNode) const {
+    if (!(flags(functionNode) & kFunction)) return false;
+    const FunctionRule& rule = compiled->function_rules[compiled->symbols[ts_node_symbol(functionNode)].function_rule];
+    for (const SkipRule& skip : rule.skips) {
+        TSNode target = follow(functionNode, skip.path, NodeContext());
+        if (!ts_node_is_null(target) && !ts_node_is_null(findFirst(target, skip.contains))) return true;
+    }
+    return false;
+}
+
+std::string_view DescriptorStrategy::extractFunctionName(TSNode functionNode, std::string_view sourceCode,
+                                                        const NodeContext& context) const {
+    if (flags(functionNode) & kFunction) {
+        const FunctionRule& rule = compiled->function_rules[compiled->symbols[ts_node_symbol(functionNode)].function_rule];
+        for (const Path& path : rule.names) {
+            TSNode name = follow(functionNode, path, context);
+            if (ts_node_is_null(name)) continue;
+            uint32_t start = ts_node_start_byte(name);
+            return sourceCode.substr(start, ts_node_end_byte(name) - start);
+        }
+    }
+    return compiled->unnamed;
+}
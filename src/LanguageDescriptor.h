@@ -0,0 +1,116 @@
+/**
+ * @file LanguageDescriptor.h
+ * @brief Languages defined by descriptor files rather than C++ strategies.
+ *
+ * A descriptor is a JSON file that names a grammar and says what to count in
+ * its syntax trees:
+ *
+ *     {
+ *       "name": "kotlin",
+ *       "grammar": {"library": "libtree-sitter-kotlin.so", "symbol": "tree_sitter_kotlin"},
+ *       "extensions": [".kt", ".kts"],
+ *       "functions": [
+ *         {"type": "function_declaration", "name": [["field:name"], ["find:simple_identifier"]]}
+ *       ],
+ *       "complexity": ["if_expression", "for_statement", "while_statement", "catch_block"],
+ *       "logical_operators": [
+ *         {"type": "conjunction_expression"},
+ *         {"type": "binary_expression", "field": "operator", "operators": ["&&", "||"]}
+ *       ]
+ *     }
+ *
+ * `grammar` is either the name of a built-in language whose grammar is reused
+ * ("javascript") or a shared library exporting the grammar function. A relative
+ * library path is taken from the descriptor's directory. `symbol` defaults to
+ * `tree_sitter_<name>`. Naming a built-in language replaces its hand-written
+ * strategy, and then `grammar` may be left out.
+ *
+ * A function's name is the text of the node that the first matching `name`
+ * path leads to. A path is a list of steps, each taken from the node the
+ * previous step reached:
+ *  - `field:F` moves to the child in field F;
+ *  - `parent:T` moves to the parent, which must be of type T. Parents of the
+ *    function node come from the analyzer's ancestor stack; after a `field:` or
+ *    `find:` step they are asked of tree-sitter;
+ *  - `find:T` moves to the first node of type T in a pre-order walk, the node itself included.
+ * If no path matches, the function is named by `unnamed`, or the analyzer's
+ * placeholder when that is left out. `skip_if` lists paths and node types that
+ * mark a function to be left out: the C++ rule for operators and destructors is
+ * `{"path": ["field:declarator"], "contains": ["operator_name", "destructor_name"]}`.
+ *
+ * Loading compiles the descriptor against its grammar. Node types become
+ * symbol ids and fields become field ids, so a misspelled name is reported at
+ * startup. Analysis looks a node's symbol up in a flag table, which costs no
+ * more per node than a hand-written strategy. Like `ts_node_type()`
+ * comparisons, a type name matches every symbol of that name, named or not.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef LANGUAGE_DESCRIPTOR_H
+#define LANGUAGE_DESCRIPTOR_H
+
+#include "LanguageStrategy.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LanguageDescriptors {
+
+    struct Compiled;
+
+    /**
+     * @brief Loads one descriptor file, compiles it and registers its language and extensions.
+     * @param error Receives a message naming the file on failure.
+     * @return False if the file is unreadable, malformed, or does not match its grammar.
+     */
+    bool load(const std::string& path, std::string& error);
+
+    /**
+     * @brief Loads a descriptor file, or every `*.json` file in a directory, in name order.
+     * Every file is tried, so one broken descriptor does not hide the others' errors.
+     * @param errors Receives one message per file that failed.
+     * @return False if any file failed.
+     */
+    bool loadPath(const std::string& path, std::vector<std::string>& errors);
+
+    /**
+     * @return The SHA-256 of the descriptor that defines `language`, or an empty
+     * string for a hand-written strategy. Part of remote cache keys, so editing a
+     * descriptor does not serve results computed under the old one.
+     */
+    std::string fingerprint(Language language);
+
+    /// @return A strategy for a language loaded from a descriptor, or null for any other language.
+    std::unique_ptr<LanguageStrategy> createStrategy(Language language);
+
+} // namespace LanguageDescriptors
+
+/**
+ * @class DescriptorStrategy
+ * @brief A LanguageStrategy driven by a compiled descriptor.
+ *
+ * The compiled tables are shared and read-only, so every thread's strategy for
+ * the language uses the same ones.
+ */
+class DescriptorStrategy : public LanguageStrategy {
+public:
+    explicit DescriptorStrategy(std::shared_ptr<const LanguageDescriptors::Compiled> compiled);
+
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode,
+                                         const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
+    bool isLogicalOperator(TSNode node) const override;
+    bool isSpecialFunction(TSNode functionNode) const override;
+    bool isFunctionDefinition(TSNode node) const override;
+    bool isComplexityNode(TSNode node) const override;
+
+private:
+    std::shared_ptr<const LanguageDescriptors::Compiled> compiled;
+
+    uint8_t flags(TSNode node) const;
+};
+
+#endif // LANGUAGE_DESCRIPTOR_H
@@ -0,0 +1,324 @@
+// src/LanguageRegistry.cpp
+#include "LanguageRegistry.h"
+#include <cctype>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" {
+    TSLanguage* tree_sitter_c();
+    TSLanguage* tree_sitter_cpp();
+    TSLanguage* tree_sitter_python();
+    TSLanguage* tree_sitter_java();
+    TSLanguage* tree_sitter_rust();
+    TSLanguage* tree_sitter_go();
+    TSLanguage* tree_sitter_javascript();
+    TSLanguage* tree_sitter_typescript();
+}
+
+namespace LanguageRegistry {
+
+    namespace {
+
+        struct Entry {
+            const char* name;
+            TSLanguage* (*grammar)();
+        };
+
+        // Indexed by Language. Grammars are only initialized when first requested,
+        // so a single-file run pays for one grammar, not all of them.
+        constexpr Entry kLanguages[kBuiltinCount] = {
+            {"c", tree_sitter_c},
+            {"cpp", tree_sitter_cpp},
+            {"python", tree_sitter_python},
+            {"java", tree_sitter_java},
+            {"rust", tree_sitter_rust},
+            {"go", tree_sitter_go},
+            {"javascript", tree_sitter_javascript},
+            {"typescript", tree_sitter_typescript}
+        };
+
+        struct Extension {
+            std::string_view suffix;
+            Language language;
+        };
+
+        constexpr Extension kExtensions[] = {
+            {".c", Language::C},
+            {".h", Language::Cpp}, {".cpp", Language::Cpp}, {".hpp", Language::Cpp}, {".cc", Language::Cpp},
+            {".cxx", Language::Cpp}, {".hh", Language::Cpp}, {".hxx", Language::Cpp},
+            {".py", Language::Python}, {".pyi", Language::Python}, {".pyw", Language::Python},
+            {".java", Language::Java},
+            {".rs", Language::Rust},
+            {".go", Language::Go},
+            {".js", Language::JavaScript}, {".mjs", Language::JavaScript}, {".cjs", Language::JavaScript},
+            {".jsx", Language::JavaScript},
+            {".ts", Language::TypeScript}, {".mts", Language::TypeScript}, {".cts", Language::TypeScript},
+            {".d.ts", Language::TypeScript}
+        };
+
+        // --- Perfect hash over kExtensions ---
+        // The seed is searched for at compile time, so every extension has a slot of its
+        // own and a lookup is one hash, one probe and one string comparison.
+
+        constexpr size_t kSlotBits = 6;
+        constexpr size_t kSlots = size_t(1) << kSlotBits;
+        constexpr uint8_t kEmptySlot = 0xff;
+        static_assert(std::size(kExtensions) < kSlots / 2, "grow kSlotBits to keep the seed search short");
+
+        constexpr size_t slotOf(std::string_view suffix, uint32_t seed) {
+            uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+            for (char c : suffix) hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+            return (hash ^ (hash >> 16)) & (kSlots - 1);
+        }
+
+        struct HashTable {
+            uint32_t seed = 0;
+            uint8_t slots[kSlots] = {};
+        };
+
+        constexpr HashTable buildHashTable() {
+            for (uint32_t seed = 0;; ++seed) {
+                HashTable table;
+                table.seed = seed;
+                for (uint8_t& slot : table.slots) slot = kEmptySlot;
+                bool collision = false;
+                for (size_t i = 0; i < std::size(kExtensions) && !collision; ++i) {
+                    uint8_t& slot = table.slots[slotOf(kExtensions[i].suffix, seed)];
+                    collision = slot != kEmptySlot;
+                    slot = static_cast<uint8_t>(i);
+                }
+                if (!collision) return table;
+            }
+        }
+
+        constexpr HashTable kHashTable = buildHashTable();
+
+        // --- Languages and extensions added at run time ---
+
+        struct Defined {
+            std::string name;
+            const TSLanguage* grammar = nullptr;
+        };
+
+        /// Indexed by Language; entries of built-in languages only hold a grammar override.
+        std::vector<Defined>& defined() {
+            static std::vector<Defined> languages(kBuiltinCount);
+            return languages;
+        }
+
+        struct DefinedExtension {
+            std::string suffix;
+            Language language;
+        };
+
+        /// Usually empty, and then a lookup costs one branch; otherwise a short scan.
+        std::vector<DefinedExtension>& definedExtensions() {
+            static std::vector<DefinedExtension> extensions;
+            return extensions;
+        }
+
+        Language lookupExtension(std::string_view suffix) {
+            for (const DefinedExtension& extension : definedExtensions()) {
+                if (extension.suffix == suffix) return extension.language;
+            }
+            uint8_t slot = kHashTable.slots[slotOf(suffix, kHashTable.seed)];
+            if (slot == kEmptySlot || kExtensions[slot].suffix != suffix) return Language::Unsupported;
+            return kExtensions[slot].language;
+        }
+
+        std::string_view fileName(std::string_view path) {
+            size_t slash = path.find_last_of("/\\");
+            return slash == std::string_view::npos ? path : path.substr(slash + 1);
+        }
+
+        // --- Shebangs and modelines ---
+
+        struct Alias {
+            std::string_view name;
+            Language language;
+        };
+
+        // Interpreter names; a version suffix ("python3.12", "node18") is ignored.
+        constexpr Alias kInterpreters[] = {
+            {"python", Language::Python}, {"pypy", Language::Python},
+            {"node", Language::JavaScript}, {"nodejs", Language::JavaScript}, {"bun", Language::JavaScript},
+            {"deno", Language::TypeScript}, {"ts-node", Language::TypeScript}, {"tsx", Language::TypeScript},
+            {"rust-script", Language::Rust},
+            {"java", Language::Java},
+            {"gorun", Language::Go}
+        };
+
+        // Editor file type names that differ from the registry's own names.
+        constexpr Alias kModeNames[] = {
+            {"c++", Language::Cpp}, {"py", Language::Python}, {"js", Language::JavaScript},
+            {"ts", Language::TypeScript}, {"golang", Language::Go}
+        };
+
+        bool isBlank(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        std::string_view nextToken(std::string_view& text) {
+            size_t start = 0;
+            while (start < text.size() && isBlank(text[start])) ++start;
+            size_t end = start;
+            while (end < text.size() && !isBlank(text[end])) ++end;
+            std::string_view token = text.substr(start, end - start);
+            text.remove_prefix(end);
+            return token;
+        }
+
+        Language fromInterpreter(std::string_view interpreter) {
+            for (const Alias& alias : kInterpreters) {
+                if (interpreter.compare(0, alias.name.size(), alias.name) != 0) continue;
+                std::string_view version = interpreter.substr(alias.name.size());
+                bool versionOnly = true;
+                for (char c : version) versionOnly = versionOnly && (std::isdigit(static_cast<unsigned char>(c)) || c == '.');
+                if (versionOnly) return alias.language;
+            }
+            return Language::Unsupported;
+        }
+
+        Language fromShebang(std::string_view line) {
+            std::string_view interpreter = fileName(nextToken(line));
+            // "#!/usr/bin/env -S VAR=1 node --flag": skip env's options and assignments.
+            if (interpreter == "env") {
+                do {
+                    interpreter = nextToken(line);
+                } while (!interpreter.empty() &&
+                         (interpreter.front() == '-' || interpreter.find('=') != std::string_view::npos));
+                interpreter = fileName(interpreter);
+            }
+            return fromInterpreter(interpreter);
+        }
+
+        Language fromModeName(std::string_view mode) {
+            constexpr std::string_view suffix = "-mode";
+            if (mode.size() > suffix.size() && mode.substr(mode.size() - suffix.size()) == suffix) {
+                mode.remove_suffix(suffix.size());
+            }
+            for (const Alias& alias : kModeNames) {
+                if (mode == alias.name) return alias.language;
+            }
+            return fromName(mode);
+        }
+
+        /// `vim: set ft=python:`, `vi: filetype=rust`, `ex: syntax=go`.
+        Language fromVimModeline(std::string_view line) {
+            for (std::string_view marker : {"vim:", "vi:", "ex:"}) {
+                size_t at = line.find(marker);
+                if (at == std::string_view::npos || (at > 0 && !isBlank(line[at - 1]))) continue;
+                std::string_view settings = line.substr(at + marker.size());
+                for (std::string_view key : {"filetype=", "ft=", "syntax="}) {
+                    size_t found = settings.find(key);
+                    if (found == std::string_view::npos) continue;
+                    std::string_view value = settings.substr(found + key.size());
+                    return fromModeName(value.substr(0, value.find_first_of(" \t\r:")));
+                }
+            }
+            return Language::Unsupported;
+        }
+
+        /// `-*- mode: python; coding: utf-8 -*-` or just `-*- python -*-`.
+        Language fromEmacsModeline(std::string_view line) {
+            size_t open = line.find("-*-");
+            if (open == std::string_view::npos) return Language::Unsupported;
+            std::string_view body = line.substr(open + 3);
+            body = body.substr(0, body.find("-*-"));
+            // The "mode:" variable, not a suffix of another one such as "indent-tabs-mode:".
+            size_t mode = body.find("mode:");
+            while (mode != std::string_view::npos && mode > 0 && !isBlank(body[mode - 1]) && body[mode - 1] != ';') {
+                mode = body.find("mode:", mode + 1);
+            }
+            if (mode != std::string_view::npos) {
+                body.remove_prefix(mode + 5);
+                body = body.substr(0, body.find(';'));
+            } else if (body.find(':') != std::string_view::npos) {
+                return Language::Unsupported;
+            }
+            std::string_view name = nextToken(body);
+            return fromModeName(name);
+        }
+
+    } // namespace
+
+    const char* name(Language language) {
+        if (language == Language::Unsupported) return "unsupported";
+        if (isBuiltin(language)) return kLanguages[index(language)].name;
+        return index(language) < defined().size() ? defined()[index(language)].name.c_str() : "unsupported";
+    }
+
+    Language fromName(std::string_view languageName) {
+        for (size_t i = 0; i < kBuiltinCount; ++i) {
+            if (languageName == kLanguages[i].name) return static_cast<Language>(i);
+        }
+        for (size_t i = kBuiltinCount; i < defined().size(); ++i) {
+            if (languageName == defined()[i].name) return static_cast<Language>(i);
+        }
+        return Language::Unsupported;
+    }
+
+    Language fromExtension(std::string_view path) {
+        std::string_view file = fileName(path);
+        size_t last = file.rfind('.');
+        // No extension, or a dotfile such as ".clang-format".
+        if (last == std::string_view::npos || last == 0) return Language::Unsupported;
+        size_t previous = file.rfind('.', last - 1);
+        if (previous != std::string_view::npos && previous > 0) {
+            Language language = lookupExtension(file.substr(previous));
+            if (language != Language::Unsupported) return language;
+        }
+        return lookupExtension(file.substr(last));
+    }
+
+    bool needsSniffing(std::string_view path) {
+        return fileName(path).find('.', 1) == std::string_view::npos;
+    }
+
+    Language sniff(std::string_view head) {
+        head = head.substr(0, kSniffBytes);
+        if (head.compare(0, 2, "#!") == 0) {
+            Language language = fromShebang(head.substr(2, head.find('\n') - 2));
+            if (language != Language::Unsupported) return language;
+        }
+        // Modelines conventionally sit in the first lines; look at the first few.
+        for (int lineNumber = 0; lineNumber < 5 && !head.empty(); ++lineNumber) {
+            std::string_view line = head.substr(0, head.find('\n'));
+            Language language = fromVimModeline(line);
+            if (language == Language::Unsupported) language = fromEmacsModeline(line);
+            if (language != Language::Unsupported) return language;
+            head.remove_prefix(line.size() < head.size() ? line.size() + 1 : head.size());
+        }
+        return Language::Unsupported;
+    }
+
+    const TSLanguage* grammar(Language language) {
+        if (language == Language::Unsupported || index(language) >= defined().size()) return nullptr;
+        const TSLanguage* loaded = defined()[index(language)].grammar;
+        if (loaded || !isBuiltin(language)) return loaded;
+        return kLanguages[index(language)].grammar();
+    }
+
+    Language define(std::string_view languageName, const TSLanguage* languageGrammar) {
+        Language language = fromName(languageName);
+        if (language != Language::Unsupported) {
+            if (languageGrammar) defined()[index(language)].grammar = languageGrammar;
+            return language;
+        }
+        if (!languageGrammar || defined().size() >= kMaxLanguages) return Language::Unsupported;
+        defined().push_back({std::string(languageName), languageGrammar});
+        return static_cast<Language>(defined().size() - 1);
+    }
+
+    void addExtension(std::string_view suffix, Language language) {
+        for (DefinedExtension& extension : definedExtensions()) {
+            if (extension.suffix == suffix) {
+                extension.language = language;
+                return;
+            }
+        }
+        definedExtensions().push_back({std::string(suffix), language});
+    }
+
+} // namespace LanguageRegistry
@@ -0,0 +1,103 @@
+/**
+ * @file LanguageRegistry.h
+ * @brief The supported languages, and how a file is mapped to one of them.
+ *
+ * A language is identified by the compact `Language` id everywhere in the
+ * pipeline. Names are only used at the edges: command-line options, reports
+ * and metric labels. The registry knows each language's name, grammar and file
+ * extensions. It detects a file's language from its extension, trying
+ * multi-part extensions such as `.d.ts` first. Files without an extension are
+ * detected from a shebang line or an editor modeline.
+ *
+ * The built-in languages have fixed ids. Languages loaded from descriptor
+ * files (LanguageDescriptor.h) are added after them at startup, and may add
+ * extensions that take precedence over the built-in ones.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef LANGUAGE_REGISTRY_H
+#define LANGUAGE_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tree_sitter/api.h>
+
+/**
+ * @enum Language
+ * @brief Compact language id; the values index per-language tables.
+ */
+enum class Language : uint8_t {
+    C,
+    Cpp,
+    Python,
+    Java,
+    Rust,
+    Go,
+    JavaScript,
+    TypeScript,
+    // Ids from here up to kMaxLanguages are handed out to descriptor languages by define().
+    Unsupported = 0xff
+};
+
+namespace LanguageRegistry {
+
+    /// The languages compiled in, which have fixed ids.
+    constexpr size_t kBuiltinCount = static_cast<size_t>(Language::TypeScript) + 1;
+
+    /// Size of per-language tables: built-in plus descriptor languages.
+    constexpr size_t kMaxLanguages = 32;
+
+    /// How many leading bytes of a file `sniff()` looks at.
+    constexpr size_t kSniffBytes = 512;
+
+    inline size_t index(Language language) { return static_cast<size_t>(language); }
+
+    /// @return The language's name ("cpp", "python", ...), or "unsupported".
+    const char* name(Language language);
+
+    /// @return The language with the given name, or Language::Unsupported.
+    Language fromName(std::string_view name);
+
+    /**
+     * @brief Maps a path to a language by its file extension, with one hash probe per candidate.
+     * Only the file name is considered, and a two-part extension (".d.ts") wins over the last one (".ts").
+     */
+    Language fromExtension(std::string_view path);
+
+    /// @return True if the file name has no extension, so `sniff()` is worth a read.
+    bool needsSniffing(std::string_view path);
+
+    /**
+     * @brief Detects a language from the start of a file: a shebang line
+     * (`#!/usr/bin/env python3`) or a vim/emacs modeline (`vim: ft=rust`, `-*- mode: go -*-`).
+     * @param head Up to kSniffBytes bytes from the start of the file.
+     */
+    Language sniff(std::string_view head);
+
+    /// @return The tree-sitter grammar, initialized on first use; null for Language::Unsupported.
+    const TSLanguage* grammar(Language language);
+
+    /// @return True for the compiled-in languages, which have hand-written strategies.
+    inline bool isBuiltin(Language language) { return index(language) < kBuiltinCount; }
+
+    // --- Run-time registration ---
+    // Not synchronized: languages are defined at startup, before any file is analyzed.
+
+    /**
+     * @brief Adds a language, or returns the existing one with that name.
+     * @param grammar The language's grammar; for an existing language a non-null
+     * grammar replaces the current one, and null keeps it.
+     * @return The language's id, or Language::Unsupported if a new language needs
+     * a grammar or all kMaxLanguages ids are taken.
+     */
+    Language define(std::string_view name, const TSLanguage* grammar);
+
+    /// Maps a file extension (".kt", or a two-part one such as ".d.ts") to a language, ahead of the built-in table.
+    void addExtension(std::string_view suffix, Language language);
+
+} // namespace LanguageRegistry
+
+#endif // LANGUAGE_REGISTRY_H
@@ -2,10 +2,35 @@
 #ifndef LANGUAGE_STRATEGY_H
 #define LANGUAGE_STRATEGY_H
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <tree_sitter/api.h>
+#include "LanguageRegistry.h"
+
+// The ancestors of the node a strategy is asked about, outermost first, kept by
+// the analyzer's traversal. ts_node_parent() walks down from the root to find a
+// parent, which costs O(depth) per call; these lookups are O(1).
+// An empty context means the node is the root.
+class NodeContext {
+public:
+    NodeContext() = default;
+    NodeContext(const TSNode* ancestors, size_t depth) : ancestors(ancestors), count(depth) {}
+
+    // The node's parent, or a null node at the root.
+    TSNode parent() const { return ancestor(0); }
+
+    // The ancestor `level` steps up (0 is the parent), or a null node past the root.
+    TSNode ancestor(size_t level) const { return level < count ? ancestors[count - 1 - level] : TSNode(); }
+
+    size_t depth() const { return count; }
+
+private:
+    const TSNode* ancestors = nullptr;
+    size_t count = 0;
+};
 
 // Defines the interface for a language-specific analysis strategy.
 // This allows the main Analyzer to be language-agnostic.
@@ -14,17 +39,27 @@ public:
     virtual ~LanguageStrategy() = default;
 
     // Returns a list of tree-sitter node types that represent a function definition.
-    virtual std::vector<std::string> getFunctionDefinitionTypes() const = 0;
+    // The lists are built once and returned by reference; the analyzer asks for them per node.
+    virtual const std::vector<std::string>& getFunctionDefinitionTypes() const = 0;
 
     // Extracts the function name from a function definition node.
-    virtual std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const = 0;
+    // The result points into sourceCode (or at a static placeholder); nothing is copied.
+    // `context` holds the node's ancestors, for names that live outside the definition.
+    virtual std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode,
+                                                 const NodeContext& context) const = 0;
 
     // Returns a list of node types that increase cyclomatic complexity.
-    virtual std::vector<std::string> getComplexityNodeTypes() const = 0;
+    virtual const std::vector<std::string>& getComplexityNodeTypes() const = 0;
 
     // Checks if a node represents a logical operator (e.g., &&, ||, and, or).
     virtual bool isLogicalOperator(TSNode node) const;
 
+    // Checks a node against getFunctionDefinitionTypes() / getComplexityNodeTypes().
+    // The defaults compare type names; a strategy compiled against its grammar
+    // (DescriptorStrategy) answers from a table indexed by the node's symbol.
+    virtual bool isFunctionDefinition(TSNode node) const;
+    virtual bool isComplexityNode(TSNode node) const;
+
     virtual bool isSpecialFunction(TSNode functionNode) const;
 };
 
@@ -32,9 +67,9 @@ public:
 
 class CStrategy : public LanguageStrategy {
 public:
-    std::vector<std::string> getFunctionDefinitionTypes() const override;
-    std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const override;
-    std::vector<std::string> getComplexityNodeTypes() const override;
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode, const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
     // C++ specific logic for special functions.
     bool isSpecialFunction(TSNode functionNode) const override;
 };
@@ -44,46 +79,49 @@ class CppStrategy : public CStrategy {};
 
 class PythonStrategy : public LanguageStrategy {
 public:
-    std::vector<std::string> getFunctionDefinitionTypes() const override;
-    std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const override;
-    std::vector<std::string> getComplexityNodeTypes() const override;
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode, const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
     bool isLogicalOperator(TSNode node) const override;
 
 };
 
 class JavaStrategy : public LanguageStrategy {
 public:
-    std::vector<std::string> getFunctionDefinitionTypes() const override;
-    std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const override;
-    std::vector<std::string> getComplexityNodeTypes() const override;
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode, const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
 };
 
 class RustStrategy : public LanguageStrategy {
 public:
-    std::vector<std::string> getFunctionDefinitionTypes() const override;
-    std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const override;
-    std::vector<std::string> getComplexityNodeTypes() const override;
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode, const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
 };
 
 class GoStrategy : public LanguageStrategy {
 public:
-    std::vector<std::string> getFunctionDefinitionTypes() const override;
-    std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const override;
-    std::vector<std::string> getComplexityNodeTypes() const override;
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode, const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
 };
 
 class JSStrategy : public LanguageStrategy {
 public:
-    std::vector<std::string> getFunctionDefinitionTypes() const override;
-    std::string extractFunctionName(TSNode functionNode, const std::string& sourceCode) const override;
-    std::vector<std::string> getComplexityNodeTypes() const override;
+    const std::vector<std::string>& getFunctionDefinitionTypes() const override;
+    std::string_view extractFunctionName(TSNode functionNode, std::string_view sourceCode, const NodeContext& context) const override;
+    const std::vector<std::string>& getComplexityNodeTypes() const override;
 };
 
 // TypeScript strategy inherits its logic from the JavaScript strategy.
 class TSStrategy : public JSStrategy {};
 
 
-// Factory function to create the appropriate strategy based on the language name.
-std::unique_ptr<LanguageStrategy> createStrategy(const std::string& language);
+// Factory function to create the appropriate strategy for a language.
+// A language loaded from a descriptor file gets a DescriptorStrategy, which also
+// replaces the hand-written strategy when a descriptor redefines a built-in language.
+// Returns null for Language::Unsupported.
+std::unique_ptr<LanguageStrategy> createStrategy(Language language);
 
 #endif // LANGUAGE_STRATEGY_H
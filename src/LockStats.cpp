@@ -0,0 +1,74 @@
+// src/LockStats.cpp
+#include "LockStats.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+std::mutex g_registryMutex;
+std::vector<LockStats::Mutex*> g_live;
+std::map<std::string, LockStats::Totals> g_retired;
+
+} // namespace
+
+namespace LockStats {
+
+    namespace detail {
+        std::atomic<bool> timeHolds{false};
+
+        uint64_t nowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+    } // namespace detail
+
+    Totals& Totals::operator+=(const Totals& other) {
+        acquisitions += other.acquisitions;
+        contended += other.contended;
+        wait_ns += other.wait_ns;
+        hold_ns += other.hold_ns;
+        return *this;
+    }
+
+    Totals Totals::operator-(const Totals& other) const {
+        Totals result;
+        result.acquisitions = acquisitions - other.acquisitions;
+        result.contended = contended - other.contended;
+        result.wait_ns = wait_ns - other.wait_ns;
+        result.hold_ns = hold_ns - other.hold_ns;
+        return result;
+    }
+
+    void enable() { detail::timeHolds.store(true, std::memory_order_relaxed); }
+
+    Mutex::Mutex(const char* name) : name(name) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_live.push_back(this);
+    }
+
+    Mutex::~Mutex() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_live.erase(std::find(g_live.begin(), g_live.end(), this));
+        g_retired[name] += totals;
+    }
+
+    void Mutex::lockContended() {
+        uint64_t start = detail::nowNs();
+        raw.lock();
+        ++totals.contended;
+        totals.wait_ns += detail::nowNs() - start;
+    }
+
+    std::map<std::string, Totals> snapshot() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        std::map<std::string, Totals> result = g_retired;
+        for (Mutex* mutex : g_live) {
+            std::lock_guard<std::mutex> guard(mutex->raw);
+            result[mutex->name] += mutex->totals;
+        }
+        return result;
+    }
+
+} // namespace LockStats
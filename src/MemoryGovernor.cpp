@@ -0,0 +1,221 @@
+// src/MemoryGovernor.cpp
+#include "MemoryGovernor.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Tree-sitter trees are typically an order of magnitude larger than their source;
+// start conservatively and let observed parses pull the estimate down.
+constexpr double kInitialExpansionRatio = 20.0;
+
+// Without a ceiling, files estimated above this size are still admitted one at a time.
+constexpr size_t kLargeFileFallbackBytes = 64u * 1024u * 1024u;
+
+// Tiny files are dominated by fixed parser overhead and would skew the ratio.
+constexpr size_t kMinLearningBytes = 4096;
+
+constexpr auto kSampleInterval = std::chrono::milliseconds(250);
+constexpr auto kWaitSlice = std::chrono::milliseconds(100);
+
+/**
+ * @brief Reads the cumulative "some" stall time (in microseconds) from a PSI file.
+ * The format is: `some avg10=0.00 avg60=0.00 avg300=0.00 total=12345`.
+ */
+bool readStallTotal(const char* path, uint64_t& totalUs) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 4, "some") != 0) continue;
+        auto pos = line.find("total=");
+        if (pos == std::string::npos) return false;
+        std::istringstream value(line.substr(pos + 6));
+        return static_cast<bool>(value >> totalUs);
+    }
+    return false;
+}
+
+} // namespace
+
+MemoryGovernor::MemoryGovernor(const GovernorConfig& config)
+    : config(config),
+      concurrencyLimit(std::max(1u, config.max_workers)),
+      expansionRatio(kInitialExpansionRatio) {
+    counters.min_concurrency = concurrencyLimit;
+}
+
+size_t MemoryGovernor::estimate(size_t sourceBytes) const {
+    return sourceBytes + static_cast<size_t>(sourceBytes * expansionRatio);
+}
+
+bool MemoryGovernor::isLarge(size_t reservation) const {
+    if (config.memory_ceiling == 0) return reservation > kLargeFileFallbackBytes;
+    return reservation > config.memory_ceiling * config.large_file_fraction;
+}
+
+bool MemoryGovernor::fits(size_t reservation) const {
+    if (config.memory_ceiling == 0) return true;
+    // Use whichever is larger: what we promised running files, or what they actually hold.
+    size_t committed = std::max(reservedBytes, MemoryTracker::liveBytes() + inflightSourceBytes);
+    return committed + reservation <= config.memory_ceiling;
+}
+
+void MemoryGovernor::samplePressure() {
+    Clock::time_point now = Clock::now();
+    if (now - lastSample < kSampleInterval) return;
+
+    uint64_t memoryStallUs = 0, cpuStallUs = 0;
+    bool haveMemory = readStallTotal("/proc/pressure/memory", memoryStallUs);
+    bool haveCpu = readStallTotal("/proc/pressure/cpu", cpuStallUs);
+    bool primed = lastSample != Clock::time_point();
+    double elapsedUs = std::chrono::duration<double, std::micro>(now - lastSample).count();
+    lastSample = now;
+
+    double cpuPressure = 0.0;
+    memoryPressure = 0.0;
+    if (primed && haveMemory && memoryStallUs >= lastMemoryStallUs) {
+        memoryPressure = (memoryStallUs - lastMemoryStallUs) / elapsedUs * 100.0;
+    }
+    if (primed && haveCpu && cpuStallUs >= lastCpuStallUs) {
+        cpuPressure = (cpuStallUs - lastCpuStallUs) / elapsedUs * 100.0;
+    }
+    lastMemoryStallUs = memoryStallUs;
+    lastCpuStallUs = cpuStallUs;
+    pressureAvailable = haveMemory || haveCpu;
+    if (!primed) return;
+
+    bool overCeiling = config.memory_ceiling != 0 &&
+                       MemoryTracker::liveBytes() + inflightSourceBytes > config.memory_ceiling;
+
+    // AIMD: back off hard on memory stalls, gently on CPU stalls, recover one step at a time.
+    if (overCeiling || memoryPressure > config.memory_pressure_limit) {
+        concurrencyLimit = std::max(1u, concurrencyLimit / 2);
+    } else if (cpuPressure > config.cpu_pressure_limit) {
+        concurrencyLimit = std::max(1u, concurrencyLimit - 1);
+    } else if (concurrencyLimit < std::max(1u, config.max_workers)) {
+        ++concurrencyLimit;
+    }
+    counters.min_concurrency = std::min(counters.min_concurrency, concurrencyLimit);
+}
+
+bool MemoryGovernor::tryTake(GovernorJob& job) {
+    if (active >= concurrencyLimit) return false;
+
+    bool smallReady = false;
+    if (!pending.empty()) {
+        pending.front().reservation = estimate(pending.front().source_bytes);
+        // An idle governor always admits something, so a single oversized file cannot stall the run.
+        smallReady = active == 0 || fits(pending.front().reservation);
+    }
+    bool largeReady = false;
+    if (!pendingLarge.empty() && activeLarge == 0) {
+        pendingLarge.front().reservation = estimate(pendingLarge.front().source_bytes);
+        bool calm = memoryPressure <= config.memory_pressure_limit;
+        largeReady = active == 0 || (calm && fits(pendingLarge.front().reservation));
+    }
+
+    std::deque<GovernorJob>* source = nullptr;
+    if (smallReady && largeReady) {
+        // Small files first keeps the workers busy; a ranked run instead follows its ranking,
+        // so a large file near the top is not left to expire behind every small one.
+        bool largeFirst = config.ordered && pendingLarge.front().sequence < pending.front().sequence;
+        source = largeFirst ? &pendingLarge : &pending;
+    } else if (smallReady) {
+        source = &pending;
+    } else if (largeReady) {
+        source = &pendingLarge;
+    }
+    if (!source) return false;
+
+    job = std::move(source->front());
+    source->pop_front();
+    ++active;
+    if (job.large) ++activeLarge;
+    reservedBytes += job.reservation;
+    inflightSourceBytes += job.source_bytes;
+    ++counters.files_admitted;
+    counters.bytes_admitted += job.source_bytes;
+    return true;
+}
+
+void MemoryGovernor::submit(PathId path, Language language, size_t sourceBytes) {
+    std::lock_guard<LockStats::Mutex> lock(mutex);
+    GovernorJob job;
+    job.path = path;
+    job.language = language;
+    job.source_bytes = sourceBytes;
+    job.sequence = submitted++;
+    job.reservation = estimate(sourceBytes);
+    job.large = isLarge(job.reservation);
+    if (job.large) {
+        ++counters.large_files;
+        pendingLarge.push_back(std::move(job));
+    } else {
+        pending.push_back(std::move(job));
+    }
+    wakeup.notify_one();
+}
+
+void MemoryGovernor::close() {
+    std::lock_guard<LockStats::Mutex> lock(mutex);
+    closed = true;
+    wakeup.notify_all();
+}
+
+bool MemoryGovernor::acquire(GovernorJob& job) {
+    std::unique_lock<LockStats::Mutex> lock(mutex);
+    bool throttled = false;
+    for (;;) {
+        if (Clock::now() >= config.deadline) {
+            for (const std::deque<GovernorJob>* queue : {&pending, &pendingLarge}) {
+                for (const GovernorJob& dropped : *queue) {
+                    ++counters.files_expired;
+                    counters.bytes_expired += dropped.source_bytes;
+                }
+            }
+            pending.clear();
+            pendingLarge.clear();
+            if (closed) return false;
+        }
+        samplePressure();
+        if (tryTake(job)) return true;
+        bool hasWork = !pending.empty() || !pendingLarge.empty();
+        if (closed && !hasWork) return false;
+        if (hasWork && !throttled) {
+            ++counters.throttled_waits;
+            throttled = true;
+        }
+        wakeup.wait_for(lock, kWaitSlice);
+    }
+}
+
+void MemoryGovernor::release(const GovernorJob& job, size_t treeBytes) {
+    std::lock_guard<LockStats::Mutex> lock(mutex);
+    --active;
+    if (job.large) --activeLarge;
+    reservedBytes -= job.reservation;
+    inflightSourceBytes -= job.source_bytes;
+
+    if (job.source_bytes >= kMinLearningBytes) {
+        // Jump up immediately on a bigger-than-expected tree, decay slowly otherwise.
+        double observed = static_cast<double>(treeBytes) / job.source_bytes;
+        if (observed > expansionRatio) {
+            expansionRatio = observed;
+        } else {
+            expansionRatio = std::max(1.0, expansionRatio * 0.9 + observed * 0.1);
+        }
+    }
+    wakeup.notify_all();
+}
+
+GovernorStats MemoryGovernor::stats() const {
+    std::lock_guard<LockStats::Mutex> lock(mutex);
+    GovernorStats result = counters;
+    result.peak_tree_bytes = MemoryTracker::peakBytes();
+    result.expansion_ratio = expansionRatio;
+    result.pressure_available = pressureAvailable;
+    return result;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file MemoryGovernor.h
+ * @brief Adaptive admission control for parallel file analysis.
+ *
+ * Some inputs produce parse trees many times larger than their source, so running
+ * a fixed number of workers can exhaust memory on shared hosts. The governor owns
+ * the queue of pending files and decides when a worker may start on the next one,
+ * based on:
+ *   - an estimate of each file's footprint (source size times an observed
+ *     tree-to-source expansion ratio) against a configured memory ceiling,
+ *   - the live bytes actually held by tree-sitter (see MemoryTracker),
+ *   - Linux pressure stall information (/proc/pressure/memory and cpu), which
+ *     drives an additive-increase / multiplicative-decrease concurrency limit.
+ *
+ * Files whose estimated footprint is a large fraction of the ceiling are queued
+ * separately and admitted one at a time, and are held back entirely while the
+ * host reports memory pressure.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef MEMORY_GOVERNOR_H
+#define MEMORY_GOVERNOR_H
+
+#include "LanguageRegistry.h"
+#include "LockStats.h"
+#include "PathTable.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+/**
+ * @struct GovernorConfig
+ * @brief Tunables for the MemoryGovernor.
+ */
+struct GovernorConfig {
+    unsigned max_workers = 1;          ///< Upper bound on concurrently analyzed files.
+    size_t memory_ceiling = 0;         ///< Byte budget for trees and sources; 0 disables the ceiling.
+    double large_file_fraction = 0.25; ///< A file is "large" if its estimate exceeds this share of the ceiling.
+    double memory_pressure_limit = 10.0; ///< Memory stall percentage that halves concurrency.
+    double cpu_pressure_limit = 50.0;    ///< CPU stall percentage that reduces concurrency by one.
+    /// Files still queued at this time are dropped instead of admitted (anytime mode);
+    /// files already admitted finish. The default never expires.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    /// Files are submitted in priority order (a budgeted run's likely-worst-first ranking, see
+    /// BudgetPlanner.h). Large files then keep their place in it, instead of waiting for the small ones.
+    bool ordered = false;
+};
+
+/**
+ * @struct GovernorJob
+ * @brief A file waiting for (or holding) admission.
+ */
+struct GovernorJob {
+    PathId path = PathTable::kNoPath;
+    Language language = Language::Unsupported; ///< Detected by the walker, so workers need not detect it again.
+    size_t source_bytes = 0;
+    size_t reservation = 0; ///< Estimated footprint charged against the ceiling while running.
+    size_t sequence = 0;    ///< Submission order.
+    bool large = false;
+};
+
+/**
+ * @struct GovernorStats
+ * @brief End-of-run summary of the governor's decisions.
+ */
+struct GovernorStats {
+    size_t files_admitted = 0;
+    size_t bytes_admitted = 0;      ///< Source bytes of the admitted files.
+    size_t files_expired = 0;       ///< Files dropped at the deadline without being analyzed.
+    size_t bytes_expired = 0;
+    size_t large_files = 0;
+    size_t throttled_waits = 0;     ///< Times a worker had to wait although work was pending.
+    unsigned min_concurrency = 0;   ///< Lowest concurrency limit reached.
+    size_t peak_tree_bytes = 0;     ///< Peak live bytes held by tree-sitter.
+    double expansion_ratio = 0.0;   ///< Final tree-to-source ratio estimate.
+    bool pressure_available = false; ///< Whether PSI files could be read.
+};
+
+class MemoryGovernor {
+public:
+    explicit MemoryGovernor(const GovernorConfig& config);
+
+    /// Queues a file for analysis. Called by the directory walker.
+    void submit(PathId path, Language language, size_t sourceBytes);
+
+    /// Signals that no more files will be submitted.
+    void close();
+
+    /**
+     * @brief Blocks until a queued file may be analyzed and hands it to the caller.
+     * @return False once the queue is closed and drained.
+     */
+    bool acquire(GovernorJob& job);
+
+    /**
+     * @brief Returns a job's reservation and feeds back the tree size it actually needed.
+     * @param treeBytes Peak bytes tree-sitter allocated while parsing the file.
+     */
+    void release(const GovernorJob& job, size_t treeBytes);
+
+    GovernorStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    GovernorConfig config;
+    mutable LockStats::Mutex mutex{"governor"};
+    std::condition_variable_any wakeup;
+
+    std::deque<GovernorJob> pending;
+    std::deque<GovernorJob> pendingLarge;
+    bool closed = false;
+    size_t submitted = 0;
+
+    unsigned active = 0;
+    unsigned activeLarge = 0;
+    unsigned concurrencyLimit;
+    size_t reservedBytes = 0;
+    size_t inflightSourceBytes = 0;
+    double expansionRatio;
+
+    // --- Pressure stall sampling ---
+    Clock::time_point lastSample;
+    uint64_t lastMemoryStallUs = 0;
+    uint64_t lastCpuStallUs = 0;
+    bool pressureAvailable = false;
+    double memoryPressure = 0.0;
+    GovernorStats counters;
+
+    size_t estimate(size_t sourceBytes) const;
+    bool isLarge(size_t reservation) const;
+    bool fits(size_t reservation) const;
+    void samplePressure();
+    bool tryTake(GovernorJob& job);
+};
+
+#endif // MEMORY_GOVERNOR_H
@@ -0,0 +1,170 @@
+// src/MemoryTracker.cpp
+#include "MemoryTracker.h"
+#include <tree_sitter/api.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+using MemoryTracker::HeapCounters;
+
+// Every tree-sitter block carries a small header recording its size, so free() and
+// realloc() can update the counters. The header keeps the user pointer maximally aligned.
+constexpr size_t kHeaderSize = alignof(std::max_align_t) > sizeof(size_t)
+                                   ? alignof(std::max_align_t)
+                                   : sizeof(size_t);
+
+std::atomic<size_t> g_live{0};
+std::atomic<size_t> g_peak{0};
+std::atomic<bool> g_installed{false};
+
+// Plain-old-data so it is constant-initialized and safe to touch from operator new
+// at any point of a thread's lifetime.
+thread_local HeapCounters t_heaps[MemoryTracker::kHeapCount];
+
+inline void countAllocation(MemoryTracker::Heap heap, size_t size) {
+    HeapCounters& counters = t_heaps[heap];
+    counters.allocations++;
+    counters.bytes += size;
+    counters.live += static_cast<int64_t>(size);
+    if (counters.live > counters.peak) counters.peak = counters.live;
+}
+
+inline void countRelease(MemoryTracker::Heap heap, size_t size) {
+    t_heaps[heap].live -= static_cast<int64_t>(size);
+}
+
+void onAllocate(size_t size) {
+    size_t live = g_live.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    countAllocation(MemoryTracker::TreeSitter, size);
+}
+
+void onRelease(size_t size) {
+    g_live.fetch_sub(size, std::memory_order_relaxed);
+    countRelease(MemoryTracker::TreeSitter, size);
+}
+
+void* wrap(void* block, size_t size) {
+    if (!block) return nullptr;
+    std::memcpy(block, &size, sizeof(size));
+    onAllocate(size);
+    return static_cast<char*>(block) + kHeaderSize;
+}
+
+void* countingMalloc(size_t size) {
+    return wrap(std::malloc(size + kHeaderSize), size);
+}
+
+void* countingCalloc(size_t count, size_t size) {
+    size_t total = count * size;
+    if (size != 0 && total / size != count) return nullptr;
+    return wrap(std::calloc(1, total + kHeaderSize), total);
+}
+
+void countingFree(void* ptr) {
+    if (!ptr) return;
+    char* block = static_cast<char*>(ptr) - kHeaderSize;
+    size_t size;
+    std::memcpy(&size, block, sizeof(size));
+    onRelease(size);
+    std::free(block);
+}
+
+void* countingRealloc(void* ptr, size_t size) {
+    if (!ptr) return countingMalloc(size);
+    char* block = static_cast<char*>(ptr) - kHeaderSize;
+    size_t old_size;
+    std::memcpy(&old_size, block, sizeof(old_size));
+    void* grown = std::realloc(block, size + kHeaderSize);
+    if (!grown) return nullptr;
+    onRelease(old_size);
+    return wrap(grown, size);
+}
+
+} // namespace
+
+namespace MemoryTracker {
+
+void install() {
+    if (g_installed.exchange(true)) return;
+    ts_set_allocator(countingMalloc, countingCalloc, countingRealloc, countingFree);
+}
+
+namespace detail {
+
+std::atomic<bool> cxxHooked{false};
+std::atomic<bool> cxxTracking{false};
+
+void countCxxAllocation(size_t size) {
+    countAllocation(Cxx, size);
+}
+
+void countCxxRelease(size_t size) {
+    countRelease(Cxx, size);
+}
+
+} // namespace detail
+
+bool enableCxxTracking() {
+    if (!detail::cxxHooked.load(std::memory_order_relaxed)) return false;
+    detail::cxxTracking.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool cxxTrackingEnabled() {
+    return detail::cxxTracking.load(std::memory_order_relaxed);
+}
+
+size_t liveBytes() {
+    return g_live.load(std::memory_order_relaxed);
+}
+
+size_t peakBytes() {
+    return g_peak.load(std::memory_order_relaxed);
+}
+
+size_t peakResidentBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss); // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#endif
+#else
+    return 0;
+#endif
+}
+
+Window beginWindow() {
+    Window window;
+    for (int heap = 0; heap < kHeapCount; ++heap) {
+        window.start[heap] = t_heaps[heap];
+        // The outer window's peak is saved in the snapshot and merged back in endWindow().
+        t_heaps[heap].peak = t_heaps[heap].live;
+    }
+    return window;
+}
+
+void endWindow(const Window& window, Usage (&usage)[kHeapCount]) {
+    for (int heap = 0; heap < kHeapCount; ++heap) {
+        HeapCounters& now = t_heaps[heap];
+        const HeapCounters& start = window.start[heap];
+        usage[heap].allocations = now.allocations - start.allocations;
+        usage[heap].bytes = now.bytes - start.bytes;
+        usage[heap].peak = now.peak > start.live ? static_cast<uint64_t>(now.peak - start.live) : 0;
+        now.peak = std::max(now.peak, start.peak);
+    }
+}
+
+} // namespace MemoryTracker
@@ -0,0 +1,103 @@
+/**
+ * @file MemoryTracker.h
+ * @brief Tracks heap allocations made by tree-sitter and by the analyzer's C++ code.
+ *
+ * Tree-sitter allows its allocator to be replaced through `ts_set_allocator`. The
+ * tracker installs thin wrappers around malloc/calloc/realloc/free that keep a
+ * global count of live bytes. C++ allocations (source buffers, names, metric
+ * vectors) can be counted too, in programs that link OperatorNewHook.cpp: it
+ * replaces the global `operator new`/`operator delete` on glibc. Only the `cqa`
+ * and `cqa-bench` executables do, so libcqa leaves its host's allocator alone.
+ *
+ * Besides the global totals, every thread keeps private counters per heap. A
+ * caller opens a Window, does some work, and closes it to learn how many
+ * allocations and bytes that work caused and how high the thread's live bytes
+ * rose. Windows nest, so the governor can measure a whole file while the
+ * profiler measures the individual phases inside it.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace MemoryTracker {
+
+    enum Heap : uint8_t {
+        TreeSitter, ///< Parsers and syntax trees.
+        Cxx,        ///< Global operator new/delete.
+        kHeapCount
+    };
+
+    /**
+     * @struct HeapCounters
+     * @brief Running per-thread counters for one heap.
+     */
+    struct HeapCounters {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;  ///< Bytes allocated (not net of frees).
+        int64_t live = 0;    ///< Net bytes allocated by this thread (may go negative).
+        int64_t peak = 0;    ///< High-water mark of `live` within the innermost open window.
+    };
+
+    /**
+     * @struct Window
+     * @brief Snapshot taken when a measurement window is opened on a thread.
+     */
+    struct Window {
+        HeapCounters start[kHeapCount];
+    };
+
+    /**
+     * @struct Usage
+     * @brief What happened on one heap between opening and closing a window.
+     */
+    struct Usage {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t peak = 0; ///< How far live bytes rose above their level at the window start.
+    };
+
+    namespace detail {
+        extern std::atomic<bool> cxxHooked;   ///< Set when OperatorNewHook.cpp is linked in.
+        extern std::atomic<bool> cxxTracking;
+        void countCxxAllocation(size_t size);
+        void countCxxRelease(size_t size);
+    } // namespace detail
+
+    /**
+     * @brief Routes all tree-sitter allocations through the counting wrappers.
+     * Must be called before the first parser is created. Calling it again is a no-op.
+     */
+    void install();
+
+    /**
+     * @brief Starts counting C++ allocations. Must be called before worker threads start.
+     * @return False if this program does not replace operator new (see OperatorNewHook.cpp).
+     */
+    bool enableCxxTracking();
+    bool cxxTrackingEnabled();
+
+    /// @return Bytes currently held by tree-sitter across all threads.
+    size_t liveBytes();
+
+    /// @return The highest value `liveBytes()` has reached during the run.
+    size_t peakBytes();
+
+    /// @return The process's peak resident set size in bytes, or 0 if unknown.
+    size_t peakResidentBytes();
+
+    /// Opens a measurement window on the calling thread.
+    Window beginWindow();
+
+    /// Closes a window opened on the same thread and reports the usage per heap.
+    void endWindow(const Window& window, Usage (&usage)[kHeapCount]);
+
+} // namespace MemoryTracker
+
+#endif // MEMORY_TRACKER_H
@@ -4,6 +4,9 @@
  *
  * This file contains the structs `FunctionMetric` for individual function data and
  * `FileMetrics` for aggregated, file-level data, including the final calculated score.
+ * A file's functions are stored column by column in a `FunctionTable`, with all
+ * names in one string arena, and are read back through `FunctionView`s. The
+ * file itself is referred to by its id in the `PathTable`.
  *
  * @author HotspringDev
  * @date 2025-09-14
@@ -12,7 +15,16 @@
 #ifndef METRICS_H
 #define METRICS_H
 
+#include "PathTable.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 /**
@@ -27,13 +39,242 @@ struct FunctionMetric {
     int complexity = 1;        ///< Metric: Cyclomatic Complexity of the function.
 };
 
+/**
+ * @struct FunctionView
+ * @brief One row of a FunctionTable, with the same fields as FunctionMetric.
+ * `name` points into the table's arena and is valid until the table is next modified.
+ */
+struct FunctionView {
+    std::string_view name;
+    int line_start = 0;
+    int line_end = 0;
+    int line_count = 0;
+    int complexity = 1;
+};
+
+/**
+ * @class FunctionTable
+ * @brief A file's functions as a struct of arrays.
+ *
+ * Names are appended to one string arena and located by their end offsets. The
+ * numeric fields are narrow columns, and `line_end` is derived from the start and
+ * the count. The columns can be scanned directly, and iteration yields
+ * FunctionViews, so code written against `std::vector<FunctionMetric>` keeps working.
+ * Complexities saturate at 65535.
+ *
+ * A table is a range of rows in column storage that copies of it share, so
+ * copying a table allocates nothing. Appending to a table whose rows end the
+ * storage extends the storage in place; any other table is first given storage of
+ * its own. Clearing a table that shares its storage leaves the rows to the other
+ * tables and starts again at the end. A worker that analyzes each file into one
+ * scratch table and keeps a copy per file therefore builds a single run-level
+ * table of all its files' functions, which grows geometrically. Names and columns
+ * read from any table sharing the storage are valid until one of them is modified,
+ * so tables that share storage must be used from one thread at a time.
+ */
+class FunctionTable {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = FunctionView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = FunctionView;
+
+        const_iterator(const FunctionTable* table, size_t index) : table(table), index(index) {}
+        FunctionView operator*() const { return (*table)[index]; }
+        FunctionView operator[](difference_type offset) const { return (*table)[index + offset]; }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator previous = *this; ++index; return previous; }
+        const_iterator& operator--() { --index; return *this; }
+        const_iterator& operator+=(difference_type offset) { index += offset; return *this; }
+        const_iterator operator+(difference_type offset) const { return {table, index + offset}; }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+
+    private:
+        const FunctionTable* table;
+        size_t index;
+    };
+
+    /// A contiguous run of one column's values, for the table's rows only.
+    template <typename T>
+    class Column {
+    public:
+        Column(const T* first, const T* last) : first(first), last(last) {}
+        const T* begin() const { return first; }
+        const T* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+
+    private:
+        const T* first;
+        const T* last;
+    };
+
+    FunctionTable() = default;
+    FunctionTable(const FunctionTable&) = default;
+    FunctionTable& operator=(const FunctionTable&) = default;
+    FunctionTable(FunctionTable&& other) noexcept
+        : storage(std::move(other.storage)), first(std::exchange(other.first, 0)),
+          count(std::exchange(other.count, 0)) {}
+    FunctionTable& operator=(FunctionTable&& other) noexcept {
+        storage = std::move(other.storage);
+        first = std::exchange(other.first, 0);
+        count = std::exchange(other.count, 0);
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size()}; }
+
+    FunctionView operator[](size_t i) const {
+        size_t row = first + i;
+        FunctionView view;
+        view.name = name(i);
+        view.line_start = static_cast<int>(storage->line_starts[row]);
+        view.line_count = static_cast<int>(storage->line_counts[row]);
+        view.line_end = view.line_start + view.line_count - 1;
+        view.complexity = storage->complexities[row];
+        return view;
+    }
+
+    std::string_view name(size_t i) const {
+        size_t row = first + i;
+        uint32_t begin = row ? storage->name_ends[row - 1] : 0;
+        return std::string_view(storage->names.data() + begin, storage->name_ends[row] - begin);
+    }
+
+    /// Appends a row; the name is copied into the arena.
+    void append(std::string_view name, int lineStart, int lineEnd, int complexity) {
+        Storage& columns = writable();
+        columns.names.append(name.data(), name.size());
+        columns.name_ends.push_back(static_cast<uint32_t>(columns.names.size()));
+        columns.line_starts.push_back(static_cast<uint32_t>(lineStart));
+        columns.line_counts.push_back(static_cast<uint32_t>(lineEnd - lineStart + 1));
+        columns.complexities.push_back(static_cast<uint16_t>(
+            std::min<int>(std::max(complexity, 0), std::numeric_limits<uint16_t>::max())));
+        ++count;
+    }
+
+    void push_back(const FunctionMetric& function) {
+        append(function.name, function.line_start, function.line_end, function.complexity);
+    }
+
+    /// Makes room for this many more functions and name bytes.
+    void reserve(size_t functions, size_t nameBytes) {
+        Storage& columns = writable();
+        columns.names.reserve(columns.names.size() + nameBytes);
+        columns.name_ends.reserve(columns.rows() + functions);
+        columns.line_starts.reserve(columns.rows() + functions);
+        columns.line_counts.reserve(columns.rows() + functions);
+        columns.complexities.reserve(columns.rows() + functions);
+    }
+
+    void clear() {
+        count = 0;
+        if (!storage) return;
+        if (storage.use_count() == 1) {
+            storage->clear();
+            first = 0;
+        } else {
+            first = storage->rows();
+        }
+    }
+
+    // --- Columns, for passes over every function ---
+    /// @return Total bytes of the names, without separators.
+    size_t nameBytes() const {
+        if (count == 0) return 0;
+        uint32_t begin = first ? storage->name_ends[first - 1] : 0;
+        return storage->name_ends[first + count - 1] - begin;
+    }
+    Column<uint32_t> lineCounts() const { return column(storage ? storage->line_counts.data() : nullptr); }
+    Column<uint16_t> complexityColumn() const { return column(storage ? storage->complexities.data() : nullptr); }
+
+    /// @return Bytes reserved by the storage, which only changes when the storage grows.
+    size_t storageCapacity() const {
+        if (!storage) return 0;
+        return storage->names.capacity() + storage->name_ends.capacity() * sizeof(uint32_t) +
+               storage->line_starts.capacity() * sizeof(uint32_t) +
+               storage->line_counts.capacity() * sizeof(uint32_t) +
+               storage->complexities.capacity() * sizeof(uint16_t);
+    }
+
+private:
+    struct Storage {
+        std::string names;                  ///< All names, back to back.
+        std::vector<uint32_t> name_ends;    ///< End offset of each name in `names`.
+        std::vector<uint32_t> line_starts;
+        std::vector<uint32_t> line_counts;
+        std::vector<uint16_t> complexities;
+
+        size_t rows() const { return line_starts.size(); }
+
+        void clear() {
+            names.clear();
+            name_ends.clear();
+            line_starts.clear();
+            line_counts.clear();
+            complexities.clear();
+        }
+    };
+
+    std::shared_ptr<Storage> storage; ///< Null until the first row is appended.
+    size_t first = 0;                 ///< This table's first row in the storage.
+    size_t count = 0;
+
+    template <typename T>
+    Column<T> column(const T* data) const {
+        return Column<T>(data + first, data + first + count);
+    }
+
+    /// @return Storage whose last rows are this table's, so rows can be appended.
+    Storage& writable() {
+        if (!storage) {
+            storage = std::make_shared<Storage>();
+        } else if (first + count != storage->rows()) {
+            if (storage.use_count() == 1) {
+                truncate(*storage, first + count);
+            } else {
+                auto own = std::make_shared<Storage>();
+                for (size_t i = 0; i < count; ++i) {
+                    FunctionView row = (*this)[i];
+                    own->names.append(row.name.data(), row.name.size());
+                    own->name_ends.push_back(static_cast<uint32_t>(own->names.size()));
+                    own->line_starts.push_back(storage->line_starts[first + i]);
+                    own->line_counts.push_back(storage->line_counts[first + i]);
+                    own->complexities.push_back(storage->complexities[first + i]);
+                }
+                storage = std::move(own);
+                first = 0;
+            }
+        }
+        return *storage;
+    }
+
+    static void truncate(Storage& columns, size_t rows) {
+        columns.names.resize(rows ? columns.name_ends[rows - 1] : 0);
+        columns.name_ends.resize(rows);
+        columns.line_starts.resize(rows);
+        columns.line_counts.resize(rows);
+        columns.complexities.resize(rows);
+    }
+};
+
 /**
  * @struct FileMetrics
  * @brief Stores aggregated analysis metrics for a single source file.
  */
 struct FileMetrics {
-    std::string file_path;      ///< The full path to the analyzed file.
-    std::vector<FunctionMetric> functions; ///< A list of all functions found in the file.
+    PathId path = PathTable::kNoPath; ///< The analyzed file, or kNoPath if it was skipped.
+    FunctionTable functions;    ///< All functions found in the file, in source order.
 
     // --- Aggregated raw metrics used for scoring ---
     double avg_function_length = 0.0;     ///< Dimension 1: Average function length.
@@ -43,11 +284,18 @@ struct FileMetrics {
     double comment_coverage_ratio = 0.0;  ///< Dimension 3: Comment coverage percentage.
     int naming_violations = 0;            ///< Dimension 4: Count of poorly named identifiers.
 
+    // --- Syntax tree shape (informational, used by the profiler) ---
+    int node_count = 0;                   ///< Number of nodes in the syntax tree.
+    int max_depth = 0;                    ///< Depth of the deepest node (the root is depth 0).
+
     /**
      * The final calculated score, also known as the Legacy Code Index (LCI) or
      * Shit Mountain Index (SMI). A higher value indicates worse code quality.
      */
     double shit_mountain_index = 0.0;
+
+    /// The full path to the analyzed file, materialized from the path table.
+    std::string filePath() const { return PathTable::global().path(path); }
 };
 
 #endif // METRICS_H
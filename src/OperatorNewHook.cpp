@@ -0,0 +1,91 @@
+// src/OperatorNewHook.cpp
+// Global operator new/delete replacement that feeds MemoryTracker's C++ heap counters.
+// Compiled only into executables that define CQA_HOOK_OPERATOR_NEW (see CMakeLists.txt),
+// never into libcqa: a library must not replace its host program's allocator.
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(CQA_HOOK_OPERATOR_NEW) && defined(__GLIBC__)
+#include <malloc.h>
+
+namespace {
+
+using MemoryTracker::detail::cxxTracking;
+
+// Runs during static initialization, before main() can ask for C++ tracking.
+const bool g_registered = (MemoryTracker::detail::cxxHooked.store(true, std::memory_order_relaxed), true);
+
+void* allocate(size_t size) {
+    if (size == 0) size = 1;
+    void* ptr;
+    while (!(ptr = std::malloc(size))) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+    if (cxxTracking.load(std::memory_order_relaxed)) {
+        MemoryTracker::detail::countCxxAllocation(malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+    if (size == 0) size = 1;
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    void* ptr = nullptr;
+    while (posix_memalign(&ptr, align, size) != 0) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+    if (cxxTracking.load(std::memory_order_relaxed)) {
+        MemoryTracker::detail::countCxxAllocation(malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+void release(void* ptr) noexcept {
+    if (!ptr) return;
+    if (cxxTracking.load(std::memory_order_relaxed)) {
+        MemoryTracker::detail::countCxxRelease(malloc_usable_size(ptr));
+    }
+    std::free(ptr);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try { return allocateAligned(size, alignment); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+
+#endif // CQA_HOOK_OPERATOR_NEW && __GLIBC__
@@ -2,11 +2,13 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#include <string>
+#include <string_view>
+#include "LanguageRegistry.h"
 #include "tree_sitter/api.h"
 
 // A wrapper class for the tree-sitter parsing library.
 // It handles parser initialization, language loading, and parsing source code.
+// One Parser can parse any number of files, in any languages, one after another.
 class Parser {
 public:
     Parser();
@@ -14,20 +16,20 @@ public:
 
     // Parses a given string of source code for a specified language.
     // @param sourceCode The source code to parse.
-    // @param language A string identifier for the language (e.g., "cpp", "python").
+    // @param language The language to parse the source as.
     // @return True if parsing was successful, false otherwise.
-    bool parse(const std::string& sourceCode, const std::string& language);
+    bool parse(std::string_view sourceCode, Language language);
 
     // Retrieves the root node of the last successfully parsed syntax tree.
     // @return The root TSNode of the syntax tree.
     TSNode getRootNode() const;
 
+    // Frees the last syntax tree. The parser's own working buffers are kept for the next parse.
+    void reset();
+
 private:
     TSParser* parser;
     TSTree* tree;
-
-    // Retrieves the TSLanguage object for a given language identifier.
-    const TSLanguage* getLanguage(const std::string& language);
 };
 
 #endif // PARSER_H
@@ -0,0 +1,141 @@
+// src/PathTable.cpp
+#include "PathTable.h"
+#include <mutex>
+
+namespace {
+
+    size_t hashComponent(PathId parent, std::string_view name) {
+        uint64_t hash = 1469598103934665603ull ^ (static_cast<uint64_t>(parent) * 0x9e3779b97f4a7c15ull);
+        for (char c : name) hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+
+    bool isSeparator(char c) {
+        return c == '/' || c == PathTable::kSeparator;
+    }
+
+} // namespace
+
+PathTable::PathTable() : nodes{{kRoot, 0, 0}}, buckets(64, kNoPath) {}
+
+PathTable& PathTable::global() {
+    static PathTable table;
+    return table;
+}
+
+void PathTable::grow() {
+    std::vector<PathId> larger(buckets.size() * 2, kNoPath);
+    size_t mask = larger.size() - 1;
+    for (PathId id = 1; id < nodes.size(); ++id) {
+        size_t bucket = hashComponent(nodes[id].parent, nameOf(nodes[id])) & mask;
+        while (larger[bucket] != kNoPath) bucket = (bucket + 1) & mask;
+        larger[bucket] = id;
+    }
+    buckets.swap(larger);
+}
+
+PathId PathTable::internLocked(PathId parent, std::string_view name) {
+    size_t mask = buckets.size() - 1;
+    size_t bucket = hashComponent(parent, name) & mask;
+    for (; buckets[bucket] != kNoPath; bucket = (bucket + 1) & mask) {
+        const Node& node = nodes[buckets[bucket]];
+        if (node.parent == parent && nameOf(node) == name) return buckets[bucket];
+    }
+
+    PathId id = static_cast<PathId>(nodes.size());
+    nodes.push_back({parent, static_cast<uint32_t>(names.size()), static_cast<uint32_t>(name.size())});
+    names.append(name.data(), name.size());
+    buckets[bucket] = id;
+    // Keep the load factor at or below one half so probe sequences stay short.
+    if (nodes.size() * 2 > buckets.size()) grow();
+    return id;
+}
+
+PathId PathTable::intern(PathId parent, std::string_view name) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return internLocked(parent, name);
+}
+
+PathId PathTable::intern(std::string_view path) {
+    // "dir/" and "dir" are the same directory; "/" itself keeps its one empty component.
+    while (path.size() > 1 && isSeparator(path.back())) path.remove_suffix(1);
+    if (path.empty()) return kRoot;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    PathId id = kRoot;
+    size_t start = 0;
+    for (;;) {
+        size_t end = start;
+        while (end < path.size() && !isSeparator(path[end])) ++end;
+        id = internLocked(id, path.substr(start, end - start));
+        if (end >= path.size() || (path.size() == 1 && end == 0)) return id;
+        start = end + 1;
+    }
+}
+
+void PathTable::appendLocked(PathId id, std::string& out) const {
+    if (id == kRoot) return;
+    // The root directory is the lone empty component of an absolute path.
+    if (nodes[id].parent == kRoot && nodes[id].name_length == 0) {
+        out += kSeparator;
+        return;
+    }
+
+    // Measure the chain, then fill it in from the end: one resize, no scratch list.
+    size_t length = 0;
+    for (PathId node = id; node != kRoot; node = nodes[node].parent) length += nodes[node].name_length + 1;
+    size_t start = out.size();
+    size_t end = start + length - 1;
+    out.resize(end);
+    for (PathId node = id; node != kRoot; node = nodes[node].parent) {
+        std::string_view name = nameOf(nodes[node]);
+        end -= name.size();
+        name.copy(&out[end], name.size());
+        if (end > start) out[--end] = kSeparator;
+    }
+}
+
+void PathTable::appendPath(PathId id, std::string& out) const {
+    if (id == kNoPath) return;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    appendLocked(id, out);
+}
+
+std::string PathTable::path(PathId id) const {
+    std::string out;
+    appendPath(id, out);
+    return out;
+}
+
+std::string PathTable::basename(PathId id) const {
+    if (id == kNoPath) return std::string();
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return std::string(nameOf(nodes[id]));
+}
+
+PathId PathTable::parent(PathId id) const {
+    if (id == kNoPath) return kNoPath;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return nodes[id].parent;
+}
+
+int PathTable::compare(PathId a, PathId b) const {
+    if (a == b) return 0;
+    std::string left, right;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        if (a != kNoPath) appendLocked(a, left);
+        if (b != kNoPath) appendLocked(b, right);
+    }
+    return left.compare(right);
+}
+
+size_t PathTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return nodes.size();
+}
+
+size_t PathTable::nameBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return names.size();
+}
@@ -0,0 +1,94 @@
+/**
+ * @file PathTable.h
+ * @brief Interned file paths, stored as a tree of path components.
+ *
+ * Paths of a large tree share long directory prefixes. The table stores every
+ * directory once. Each file or directory is a node made of its parent's id and
+ * a span of a shared string arena holding its own name. A path costs 12 bytes
+ * plus its basename, however deep it is. Results refer to files by `PathId`.
+ * Full paths are materialized only when they are printed or a file is opened.
+ * Files can be grouped by directory by their parent id, with no string handling.
+ *
+ * Interning the same path again returns the same id. The table is shared by all
+ * threads: adding takes an exclusive lock and reading a shared one.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using PathId = uint32_t;
+
+class PathTable {
+public:
+    static constexpr PathId kNoPath = std::numeric_limits<PathId>::max();
+    /// The implicit root that relative paths and the "" component of absolute paths hang off.
+    static constexpr PathId kRoot = 0;
+
+#ifdef _WIN32
+    static constexpr char kSeparator = '\\';
+#else
+    static constexpr char kSeparator = '/';
+#endif
+
+    PathTable();
+
+    /// The table shared by the pipeline and the reports.
+    static PathTable& global();
+
+    /// Interns a whole path, component by component. Trailing separators are ignored.
+    PathId intern(std::string_view path);
+
+    /// Interns one component below an already interned directory; what a directory walk needs.
+    PathId intern(PathId parent, std::string_view name);
+
+    /// @return The full path, or an empty string for kNoPath.
+    std::string path(PathId id) const;
+
+    /// Appends the full path to `out`, so a caller can reuse one buffer for many paths.
+    void appendPath(PathId id, std::string& out) const;
+
+    /// @return The last component of the path.
+    std::string basename(PathId id) const;
+
+    /// @return The directory containing the node, or kRoot at the top.
+    PathId parent(PathId id) const;
+
+    /// Orders two paths like their full strings, without materializing both in the caller.
+    int compare(PathId a, PathId b) const;
+
+    /// Number of nodes (files and directories) and bytes of names held.
+    size_t size() const;
+    size_t nameBytes() const;
+
+private:
+    struct Node {
+        PathId parent;
+        uint32_t name_offset;
+        uint32_t name_length;
+    };
+
+    mutable std::shared_mutex mutex;
+    std::string names;            ///< Every component name, back to back.
+    std::vector<Node> nodes;      ///< Indexed by PathId; nodes[0] is the root.
+    std::vector<PathId> buckets;  ///< Open-addressed (parent, name) -> id index; kNoPath marks a free bucket.
+
+    std::string_view nameOf(const Node& node) const {
+        return std::string_view(names.data() + node.name_offset, node.name_length);
+    }
+    PathId internLocked(PathId parent, std::string_view name);
+    void appendLocked(PathId id, std::string& out) const;
+    void grow();
+};
+
+#endif // PATH_TABLE_H
@@ -0,0 +1,159 @@
+// src/PerfCounters.cpp
+#include "PerfCounters.h"
+#include <atomic>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<bool> g_enabled{false};
+std::atomic<unsigned> g_supportedMask{0};
+
+#if defined(__linux__)
+
+const uint64_t kEventConfig[PerfCounters::kEventCount] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int openEvent(PerfCounters::Event event, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = kEventConfig[event];
+    attr.disabled = groupFd == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1: count the calling thread on whichever CPU it runs.
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+/**
+ * @struct ThreadGroup
+ * @brief The counter group belonging to one thread. Closed when the thread exits.
+ */
+struct ThreadGroup {
+    int fds[PerfCounters::kEventCount] = {-1, -1, -1, -1};
+    int slot[PerfCounters::kEventCount] = {-1, -1, -1, -1}; ///< Position in the group read buffer.
+    int members = 0;
+    bool attempted = false;
+
+    bool open() {
+        attempted = true;
+        fds[PerfCounters::Cycles] = openEvent(PerfCounters::Cycles, -1);
+        if (fds[PerfCounters::Cycles] < 0) return false;
+        slot[PerfCounters::Cycles] = members++;
+        for (int e = PerfCounters::Instructions; e < PerfCounters::kEventCount; ++e) {
+            fds[e] = openEvent(static_cast<PerfCounters::Event>(e), fds[PerfCounters::Cycles]);
+            if (fds[e] >= 0) slot[e] = members++;
+        }
+        ioctl(fds[PerfCounters::Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[PerfCounters::Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+    }
+
+    ~ThreadGroup() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+};
+
+thread_local ThreadGroup t_group;
+
+#endif
+
+} // namespace
+
+namespace PerfCounters {
+
+const char* eventName(Event event) {
+    static const char* const names[kEventCount] = {"cycles", "instructions", "cache-misses", "branch-misses"};
+    return names[event];
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+bool supported(Event event) {
+    return (g_supportedMask.load(std::memory_order_relaxed) >> event) & 1u;
+}
+
+#if defined(__linux__)
+
+bool enable(std::string& reason) {
+    int fds[kEventCount];
+    unsigned mask = 0;
+    fds[Cycles] = openEvent(Cycles, -1);
+    if (fds[Cycles] < 0) {
+        int error = errno;
+        reason = std::strerror(error);
+        if (error == EACCES || error == EPERM) {
+            reason += " (perf events are not permitted; check /proc/sys/kernel/perf_event_paranoid "
+                      "or the container's seccomp profile)";
+        } else if (error == ENOENT || error == EOPNOTSUPP) {
+            reason += " (no hardware PMU exposed, e.g. inside a virtual machine)";
+        }
+        return false;
+    }
+    mask |= 1u << Cycles;
+    for (int e = Instructions; e < kEventCount; ++e) {
+        fds[e] = openEvent(static_cast<Event>(e), fds[Cycles]);
+        if (fds[e] >= 0) {
+            mask |= 1u << e;
+            close(fds[e]);
+        }
+    }
+    close(fds[Cycles]);
+    g_supportedMask.store(mask, std::memory_order_relaxed);
+    g_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool read(Sample& sample) {
+    if (!enabled()) return false;
+    if (!t_group.attempted && !t_group.open()) return false;
+    if (t_group.fds[Cycles] < 0) return false;
+
+    // Layout with PERF_FORMAT_GROUP: nr, time_enabled, time_running, value[nr].
+    uint64_t buffer[3 + kEventCount];
+    ssize_t bytes = ::read(t_group.fds[Cycles], buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) return false;
+
+    uint64_t enabledNs = buffer[1], runningNs = buffer[2];
+    double scale = runningNs > 0 ? static_cast<double>(enabledNs) / runningNs : 1.0;
+    for (int e = 0; e < kEventCount; ++e) {
+        int slot = t_group.slot[e];
+        sample.value[e] = slot >= 0 && static_cast<uint64_t>(slot) < buffer[0]
+                              ? static_cast<uint64_t>(buffer[3 + slot] * scale)
+                              : 0;
+    }
+    return true;
+}
+
+#else
+
+bool enable(std::string& reason) {
+    reason = "hardware counters require Linux perf_event_open";
+    return false;
+}
+
+bool read(Sample&) {
+    return false;
+}
+
+#endif
+
+} // namespace PerfCounters
@@ -0,0 +1,63 @@
+/**
+ * @file PerfCounters.h
+ * @brief Optional hardware performance counters via Linux `perf_event_open`.
+ *
+ * Each thread lazily opens one counter group (cycles, instructions, cache misses,
+ * branch misses) that counts user-space events of that thread only. The profiler
+ * reads the group at the start and end of every phase scope and accumulates the
+ * deltas. If perf events are not available (non-Linux build, a restrictive
+ * `perf_event_paranoid`, or a container seccomp profile), `enable()` reports why
+ * and the rest of the run proceeds without counters.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace PerfCounters {
+
+    enum Event : uint8_t {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        kEventCount
+    };
+
+    /**
+     * @struct Sample
+     * @brief A snapshot of the calling thread's counters, scaled for multiplexing.
+     */
+    struct Sample {
+        uint64_t value[kEventCount] = {};
+    };
+
+    const char* eventName(Event event);
+
+    /**
+     * @brief Probes whether counters can be opened and, if so, turns collection on.
+     * Must be called before any worker thread starts.
+     * @param reason Receives a human-readable explanation when counters are unavailable.
+     * @return True if at least the cycle counter could be opened.
+     */
+    bool enable(std::string& reason);
+    bool enabled();
+
+    /// @return True if the given event was supported by the probe.
+    bool supported(Event event);
+
+    /**
+     * @brief Reads the calling thread's counter group, opening it on first use.
+     * @return False if the group could not be opened or read on this thread.
+     */
+    bool read(Sample& sample);
+
+} // namespace PerfCounters
+
+#endif // PERF_COUNTERS_H
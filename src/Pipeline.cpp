@@ -0,0 +1,420 @@
+// src/Pipeline.cpp
+#include "Pipeline.h"
+#include "Analyzer.h"
+#include "BudgetPlanner.h"
+#include "MemoryTracker.h"
+#include "Parser.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+Language getLanguageFromFile(const std::string& filePath) {
+    Language language = LanguageRegistry::fromExtension(filePath);
+    if (language != Language::Unsupported || !LanguageRegistry::needsSniffing(filePath)) return language;
+
+    char head[LanguageRegistry::kSniffBytes];
+    std::ifstream file(filePath, std::ios::binary);
+    file.read(head, sizeof(head));
+    return LanguageRegistry::sniff(std::string_view(head, static_cast<size_t>(file.gcount())));
+}
+
+/// Extensionless files larger than this are only sniffed if they are executable.
+constexpr uintmax_t kSniffMaxBytes = 1 << 20;
+
+/**
+ * @brief Determines the language of a file found by the walk.
+ * Unlike getLanguageFromFile(), an extensionless file is only opened if it could be a
+ * script: if it is executable, or small. Checkouts hold many extensionless data files.
+ */
+static Language walkedFileLanguage(const fs::directory_entry& entry, const std::string& filePath) {
+    Language language = LanguageRegistry::fromExtension(filePath);
+    if (language != Language::Unsupported || !LanguageRegistry::needsSniffing(filePath)) return language;
+    std::error_code ec;
+    constexpr fs::perms executable = fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec;
+    bool script = (entry.status(ec).permissions() & executable) != fs::perms::none;
+    if (!script && (entry.file_size(ec) > kSniffMaxBytes || ec)) return Language::Unsupported;
+    return getLanguageFromFile(filePath);
+}
+
+/// @return True for version control metadata directories, which the walk does not enter.
+static bool isVcsDirectory(const fs::path& directory) {
+    fs::path name = directory.filename();
+    return name == ".git" || name == ".hg" || name == ".svn";
+}
+
+Analyzer* AnalysisWorkspace::analyzer(Language language) {
+    if (language == Language::Unsupported) return nullptr;
+    std::unique_ptr<Analyzer>& analyzer = analyzers[LanguageRegistry::index(language)];
+    if (!analyzer) {
+        std::unique_ptr<LanguageStrategy> strategy = createStrategy(language);
+        if (strategy) analyzer = std::make_unique<Analyzer>(std::move(strategy));
+    }
+    return analyzer.get();
+}
+
+/**
+ * @brief Reads a whole file into `out`, reusing its capacity.
+ * On POSIX systems this reads through the file descriptor directly, because an
+ * ifstream allocates a fresh stream buffer for every file it opens.
+ */
+static bool readSource(const std::string& filePath, std::string& out) {
+    out.clear();
+    size_t size = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat info;
+    // One byte of slack, so the read that finds the end of the file does not grow the buffer.
+    size_t expected = ::fstat(fd, &info) == 0 && info.st_size > 0 ? static_cast<size_t>(info.st_size) : 0;
+    out.resize(expected + 1);
+    for (;;) {
+        if (size == out.size()) out.resize(out.size() * 2);
+        ssize_t n = ::read(fd, &out[size], out.size() - size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ::close(fd);
+            out.resize(size);
+            return n == 0;
+        }
+        size += static_cast<size_t>(n);
+    }
+#else
+    std::FILE* file = std::fopen(filePath.c_str(), "r");
+    if (!file) return false;
+    out.resize(std::max<size_t>(out.capacity(), 4096));
+    for (;;) {
+        if (size == out.size()) out.resize(out.size() * 2);
+        size_t n = std::fread(&out[size], 1, out.size() - size, file);
+        size += n;
+        if (n == 0) {
+            bool failed = std::ferror(file) != 0;
+            std::fclose(file);
+            out.resize(size);
+            return !failed;
+        }
+    }
+#endif
+}
+
+bool analyzeFile(PathId path, Language language, AnalysisWorkspace& workspace, FileMetrics& metrics) {
+    Analyzer* analyzer = workspace.analyzer(language);
+    if (!analyzer) return false;
+
+    workspace.path.clear();
+    PathTable::global().appendPath(path, workspace.path);
+    const std::string& filePath = workspace.path;
+    CQA_TRACE_FILE(filePath, language);
+
+    {
+        CQA_TRACE_SCOPE(Read);
+        if (!readSource(filePath, workspace.source)) {
+            Telemetry::skip(Telemetry::SkipReason::Unreadable);
+            return false;
+        }
+    }
+    const std::string& sourceCode = workspace.source;
+    CQA_TRACE_FILE_BYTES(sourceCode.size());
+
+    bool parsed;
+    {
+        Telemetry::StageTimer timer(Telemetry::Stage::Parse, language);
+        parsed = workspace.parser.parse(sourceCode, language);
+    }
+    if (!parsed) {
+        workspace.parser.reset();
+        Telemetry::add(Telemetry::Counter::ParseErrors, language);
+        std::cerr << "\n[Warning] Failed to parse: " << filePath << std::endl;
+        return false;
+    }
+
+    {
+        Telemetry::StageTimer timer(Telemetry::Stage::Analyze, language);
+        analyzer->analyze(workspace.parser.getRootNode(), path, sourceCode, metrics);
+    }
+    // Free the tree now rather than at the next parse: the governor charges a file's
+    // tree to that file, and an idle worker should not hold on to one.
+    workspace.parser.reset();
+    CQA_TRACE_FILE_SHAPE(metrics.node_count, metrics.max_depth);
+    Telemetry::add(Telemetry::Counter::FilesAnalyzed, language);
+    Telemetry::add(Telemetry::Counter::SourceBytes, language, sourceCode.size());
+    return true;
+}
+
+FileMetrics analyzeFile(PathId path, Language language) {
+    AnalysisWorkspace workspace;
+    FileMetrics metrics;
+    if (!analyzeFile(path, language, workspace, metrics)) return FileMetrics();
+    return metrics;
+}
+
+/**
+ * @struct WorkerResults
+ * @brief Everything one worker produces in a run. Only that worker touches it until
+ * it is joined, so results are stored without a lock.
+ */
+struct WorkerResults {
+    /// Language and size of each analyzed file, for the ResultCache, which is updated after the run.
+    struct CacheUpdate {
+        Language language;
+        uint64_t bytes;
+    };
+
+    std::vector<FileMetrics> metrics;
+    std::vector<CacheUpdate> cache_updates; ///< Parallel to `metrics`, when there is a cache.
+    LoopAllocations allocations;
+
+    size_t capacity() const {
+        return metrics.capacity() * sizeof(FileMetrics) + cache_updates.capacity() * sizeof(CacheUpdate);
+    }
+};
+
+/**
+ * @brief Worker loop: analyzes files handed out by the governor until the queue drains.
+ */
+static void analysisWorker(unsigned index, MemoryGovernor& governor, const PipelineOptions& options,
+                           AnalysisWorkspace& workspace, WorkerResults& results) {
+    CQA_TRACE_THREAD_NAME("worker " + std::to_string(index));
+    // Every file is analyzed into `scratch`, and its result keeps a copy. The copies share
+    // the scratch table's storage, so that becomes the worker's run table of functions
+    // and storing a result allocates nothing (see FunctionTable).
+    FileMetrics scratch;
+    const ResultReservation& reserve = options.reserve;
+    results.metrics.reserve(reserve.files);
+    if (options.cache) results.cache_updates.reserve(reserve.files);
+    if (reserve.functions != 0) scratch.functions.reserve(reserve.functions, reserve.name_bytes);
+    GovernorJob job;
+    for (;;) {
+        bool admitted;
+        {
+            CQA_TRACE_SCOPE(Wait);
+            admitted = governor.acquire(job);
+        }
+        if (!admitted) break;
+
+        MemoryTracker::Window turn;
+        size_t capacity = 0;
+        if (options.loop_allocations) {
+            turn = MemoryTracker::beginWindow();
+            capacity = results.capacity() + scratch.functions.storageCapacity();
+        }
+
+        if (options.show_progress) std::cout << ".";
+        bool fetched = options.remote && options.remote->take(job.path, scratch);
+        MemoryTracker::Window window = MemoryTracker::beginWindow();
+        bool analyzed = fetched || analyzeFile(job.path, job.language, workspace, scratch);
+        MemoryTracker::Usage usage[MemoryTracker::kHeapCount];
+        MemoryTracker::endWindow(window, usage);
+        governor.release(job, usage[MemoryTracker::TreeSitter].peak);
+
+        if (analyzed) {
+            if (fetched) {
+                Telemetry::add(Telemetry::Counter::RemoteCacheHits, job.language);
+            } else if (options.remote) {
+                options.remote->store(job.language, workspace.source, scratch);
+            }
+            results.metrics.push_back(scratch);
+            if (options.cache) results.cache_updates.push_back({job.language, job.source_bytes});
+        }
+
+        if (options.loop_allocations) {
+            MemoryTracker::endWindow(turn, usage);
+            const MemoryTracker::Usage& cxx = usage[MemoryTracker::Cxx];
+            LoopAllocations& counts = results.allocations;
+            counts.files++;
+            counts.allocations += cxx.allocations;
+            counts.bytes += cxx.bytes;
+            counts.tree_allocations += usage[MemoryTracker::TreeSitter].allocations;
+            if (results.capacity() + scratch.functions.storageCapacity() != capacity) counts.growth_files++;
+            if (cxx.allocations > 0) {
+                counts.allocating_files++;
+                if (cxx.allocations > counts.worst_allocations) {
+                    counts.worst_allocations = cxx.allocations;
+                    counts.worst_file = job.path;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Walks the input directory and hands every supported source file to `visit(id, language, bytes)`.
+ */
+template <typename Visit>
+static void walkFiles(const std::string& path, Visit&& visit) {
+    CQA_TRACE_SCOPE(Walk);
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        // Intern each entry below its directory's id rather than splitting the full path
+        // again: directories[d] is the id of the directory holding entries at depth d.
+        PathTable& paths = PathTable::global();
+        std::vector<PathId> directories{paths.intern(path)};
+        // Non-throwing: the workers may already be running, and an unreadable directory
+        // is reported like an unreadable file rather than ending the process.
+        fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, ec), end;
+        for (; !ec && it != end; it.increment(ec)) {
+            const fs::directory_entry& entry = *it;
+            size_t depth = static_cast<size_t>(it.depth());
+            directories.resize(depth + 1);
+            std::error_code status; // a dangling link is neither, and does not end the walk
+            if (entry.is_directory(status)) {
+                if (isVcsDirectory(entry.path())) {
+                    it.disable_recursion_pending();
+                    continue;
+                }
+                directories.push_back(paths.intern(directories[depth], entry.path().filename().string()));
+                continue;
+            }
+            if (!entry.is_regular_file(status)) continue;
+            std::string file = entry.path().string();
+            Language language = walkedFileLanguage(entry, file);
+            if (language != Language::Unsupported) {
+                PathId id = paths.intern(directories[depth], entry.path().filename().string());
+                uintmax_t bytes = entry.file_size(status);
+                visit(id, language, status ? 0 : bytes);
+            } else {
+                Telemetry::skip(Telemetry::SkipReason::Unsupported);
+            }
+        }
+        if (ec) std::cerr << "\n[Warning] Failed to walk: " << path << ": " << ec.message() << std::endl;
+    }
+}
+
+/**
+ * @brief Queues every file with the governor, likely-worst first, for a budgeted run.
+ * The workers start only after the walk, so the first files admitted are the
+ * head of the ordering rather than whatever the walk found first.
+ */
+static void submitOrdered(const std::string& path, const PipelineOptions& options, MemoryGovernor& governor) {
+    std::vector<BudgetPlanner::Candidate> candidates;
+    walkFiles(path, [&](PathId id, Language language, uint64_t bytes) {
+        BudgetPlanner::Candidate candidate;
+        candidate.path = id;
+        candidate.language = language;
+        candidate.bytes = bytes;
+        candidates.push_back(candidate);
+    });
+    BudgetPlanner::order(candidates, options.cache, BudgetPlanner::gitChurn(path));
+    for (const BudgetPlanner::Candidate& candidate : candidates) {
+        if (options.remote) options.remote->prefetch(candidate.path, candidate.language);
+        governor.submit(candidate.path, candidate.language, candidate.bytes);
+    }
+}
+
+std::vector<FileMetrics> analyzePath(const std::string& path, const PipelineOptions& options, GovernorStats* stats) {
+    // A single file needs neither the walker nor the worker pool; analyze it on this thread.
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec)) {
+        std::vector<FileMetrics> all_metrics;
+        if (options.show_progress) std::cout << ".";
+        Language language = getLanguageFromFile(path);
+        FileMetrics result = analyzeFile(PathTable::global().intern(path), language);
+        uint64_t bytes = fs::file_size(path, ec);
+        if (result.path != PathTable::kNoPath) {
+            if (options.cache) options.cache->record(path, language, bytes, result.shit_mountain_index);
+            all_metrics.push_back(std::move(result));
+        }
+        if (stats) {
+            *stats = GovernorStats();
+            stats->files_admitted = 1;
+            stats->bytes_admitted = ec ? 0 : bytes;
+            stats->min_concurrency = 1;
+            stats->peak_tree_bytes = MemoryTracker::peakBytes();
+        }
+        return all_metrics;
+    }
+
+    GovernorConfig config = options.governor;
+    bool budgeted = options.budget_seconds > 0.0;
+    if (budgeted) {
+        // The walk and the ordering are charged to the budget too.
+        config.deadline = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double>(options.budget_seconds));
+        config.ordered = true;
+    }
+    MemoryGovernor governor(config);
+    std::vector<std::unique_ptr<AnalysisWorkspace>> runWorkspaces;
+    std::vector<std::unique_ptr<AnalysisWorkspace>>& workspaces = options.workspaces ? *options.workspaces : runWorkspaces;
+    while (workspaces.size() < config.max_workers) workspaces.push_back(std::make_unique<AnalysisWorkspace>());
+    std::vector<WorkerResults> results(config.max_workers);
+
+    auto startWorkers = [&](std::vector<std::thread>& workers) {
+        for (unsigned i = 0; i < config.max_workers; ++i) {
+            workers.emplace_back(analysisWorker, i, std::ref(governor), std::cref(options), std::ref(*workspaces[i]),
+                                 std::ref(results[i]));
+        }
+    };
+    std::vector<std::thread> workers;
+    if (options.remote) options.remote->beginRun();
+    if (budgeted) {
+        submitOrdered(path, options, governor);
+        governor.close();
+        startWorkers(workers);
+    } else {
+        startWorkers(workers);
+        walkFiles(path, [&](PathId id, Language language, uint64_t bytes) {
+            // Looked up before it is queued, so the lookup has a head start on the workers.
+            if (options.remote) options.remote->prefetch(id, language);
+            governor.submit(id, language, bytes);
+        });
+        governor.close();
+    }
+    for (auto& worker : workers) worker.join();
+    if (options.remote) options.remote->finishRun();
+
+    size_t total = 0;
+    for (const WorkerResults& worker : results) total += worker.metrics.size();
+    std::vector<FileMetrics> all_metrics;
+    all_metrics.reserve(total);
+    std::string filePath;
+    for (WorkerResults& worker : results) {
+        if (options.cache) {
+            for (size_t i = 0; i < worker.metrics.size(); ++i) {
+                const FileMetrics& metrics = worker.metrics[i];
+                filePath.clear();
+                PathTable::global().appendPath(metrics.path, filePath);
+                options.cache->record(filePath, worker.cache_updates[i].language, worker.cache_updates[i].bytes,
+                                      metrics.shit_mountain_index);
+            }
+        }
+        if (options.loop_allocations) {
+            LoopAllocations& counts = *options.loop_allocations;
+            const LoopAllocations& worker_counts = worker.allocations;
+            counts.files += worker_counts.files;
+            counts.growth_files += worker_counts.growth_files;
+            counts.allocating_files += worker_counts.allocating_files;
+            counts.allocations += worker_counts.allocations;
+            counts.bytes += worker_counts.bytes;
+            counts.tree_allocations += worker_counts.tree_allocations;
+            if (worker_counts.worst_allocations > counts.worst_allocations) {
+                counts.worst_allocations = worker_counts.worst_allocations;
+                counts.worst_file = worker_counts.worst_file;
+            }
+        }
+        std::move(worker.metrics.begin(), worker.metrics.end(), std::back_inserter(all_metrics));
+    }
+
+    GovernorStats summary = governor.stats();
+    if (summary.files_expired != 0) Telemetry::skip(Telemetry::SkipReason::Budget, summary.files_expired);
+    if (stats) *stats = summary;
+    return all_metrics;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file Pipeline.h
+ * @brief The analysis pipeline shared by the `cqa` command and the benchmarks.
+ *
+ * Covers everything between "here is a path" and "here are the metrics":
+ * language detection, reading, parsing and analyzing a file, and the parallel
+ * walk of a directory tree under the MemoryGovernor. Reporting stays with the
+ * callers.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Analyzer.h"
+#include "LanguageRegistry.h"
+#include "MemoryGovernor.h"
+#include "Metrics.h"
+#include "Parser.h"
+#include "RemoteCache.h"
+#include "ResultCache.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+struct AnalysisWorkspace;
+
+/**
+ * @struct LoopAllocations
+ * @brief C++ heap allocations of the workers' per-file loop, for `cqa-bench --alloc-check`.
+ *
+ * Each file's turn is measured from its admission to storing its result. Any C++
+ * allocation makes the turn an allocating one, including growing the worker's
+ * results (its list of metrics or its run table of functions, see FunctionTable):
+ * a measured run reserves room for them up front (see ResultReservation).
+ */
+struct LoopAllocations {
+    size_t files = 0;
+    size_t growth_files = 0;          ///< Turns that grew the worker's results past the reservation.
+    size_t allocating_files = 0;      ///< Turns that allocated, growth included.
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t tree_allocations = 0;    ///< Tree-sitter allocations, for reference.
+    uint64_t worst_allocations = 0;   ///< Most allocations in a turn.
+    PathId worst_file = PathTable::kNoPath;
+};
+
+/**
+ * @struct ResultReservation
+ * @brief Room each worker reserves for its results before a run.
+ * Taken from an earlier run over the same files, it keeps the results from
+ * growing during the run, so that a measured run sees only the loop's own allocations.
+ */
+struct ResultReservation {
+    size_t files = 0;
+    size_t functions = 0;
+    size_t name_bytes = 0;  ///< Bytes of all function names.
+};
+
+/**
+ * @struct PipelineOptions
+ * @brief Settings for one run over a path.
+ */
+struct PipelineOptions {
+    GovernorConfig governor;    ///< Worker count and memory limits.
+    bool show_progress = false; ///< Print a dot to stdout for every file analyzed.
+    /// If positive, files still queued this many seconds after the run starts are skipped,
+    /// and the files likely to score worst are queued first (see BudgetPlanner.h).
+    double budget_seconds = 0.0;
+    /// Orders a budgeted run, and receives the score of every file analyzed. May be null.
+    ResultCache* cache = nullptr;
+    /// Shared results to reuse instead of analyzing, and to add to (see RemoteCache.h). May be null.
+    /// Directory runs only: a single file is analyzed directly.
+    RemoteCache* remote = nullptr;
+    /// Per-worker workspaces kept by the caller, so parsers and buffers stay warm from one run
+    /// to the next (`--watch`). Grown to the worker count. May be null.
+    std::vector<std::unique_ptr<AnalysisWorkspace>>* workspaces = nullptr;
+    /// If not null, receives the allocations of every file's turn through the worker loop.
+    /// Needs MemoryTracker::enableCxxTracking().
+    LoopAllocations* loop_allocations = nullptr;
+    /// Room each worker reserves for its results; none by default.
+    ResultReservation reserve;
+};
+
+/**
+ * @brief Determines the programming language of a file from its extension.
+ * Files without an extension are detected from their shebang line or modeline,
+ * which reads the start of the file.
+ * @return The language, or Language::Unsupported.
+ */
+Language getLanguageFromFile(const std::string& filePath);
+
+/**
+ * @struct AnalysisWorkspace
+ * @brief Per-thread state that is reused from one file to the next.
+ *
+ * Holds a parser, one Analyzer per language, and the buffers that a file's path
+ * and contents are read into. Once these have grown to fit the largest file seen,
+ * analyzing another file into the same FileMetrics makes no C++ heap allocation.
+ * Tree-sitter still allocates each file's syntax tree on its own heap.
+ */
+struct AnalysisWorkspace {
+    Parser parser;
+    std::string path;   ///< The current file's path, materialized from the PathTable.
+    std::string source; ///< The current file's contents.
+    std::unique_ptr<Analyzer> analyzers[LanguageRegistry::kMaxLanguages];
+
+    /// @return The language's analyzer, created on first use, or null for Language::Unsupported.
+    Analyzer* analyzer(Language language);
+};
+
+/**
+ * @brief Reads, parses, and analyzes a single source file into `metrics`, reusing the workspace.
+ * @param metrics Overwritten on success; its buffers are reused.
+ * @return False if the file was skipped: unsupported, unreadable or unparsable.
+ */
+bool analyzeFile(PathId path, Language language, AnalysisWorkspace& workspace, FileMetrics& metrics);
+
+/**
+ * @brief Reads, parses, and analyzes a single source file.
+ * @param path The file, interned in PathTable::global().
+ * @param language The file's language, as returned by getLanguageFromFile().
+ * @return The file's metrics, or metrics whose `path` is kNoPath if the file was skipped.
+ */
+FileMetrics analyzeFile(PathId path, Language language);
+
+/**
+ * @brief Analyzes a file, or every supported file below a directory, in parallel.
+ * A single file is analyzed directly on the calling thread, without starting workers.
+ * With a budget, the whole tree is walked and ordered before any file is queued;
+ * the files skipped when time runs out are counted in `stats`. A single file
+ * ignores the budget and is reported in `stats` as the one file admitted.
+ * @param stats If not null, receives the governor's end-of-run summary.
+ * @return Metrics for every analyzed file, grouped by worker and in completion order within each.
+ *         The function tables of one worker's files share that worker's run-level storage.
+ */
+std::vector<FileMetrics> analyzePath(const std::string& path, const PipelineOptions& options,
+                                     GovernorStats* stats = nullptr);
+
+#endif // PIPELINE_H
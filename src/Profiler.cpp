@@ -0,0 +1,624 @@
+// src/Profiler.cpp
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct FileRecord {
+    std::string path;
+    std::string language;
+    size_t bytes = 0;
+    int node_count = 0;
+    int max_depth = 0;
+    uint64_t phase_ns[Profiler::kPhaseCount] = {};
+    uint64_t events[Profiler::kPhaseCount][PerfCounters::kEventCount] = {};
+    MemoryTracker::Usage memory[Profiler::kPhaseCount][MemoryTracker::kHeapCount] = {};
+    uint64_t counters[Profiler::kCounterCount] = {};
+
+    uint64_t totalNs() const {
+        uint64_t total = 0;
+        for (uint64_t ns : phase_ns) total += ns;
+        return total;
+    }
+};
+
+constexpr uint8_t kFileSpan = 0xff;          ///< TraceEvent::kind for a whole-file span.
+constexpr uint32_t kNoFile = 0xffffffffu;
+
+/**
+ * @struct TraceEvent
+ * @brief A completed span, stored compactly; names and arguments are resolved at write time.
+ */
+struct TraceEvent {
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint32_t file;  ///< Number of the file on its thread (see ThreadBuffer::first_file), or kNoFile.
+    uint16_t owner; ///< Index of the recording thread in ThreadBuffer::owners.
+    uint8_t kind;   ///< A Phase value or kFileSpan.
+};
+
+/// A thread that held a buffer, as it appears in the trace.
+struct TraceThread {
+    int tid;
+    std::string name;
+};
+
+// One buffer per live thread; only the owning thread writes to it while the run is in progress.
+// A thread that exits hands its buffer on to the next new thread, so per-run workers reuse them.
+struct ThreadBuffer {
+    std::deque<FileRecord> files;
+    uint32_t first_file = 0; ///< Number of files.front(); earlier records were evicted.
+    bool in_use = true;
+    uint64_t unattributed_ns[Profiler::kPhaseCount] = {};
+    MemoryTracker::Usage unattributed_memory[Profiler::kPhaseCount][MemoryTracker::kHeapCount] = {};
+    uint64_t unattributed_counters[Profiler::kCounterCount] = {};
+    bool in_file = false;
+
+    // --- Trace ring buffer ---
+    /// The threads that held the buffer since the last reset, the current one last. The ring
+    /// can still hold a previous holder's spans, which keep that thread's tid and name.
+    std::vector<TraceThread> owners;
+    std::vector<TraceEvent> ring;
+    size_t ring_next = 0;
+    size_t dropped = 0;
+};
+
+std::atomic<bool> g_report{false};
+std::atomic<bool> g_trace{false};
+std::atomic<bool> g_memory{false};
+size_t g_traceCapacity = 0;
+Clock::time_point g_start;
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+int g_nextTid = 1; ///< Guarded by g_registryMutex.
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+// Releases the thread's buffer when the thread exits.
+struct BufferLease {
+    ~BufferLease() {
+        if (!t_buffer) return;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        t_buffer->in_use = false;
+        t_buffer->in_file = false;
+    }
+};
+thread_local BufferLease t_lease;
+
+ThreadBuffer& localBuffer() {
+    if (!t_buffer) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (const auto& buffer : g_buffers) {
+            if (!buffer->in_use) {
+                t_buffer = buffer.get();
+                break;
+            }
+        }
+        if (!t_buffer) {
+            g_buffers.push_back(std::make_unique<ThreadBuffer>());
+            t_buffer = g_buffers.back().get();
+        }
+        t_buffer->in_use = true;
+        // A new trace row for every thread. Past the owner index's range, the last row is reused.
+        if (t_buffer->owners.size() <= std::numeric_limits<uint16_t>::max()) {
+            t_buffer->owners.push_back({g_nextTid++, std::string()});
+        } else {
+            t_buffer->owners.back().name.clear();
+        }
+        // Touch the lease so its destructor runs when this thread exits.
+        static_cast<void>(&t_lease);
+    }
+    return *t_buffer;
+}
+
+void activate() {
+    if (!Profiler::enabled()) g_start = Clock::now();
+    Profiler::detail::active.store(true, std::memory_order_relaxed);
+}
+
+void recordSpan(ThreadBuffer& buffer, uint8_t kind, Clock::time_point start, uint64_t durationNs) {
+    TraceEvent event;
+    event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - g_start).count();
+    event.duration_ns = durationNs;
+    event.file = buffer.in_file ? buffer.first_file + static_cast<uint32_t>(buffer.files.size() - 1) : kNoFile;
+    event.owner = static_cast<uint16_t>(buffer.owners.size() - 1);
+    event.kind = kind;
+    if (buffer.ring.size() < g_traceCapacity) {
+        buffer.ring.push_back(event);
+        return;
+    }
+    buffer.ring[buffer.ring_next] = event;
+    buffer.ring_next = (buffer.ring_next + 1) % buffer.ring.size();
+    buffer.dropped++;
+
+    // Without the timing report, a file record is only needed while a span in the ring refers to it.
+    // Spans are recorded in file order, so the oldest span holds the oldest file still referenced.
+    if (g_report.load(std::memory_order_relaxed)) return;
+    uint32_t oldest = buffer.ring[buffer.ring_next].file;
+    if (oldest == kNoFile) return;
+    while (buffer.first_file < oldest) {
+        buffer.files.pop_front();
+        buffer.first_file++;
+    }
+}
+
+void writeJsonString(std::FILE* out, const std::string& value) {
+    std::fputc('"', out);
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+            std::fputc(c, out);
+        } else if (c < 0x20) {
+            std::fprintf(out, "\\u%04x", c);
+        } else {
+            std::fputc(c, out);
+        }
+    }
+    std::fputc('"', out);
+}
+
+double toMs(uint64_t ns) { return ns / 1e6; }
+
+} // namespace
+
+namespace Profiler {
+
+std::atomic<bool> detail::active{false};
+
+const char* phaseName(Phase phase) {
+    static const char* const names[kPhaseCount] = {
+        "walk", "read", "parse", "functions", "file-wide", "naming", "score", "report", "queue-wait"};
+    return names[static_cast<size_t>(phase)];
+}
+
+const char* counterName(Counter counter) {
+    static const char* const names[kCounterCount] = {"source-bytes", "tree-nodes", "functions"};
+    return names[static_cast<size_t>(counter)];
+}
+
+void enable() {
+    activate();
+    g_report.store(true, std::memory_order_relaxed);
+}
+
+void detail::addCount(Counter counter, uint64_t amount) {
+    ThreadBuffer& buffer = localBuffer();
+    size_t index = static_cast<size_t>(counter);
+    if (buffer.in_file) {
+        buffer.files.back().counters[index] += amount;
+    } else {
+        buffer.unattributed_counters[index] += amount;
+    }
+}
+
+void enableTrace(size_t eventsPerThread) {
+    activate();
+    g_traceCapacity = std::max<size_t>(1, eventsPerThread);
+    g_trace.store(true, std::memory_order_relaxed);
+}
+
+bool tracing() {
+    return g_trace.load(std::memory_order_relaxed);
+}
+
+void enableMemory() {
+    enable();
+    g_memory.store(true, std::memory_order_relaxed);
+}
+
+bool memoryProfiling() {
+    return g_memory.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const std::string& name) {
+    if (enabled()) localBuffer().owners.back().name = name;
+}
+
+// --- FileScope ---
+
+void FileScope::begin(const std::string& path, Language language) {
+    ThreadBuffer& buffer = localBuffer();
+    buffer.files.emplace_back();
+    buffer.files.back().path = path;
+    buffer.files.back().language = LanguageRegistry::name(language);
+    buffer.in_file = true;
+    if (tracing()) start = Clock::now();
+}
+
+void FileScope::end() {
+    if (tracing()) {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        recordSpan(*t_buffer, kFileSpan, start, ns);
+    }
+    t_buffer->in_file = false;
+}
+
+void FileScope::setSourceBytes(size_t bytes) {
+    if (active) t_buffer->files.back().bytes = bytes;
+}
+
+void FileScope::setTreeShape(int nodeCount, int maxDepth) {
+    if (!active) return;
+    t_buffer->files.back().node_count = nodeCount;
+    t_buffer->files.back().max_depth = maxDepth;
+}
+
+// --- PhaseScope ---
+
+void PhaseScope::begin() {
+    measuring = memoryProfiling();
+    if (measuring) memoryWindow = MemoryTracker::beginWindow();
+    counting = PerfCounters::enabled() && PerfCounters::read(startCounters);
+    start = Clock::now();
+}
+
+void PhaseScope::end() {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    PerfCounters::Sample endCounters;
+    bool counted = counting && PerfCounters::read(endCounters);
+    // Close the window before any bookkeeping below allocates.
+    MemoryTracker::Usage usage[MemoryTracker::kHeapCount];
+    if (measuring) MemoryTracker::endWindow(memoryWindow, usage);
+    auto addUsage = [&](MemoryTracker::Usage* total) {
+        for (size_t h = 0; h < MemoryTracker::kHeapCount; ++h) {
+            total[h].allocations += usage[h].allocations;
+            total[h].bytes += usage[h].bytes;
+            total[h].peak = std::max(total[h].peak, usage[h].peak);
+        }
+    };
+
+    ThreadBuffer& buffer = localBuffer();
+    size_t index = static_cast<size_t>(phase);
+    if (tracing()) recordSpan(buffer, static_cast<uint8_t>(phase), start, ns);
+    if (!buffer.in_file) {
+        buffer.unattributed_ns[index] += ns;
+        if (measuring) addUsage(buffer.unattributed_memory[index]);
+        return;
+    }
+    FileRecord& file = buffer.files.back();
+    file.phase_ns[index] += ns;
+    if (measuring) addUsage(file.memory[index]);
+    if (counted) {
+        for (size_t e = 0; e < PerfCounters::kEventCount; ++e) {
+            file.events[index][e] += endCounters.value[e] - startCounters.value[e];
+        }
+    }
+}
+
+// --- Report ---
+
+/**
+ * @brief Prints peak memory, per-phase allocation totals, tree size relative to source
+ * per language, and the files that allocated the most. The registry lock must be held.
+ */
+static void printMemoryReport(std::ostream& os, std::vector<const FileRecord*> files, size_t topN) {
+    using MemoryTracker::Cxx;
+    using MemoryTracker::TreeSitter;
+    const size_t parse = static_cast<size_t>(Phase::Parse);
+    const bool haveCxx = MemoryTracker::cxxTrackingEnabled();
+
+    MemoryTracker::Usage phases[kPhaseCount][MemoryTracker::kHeapCount] = {};
+    auto merge = [](MemoryTracker::Usage& total, const MemoryTracker::Usage& add) {
+        total.allocations += add.allocations;
+        total.bytes += add.bytes;
+        total.peak = std::max(total.peak, add.peak);
+    };
+    struct LanguageMemory {
+        size_t files = 0;
+        size_t source_bytes = 0;
+        uint64_t tree_bytes = 0;
+        uint64_t cxx_allocations = 0;
+    };
+    std::map<std::string, LanguageMemory> byLanguage;
+    auto fileBytes = [](const FileRecord* file) {
+        uint64_t total = 0;
+        for (size_t p = 0; p < kPhaseCount; ++p) {
+            for (size_t h = 0; h < MemoryTracker::kHeapCount; ++h) total += file->memory[p][h].bytes;
+        }
+        return total;
+    };
+
+    for (const auto& buffer : g_buffers) {
+        for (size_t p = 0; p < kPhaseCount; ++p) {
+            for (size_t h = 0; h < MemoryTracker::kHeapCount; ++h) merge(phases[p][h], buffer->unattributed_memory[p][h]);
+        }
+    }
+    for (const FileRecord* file : files) {
+        LanguageMemory& lang = byLanguage[file->language];
+        lang.files++;
+        lang.source_bytes += file->bytes;
+        // The tree is built (and still alive) at the end of the parse phase.
+        lang.tree_bytes += file->memory[parse][TreeSitter].peak;
+        for (size_t p = 0; p < kPhaseCount; ++p) {
+            lang.cxx_allocations += file->memory[p][Cxx].allocations;
+            for (size_t h = 0; h < MemoryTracker::kHeapCount; ++h) merge(phases[p][h], file->memory[p][h]);
+        }
+    }
+
+    auto mb = [](uint64_t bytes) { return bytes / (1024.0 * 1024.0); };
+    auto cxxCell = [&](auto value, int width) {
+        if (haveCxx) {
+            os << std::setw(width) << value;
+        } else {
+            os << std::setw(width) << "n/a";
+        }
+    };
+
+    os << "=============== MEMORY PROFILE ===============\n";
+    os << "  Peak RSS: " << mb(MemoryTracker::peakResidentBytes()) << " MB, peak tree-sitter live: "
+       << mb(MemoryTracker::peakBytes()) << " MB\n";
+    if (!haveCxx) os << "  (C++ allocation hooks are only available in glibc builds.)\n";
+    os << "  (Peaks are the largest per-thread rise in live bytes during one phase.)\n\n";
+
+    os << "  " << std::left << std::setw(12) << "Phase" << std::right << std::setw(12) << "C++ allocs"
+       << std::setw(10) << "C++ MB" << std::setw(13) << "C++ peak KB" << std::setw(11) << "TS allocs"
+       << std::setw(9) << "TS MB" << std::setw(12) << "TS peak KB" << "\n";
+    for (size_t p = 0; p < kPhaseCount; ++p) {
+        const MemoryTracker::Usage* usage = phases[p];
+        os << "  " << std::left << std::setw(12) << phaseName(static_cast<Phase>(p)) << std::right;
+        cxxCell(usage[Cxx].allocations, 12);
+        cxxCell(mb(usage[Cxx].bytes), 10);
+        cxxCell(usage[Cxx].peak / 1024.0, 13);
+        os << std::setw(11) << usage[TreeSitter].allocations << std::setw(9) << mb(usage[TreeSitter].bytes)
+           << std::setw(12) << usage[TreeSitter].peak / 1024.0 << "\n";
+    }
+
+    os << "\n  " << std::left << std::setw(12) << "Language" << std::right << std::setw(7) << "Files"
+       << std::setw(12) << "Source KB" << std::setw(11) << "Tree KB" << std::setw(18) << "Tree B/source KB"
+       << std::setw(16) << "C++ allocs/file" << "\n";
+    for (const auto& [language, lang] : byLanguage) {
+        double sourceKb = lang.source_bytes / 1024.0;
+        os << "  " << std::left << std::setw(12) << language << std::right << std::setw(7) << lang.files
+           << std::setw(12) << sourceKb << std::setw(11) << lang.tree_bytes / 1024.0
+           << std::setw(18) << (sourceKb > 0 ? lang.tree_bytes / sourceKb : 0.0);
+        cxxCell(lang.files ? static_cast<double>(lang.cxx_allocations) / lang.files : 0.0, 16);
+        os << "\n";
+    }
+
+    size_t shown = std::min(topN, files.size());
+    std::partial_sort(files.begin(), files.begin() + shown, files.end(),
+                      [&](const FileRecord* a, const FileRecord* b) { return fileBytes(a) > fileBytes(b); });
+    os << "\n  Top " << shown << " allocating files:\n";
+    os << "  " << std::right << std::setw(10) << "Allocs" << std::setw(12) << "Alloc MB" << std::setw(11)
+       << "Tree KB" << std::setw(12) << "Bytes" << "  Path\n";
+    for (size_t i = 0; i < shown; ++i) {
+        const FileRecord& file = *files[i];
+        uint64_t allocations = 0;
+        for (size_t p = 0; p < kPhaseCount; ++p) {
+            for (size_t h = 0; h < MemoryTracker::kHeapCount; ++h) allocations += file.memory[p][h].allocations;
+        }
+        os << "  " << std::setw(10) << allocations << std::setw(12) << mb(fileBytes(&file))
+           << std::setw(11) << file.memory[parse][TreeSitter].peak / 1024.0 << std::setw(12) << file.bytes
+           << "  " << file.path << "\n";
+    }
+    os << std::left << "\n";
+}
+
+void printReport(std::ostream& os, size_t topN) {
+    if (!g_report.load(std::memory_order_relaxed)) return;
+    double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - g_start).count();
+
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    std::vector<const FileRecord*> files;
+    uint64_t phaseTotals[kPhaseCount] = {};
+    size_t totalBytes = 0;
+
+    struct LanguageTotals {
+        size_t files = 0;
+        size_t bytes = 0;
+        uint64_t phase_ns[kPhaseCount] = {};
+        uint64_t events[kPhaseCount][PerfCounters::kEventCount] = {};
+        uint64_t counters[kCounterCount] = {};
+    };
+    std::map<std::string, LanguageTotals> byLanguage;
+
+    for (const auto& buffer : g_buffers) {
+        for (size_t p = 0; p < kPhaseCount; ++p) phaseTotals[p] += buffer->unattributed_ns[p];
+        for (const auto& file : buffer->files) {
+            files.push_back(&file);
+            totalBytes += file.bytes;
+            LanguageTotals& lang = byLanguage[file.language];
+            lang.files++;
+            lang.bytes += file.bytes;
+            for (size_t p = 0; p < kPhaseCount; ++p) {
+                phaseTotals[p] += file.phase_ns[p];
+                lang.phase_ns[p] += file.phase_ns[p];
+                for (size_t e = 0; e < PerfCounters::kEventCount; ++e) lang.events[p][e] += file.events[p][e];
+            }
+            for (size_t c = 0; c < kCounterCount; ++c) lang.counters[c] += file.counters[c];
+        }
+    }
+
+    uint64_t grandTotal = 0;
+    for (uint64_t ns : phaseTotals) grandTotal += ns;
+
+    os << std::fixed << std::setprecision(2);
+    os << "=============== PERFORMANCE PROFILE ===============\n";
+    os << "  Wall time: " << wallMs << " ms, " << files.size() << " files, "
+       << totalBytes / (1024.0 * 1024.0) << " MB\n";
+    os << "  (Phase times are summed across worker threads.)\n\n";
+
+    os << "  " << std::left << std::setw(12) << "Phase" << std::right << std::setw(12) << "Time (ms)"
+       << std::setw(9) << "Share" << "\n";
+    for (size_t p = 0; p < kPhaseCount; ++p) {
+        double share = grandTotal ? phaseTotals[p] * 100.0 / grandTotal : 0.0;
+        os << "  " << std::left << std::setw(12) << phaseName(static_cast<Phase>(p)) << std::right
+           << std::setw(12) << toMs(phaseTotals[p]) << std::setw(8) << share << "%\n";
+    }
+
+    const size_t parse = static_cast<size_t>(Phase::Parse);
+    auto analyzeTime = [](const LanguageTotals& lang) {
+        return lang.phase_ns[static_cast<size_t>(Phase::Functions)] +
+               lang.phase_ns[static_cast<size_t>(Phase::FileWide)] +
+               lang.phase_ns[static_cast<size_t>(Phase::Naming)];
+    };
+    os << "\n  " << std::left << std::setw(12) << "Language" << std::right << std::setw(7) << "Files"
+       << std::setw(10) << "MB" << std::setw(11) << "Read ms" << std::setw(11) << "Parse ms"
+       << std::setw(12) << "Analyze ms" << std::setw(10) << "Score ms" << std::setw(12) << "Parse MB/s" << "\n";
+    for (const auto& [language, lang] : byLanguage) {
+        uint64_t analyzeNs = analyzeTime(lang);
+        double mb = lang.bytes / (1024.0 * 1024.0);
+        double parseSeconds = lang.phase_ns[parse] / 1e9;
+        os << "  " << std::left << std::setw(12) << language << std::right << std::setw(7) << lang.files
+           << std::setw(10) << mb
+           << std::setw(11) << toMs(lang.phase_ns[static_cast<size_t>(Phase::Read)])
+           << std::setw(11) << toMs(lang.phase_ns[parse])
+           << std::setw(12) << toMs(analyzeNs)
+           << std::setw(10) << toMs(lang.phase_ns[static_cast<size_t>(Phase::Score)])
+           << std::setw(12) << (parseSeconds > 0 ? mb / parseSeconds : 0.0) << "\n";
+    }
+
+    auto perUnit = [](uint64_t ns, uint64_t units) { return units ? static_cast<double>(ns) / units : 0.0; };
+    os << "\n  " << std::left << std::setw(12) << "Language" << std::right << std::setw(12) << "Tree nodes"
+       << std::setw(11) << "Functions" << std::setw(15) << "Parse ns/byte" << std::setw(17) << "Analyze ns/node"
+       << "\n";
+    for (const auto& [language, lang] : byLanguage) {
+        uint64_t analyzeNs = analyzeTime(lang);
+        uint64_t nodes = lang.counters[static_cast<size_t>(Counter::TreeNodes)];
+        os << "  " << std::left << std::setw(12) << language << std::right << std::setw(12) << nodes
+           << std::setw(11) << lang.counters[static_cast<size_t>(Counter::Functions)]
+           << std::setw(15) << perUnit(lang.phase_ns[parse], lang.counters[static_cast<size_t>(Counter::SourceBytes)])
+           << std::setw(17) << perUnit(analyzeNs, nodes) << "\n";
+    }
+
+    size_t shown = std::min(topN, files.size());
+    std::partial_sort(files.begin(), files.begin() + shown, files.end(),
+                      [](const FileRecord* a, const FileRecord* b) { return a->totalNs() > b->totalNs(); });
+    os << "\n  Top " << shown << " slowest files:\n";
+    os << "  " << std::right << std::setw(10) << "Total ms" << std::setw(10) << "Parse ms"
+       << std::setw(12) << "Bytes" << std::setw(10) << "Nodes" << std::setw(7) << "Depth" << "  Path\n";
+    for (size_t i = 0; i < shown; ++i) {
+        const FileRecord& file = *files[i];
+        os << "  " << std::setw(10) << toMs(file.totalNs()) << std::setw(10) << toMs(file.phase_ns[parse])
+           << std::setw(12) << file.bytes << std::setw(10) << file.node_count << std::setw(7) << file.max_depth
+           << "  " << file.path << "\n";
+    }
+    os << std::left << "\n";
+
+    if (PerfCounters::enabled()) {
+
+        auto perKb = [](uint64_t count, size_t bytes) { return bytes ? count * 1024.0 / bytes : 0.0; };
+        auto cell = [&os](bool available, double value, int width) {
+            if (available) {
+                os << std::setw(width) << value;
+            } else {
+                os << std::setw(width) << "n/a";
+            }
+        };
+        using PerfCounters::supported;
+        os << "=============== HARDWARE COUNTERS ===============\n";
+        os << "  (User-space events per thread; misses are normalized per KB of source.)\n\n";
+        os << "  " << std::left << std::setw(12) << "Language" << std::setw(11) << "Phase" << std::right
+           << std::setw(12) << "Mcycles" << std::setw(12) << "Minstr" << std::setw(7) << "IPC"
+           << std::setw(16) << "Cache-miss/KB" << std::setw(17) << "Branch-miss/KB" << "\n";
+        for (const auto& [language, lang] : byLanguage) {
+            for (Phase phase : {Phase::Parse, Phase::Functions, Phase::FileWide, Phase::Naming, Phase::Score}) {
+                const uint64_t* events = lang.events[static_cast<size_t>(phase)];
+                uint64_t cycles = events[PerfCounters::Cycles];
+                uint64_t instructions = events[PerfCounters::Instructions];
+                os << "  " << std::left << std::setw(12) << language << std::setw(11) << phaseName(phase) << std::right;
+                os << std::setw(12) << cycles / 1e6;
+                cell(supported(PerfCounters::Instructions), instructions / 1e6, 12);
+                cell(supported(PerfCounters::Instructions) && cycles > 0,
+                     cycles ? static_cast<double>(instructions) / cycles : 0.0, 7);
+                cell(supported(PerfCounters::CacheMisses), perKb(events[PerfCounters::CacheMisses], lang.bytes), 16);
+                cell(supported(PerfCounters::BranchMisses), perKb(events[PerfCounters::BranchMisses], lang.bytes), 17);
+                os << "\n";
+            }
+        }
+        os << std::left << "\n";
+    }
+    if (memoryProfiling()) printMemoryReport(os, files, topN);
+}
+
+void phaseTotals(uint64_t (&ns)[kPhaseCount]) {
+    std::fill(std::begin(ns), std::end(ns), 0);
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (const auto& buffer : g_buffers) {
+        for (size_t p = 0; p < kPhaseCount; ++p) ns[p] += buffer->unattributed_ns[p];
+        for (const auto& file : buffer->files) {
+            for (size_t p = 0; p < kPhaseCount; ++p) ns[p] += file.phase_ns[p];
+        }
+    }
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (const auto& buffer : g_buffers) {
+        buffer->files.clear();
+        buffer->first_file = 0;
+        buffer->in_file = false;
+        std::fill(std::begin(buffer->unattributed_ns), std::end(buffer->unattributed_ns), 0);
+        std::fill(std::begin(buffer->unattributed_counters), std::end(buffer->unattributed_counters), 0);
+        for (auto& phase : buffer->unattributed_memory) std::fill(std::begin(phase), std::end(phase), MemoryTracker::Usage());
+        buffer->ring.clear();
+        buffer->ring_next = 0;
+        buffer->dropped = 0;
+        // Only the current (or last) holder can record from now on.
+        if (!buffer->owners.empty()) buffer->owners.erase(buffer->owners.begin(), buffer->owners.end() - 1);
+    }
+    g_start = Clock::now();
+}
+
+bool writeTrace(const std::string& path) {
+    if (!tracing()) return true;
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) std::fputs(",\n", out);
+        first = false;
+    };
+    size_t dropped = 0;
+    for (const auto& buffer : g_buffers) {
+        dropped += buffer->dropped;
+        for (const TraceThread& owner : buffer->owners) {
+            separator();
+            std::fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                         owner.tid);
+            writeJsonString(out, owner.name.empty() ? "thread " + std::to_string(owner.tid) : owner.name);
+            std::fputs("}}", out);
+        }
+
+        for (const TraceEvent& event : buffer->ring) {
+            separator();
+            const FileRecord* file = event.file != kNoFile ? &buffer->files[event.file - buffer->first_file] : nullptr;
+            const char* name = event.kind == kFileSpan ? "file" : phaseName(static_cast<Phase>(event.kind));
+            std::fprintf(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                              "\"ts\":%.3f,\"dur\":%.3f",
+                         name, file ? file->language.c_str() : "run", buffer->owners[event.owner].tid,
+                         event.start_ns / 1e3, event.duration_ns / 1e3);
+            if (file) {
+                std::fputs(",\"args\":{\"path\":", out);
+                writeJsonString(out, file->path);
+                std::fprintf(out, ",\"bytes\":%zu", file->bytes);
+                if (event.kind == kFileSpan) {
+                    for (size_t c = 0; c < kCounterCount; ++c) {
+                        std::fprintf(out, ",\"%s\":%llu", counterName(static_cast<Counter>(c)),
+                                     static_cast<unsigned long long>(file->counters[c]));
+                    }
+                }
+                std::fputc('}', out);
+            }
+            std::fputc('}', out);
+        }
+    }
+    std::fprintf(out, "\n],\"otherData\":{\"dropped_events\":%zu}}\n", dropped);
+    return std::fclose(out) == 0;
+}
+
+} // namespace Profiler
@@ -0,0 +1,196 @@
+/**
+ * @file Profiler.h
+ * @brief Lightweight per-phase, per-file timing for `--profile` runs.
+ *
+ * Each worker thread owns a private buffer of file records, so recording a phase
+ * costs two monotonic clock reads and an add, with no locking. Buffers are only
+ * merged when the end-of-run report is printed. When profiling is disabled, every
+ * scope reduces to a single flag check.
+ *
+ * If hardware counters were enabled (see PerfCounters.h), each phase scope also
+ * records the cycle, instruction, cache-miss and branch-miss deltas of its thread.
+ *
+ * With `--mem-profile`, each phase scope opens a MemoryTracker window and charges
+ * the allocation counts, bytes and peak growth of both heaps to the phase and file.
+ *
+ * With `--trace`, the same scopes also append spans to a fixed-size per-thread
+ * ring buffer, which is written out at exit in Chrome trace-event format
+ * (viewable in chrome://tracing or Perfetto). When tracing without the report,
+ * a file record is dropped once no span in the ring refers to it, so memory
+ * stays bounded however many files are analyzed.
+ *
+ * Instrumented code does not use these classes directly but the macros in
+ * Trace.h, which can compile every hook out of the build.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "LanguageRegistry.h"
+#include "MemoryTracker.h"
+#include "PerfCounters.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace Profiler {
+
+    /**
+     * @enum Phase
+     * @brief The pipeline stages that are timed individually.
+     */
+    enum class Phase : uint8_t {
+        Walk,      ///< Directory traversal (run-level, not attributed to a file).
+        Read,      ///< Loading the source file into memory.
+        Parse,     ///< tree-sitter parsing.
+        Functions, ///< Analyzer pass: function discovery, length and complexity.
+        FileWide,  ///< Analyzer pass: line and comment counting.
+        Naming,    ///< Analyzer pass: identifier naming checks.
+        Score,     ///< Final score calculation.
+        Report,    ///< Printing the report (run-level).
+        Wait,      ///< A worker waiting for the governor to admit the next file.
+        Count
+    };
+
+    constexpr size_t kPhaseCount = static_cast<size_t>(Phase::Count);
+
+    /**
+     * @enum Counter
+     * @brief Work counts attributed to the current file, used to normalize phase times.
+     */
+    enum class Counter : uint8_t {
+        SourceBytes, ///< Bytes handed to the parser.
+        TreeNodes,   ///< Syntax tree nodes in the parsed file.
+        Functions,   ///< Functions found and measured.
+        Count
+    };
+
+    constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+
+    const char* phaseName(Phase phase);
+    const char* counterName(Counter counter);
+
+    namespace detail {
+        extern std::atomic<bool> active;
+        void addCount(Counter counter, uint64_t amount);
+    } // namespace detail
+
+    /// Turns the timing report on. Must be called before any worker thread starts.
+    void enable();
+
+    /// @return True if any instrumentation (timing report or trace) is active.
+    inline bool enabled() { return detail::active.load(std::memory_order_relaxed); }
+
+    /// Adds to a counter of the file open on this thread (or of the run, outside any file).
+    inline void count(Counter counter, uint64_t amount) {
+        if (enabled()) detail::addCount(counter, amount);
+    }
+
+    /**
+     * @brief Turns trace-event recording on. Must be called before any worker thread starts.
+     * @param eventsPerThread Ring buffer capacity; the oldest spans are overwritten when full.
+     */
+    void enableTrace(size_t eventsPerThread);
+    bool tracing();
+
+    /**
+     * @brief Turns per-phase allocation accounting on (implies the timing report).
+     * Must be called before any worker thread starts.
+     */
+    void enableMemory();
+    bool memoryProfiling();
+
+    /// Names the calling thread in the trace timeline (e.g. "main", "worker 3").
+    void setThreadName(const std::string& name);
+
+    /**
+     * @class FileScope
+     * @brief Opens a file record on the calling thread for the duration of the scope.
+     * Phase timings recorded on this thread while the scope is alive are attributed to the file.
+     */
+    class FileScope {
+    public:
+        FileScope(const std::string& path, Language language) : active(enabled()) {
+            if (active) begin(path, language);
+        }
+        ~FileScope() {
+            if (active) end();
+        }
+        FileScope(const FileScope&) = delete;
+        FileScope& operator=(const FileScope&) = delete;
+
+        void setSourceBytes(size_t bytes);
+        void setTreeShape(int nodeCount, int maxDepth);
+
+    private:
+        bool active;
+        std::chrono::steady_clock::time_point start;
+
+        void begin(const std::string& path, Language language);
+        void end();
+    };
+
+    /**
+     * @class PhaseScope
+     * @brief Times the enclosing block and charges it to the given phase.
+     */
+    class PhaseScope {
+    public:
+        explicit PhaseScope(Phase phase) : phase(phase), active(enabled()) {
+            if (active) begin();
+        }
+        ~PhaseScope() {
+            if (active) end();
+        }
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+
+    private:
+        Phase phase;
+        bool active;
+        bool counting = false;
+        bool measuring = false;
+        std::chrono::steady_clock::time_point start;
+        PerfCounters::Sample startCounters;
+        MemoryTracker::Window memoryWindow;
+
+        void begin();
+        void end();
+    };
+
+    /**
+     * @brief Prints the phase breakdown, per-language table and slowest files, followed
+     * by per-language hardware counter ratios and the memory profile when collected.
+     * @param os Destination stream.
+     * @param topN Number of slowest files to list.
+     */
+    void printReport(std::ostream& os, size_t topN);
+
+    /**
+     * @brief Sums the time recorded so far for each phase, across all threads.
+     * Used by the benchmarks, which take the difference around each measured run.
+     * @param ns Receives nanoseconds per phase.
+     */
+    void phaseTotals(uint64_t (&ns)[kPhaseCount]);
+
+    /**
+     * @brief Discards everything recorded so far and restarts the wall clock, so each
+     * `--watch` run is reported on its own. No thread may be inside a scope.
+     */
+    void reset();
+
+    /**
+     * @brief Writes all buffered spans to a Chrome trace-event JSON file.
+     * @return False if the file could not be written.
+     */
+    bool writeTrace(const std::string& path);
+
+} // namespace Profiler
+
+#endif // PROFILER_H
@@ -0,0 +1,343 @@
+// src/RemoteCache.cpp
+#include "RemoteCache.h"
+#include "LanguageDescriptor.h"
+#include "Sha256.h"
+#include <tree_sitter/api.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    /// Bump whenever the encoding changes, so old entries stop matching.
+    constexpr const char* kResultFormat = "cqa-result 1";
+
+    // A hash of the sources that determine a file's metrics (reading, analyzer, strategies, grammars),
+    // set by CMake, so a build whose results may differ never reads another build's entries.
+    // Builds outside CMake are only trusted to match themselves.
+#if defined(CQA_BUILD_IDENTITY)
+    constexpr const char* kBuildIdentity = CQA_BUILD_IDENTITY;
+#else
+    constexpr const char* kBuildIdentity = "unconfigured " __DATE__ " " __TIME__;
+#endif
+
+    bool readFile(const std::string& filePath, std::string& out) {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) return false;
+        out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !file.bad();
+    }
+
+    /**
+     * Text, one record per line, doubles printed to round-trip exactly:
+     *     cqa-result 1
+     *     <total lines> <comment lines> <naming violations> <nodes> <max depth> <functions>
+     *     <avg length> <avg complexity> <comment coverage> <smi>
+     *     <line start> <line count> <complexity> <name bytes> <name>     (once per function)
+     */
+    std::string encode(const FileMetrics& metrics) {
+        std::string out = kResultFormat;
+        char line[160];
+        std::snprintf(line, sizeof(line), "\n%d %d %d %d %d %zu\n%.17g %.17g %.17g %.17g\n", metrics.total_lines,
+                      metrics.comment_lines, metrics.naming_violations, metrics.node_count, metrics.max_depth,
+                      metrics.functions.size(), metrics.avg_function_length, metrics.avg_function_complexity,
+                      metrics.comment_coverage_ratio, metrics.shit_mountain_index);
+        out += line;
+        for (FunctionView function : metrics.functions) {
+            std::snprintf(line, sizeof(line), "%d %d %d %zu ", function.line_start, function.line_count,
+                          function.complexity, function.name.size());
+            out += line;
+            out.append(function.name.data(), function.name.size());
+            out += '\n';
+        }
+        return out;
+    }
+
+    /// Reads encode()'s output back. False for anything malformed, which is then treated as a miss.
+    bool decode(const std::string& value, FileMetrics& metrics) {
+        if (value.compare(0, std::char_traits<char>::length(kResultFormat), kResultFormat) != 0) return false;
+        const char* cursor = value.c_str() + std::char_traits<char>::length(kResultFormat);
+        const char* end = value.c_str() + value.size();
+        bool ok = true;
+        auto integer = [&]() {
+            char* next = nullptr;
+            long long number = std::strtoll(cursor, &next, 10);
+            ok = ok && next != cursor;
+            cursor = next;
+            return number;
+        };
+        auto real = [&]() {
+            char* next = nullptr;
+            double number = std::strtod(cursor, &next);
+            ok = ok && next != cursor;
+            cursor = next;
+            return number;
+        };
+
+        metrics.total_lines = static_cast<int>(integer());
+        metrics.comment_lines = static_cast<int>(integer());
+        metrics.naming_violations = static_cast<int>(integer());
+        metrics.node_count = static_cast<int>(integer());
+        metrics.max_depth = static_cast<int>(integer());
+        long long functions = integer();
+        metrics.avg_function_length = real();
+        metrics.avg_function_complexity = real();
+        metrics.comment_coverage_ratio = real();
+        metrics.shit_mountain_index = real();
+        if (!ok || functions < 0 || functions > static_cast<long long>(value.size())) return false;
+
+        metrics.functions.clear();
+        for (long long i = 0; i < functions; ++i) {
+            int lineStart = static_cast<int>(integer());
+            int lineCount = static_cast<int>(integer());
+            int complexity = static_cast<int>(integer());
+            long long nameBytes = integer();
+            // One space separates the length from the name, which may itself contain spaces.
+            if (!ok || nameBytes < 0 || *cursor != ' ' || end - cursor - 1 < nameBytes) return false;
+            ++cursor;
+            metrics.functions.append(std::string_view(cursor, static_cast<size_t>(nameBytes)), lineStart,
+                                     lineStart + lineCount - 1, complexity);
+            cursor += nameBytes;
+        }
+        return true;
+    }
+
+} // namespace
+
+RemoteCache::~RemoteCache() {
+    {
+        std::lock_guard<LockStats::Mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (lookupThread.joinable()) lookupThread.join();
+    if (uploadThread.joinable()) uploadThread.join();
+}
+
+bool RemoteCache::open(const std::string& url, std::string& error) {
+    if (!client.open(url, error)) return false;
+    lookupThread = std::thread(&RemoteCache::lookupLoop, this);
+    uploadThread = std::thread(&RemoteCache::uploadLoop, this);
+    return true;
+}
+
+std::string RemoteCache::key(Language language, std::string_view source) {
+    // The runtime's ABI and the grammar's, in case either was swapped without the sources changing.
+    const TSLanguage* grammar = LanguageRegistry::grammar(language);
+    char versions[32];
+    std::snprintf(versions, sizeof(versions), "%u %u", static_cast<unsigned>(TREE_SITTER_LANGUAGE_VERSION),
+                  grammar ? static_cast<unsigned>(ts_language_version(grammar)) : 0u);
+
+    Sha256 hasher;
+    hasher.update(kResultFormat);
+    hasher.update(std::string_view("\0", 1));
+    hasher.update(kBuildIdentity);
+    hasher.update(std::string_view("\0", 1));
+    hasher.update(versions);
+    hasher.update(std::string_view("\0", 1));
+    hasher.update(LanguageRegistry::name(language));
+    hasher.update(std::string_view("\0", 1));
+    hasher.update(LanguageDescriptors::fingerprint(language));
+    hasher.update(std::string_view("\0", 1));
+    hasher.update(source);
+    return hasher.hexDigest();
+}
+
+void RemoteCache::beginRun() {
+    std::lock_guard<LockStats::Mutex> lock(mutex);
+    ++run;
+    lookups.clear();
+    slots.clear();
+    failed = false;
+    counters = Stats();
+}
+
+void RemoteCache::prefetch(PathId path, Language language) {
+    {
+        std::lock_guard<LockStats::Mutex> lock(mutex);
+        if (failed) return;
+        Slot& slot = slots[path];
+        slot.language = language;
+        lookups.push_back(path);
+    }
+    changed.notify_all();
+}
+
+bool RemoteCache::take(PathId path, FileMetrics& metrics) {
+    std::string value;
+    {
+        std::unique_lock<LockStats::Mutex> lock(mutex);
+        auto it = slots.find(path);
+        if (it == slots.end()) return false;
+        // A reference, not the iterator: prefetch() may rehash the map while this waits.
+        Slot& slot = it->second;
+        if (slot.state == State::Queued) {
+            // The lookup would cost more than it could save now that a worker is free for the file.
+            slot.state = State::Claimed;
+            ++counters.unchecked;
+            return false;
+        }
+        if (!changed.wait_until(lock, slot.deadline, [&] { return slot.state != State::InFlight; })) {
+            // Too slow to be worth waiting for; the answer is dropped when it arrives.
+            slot.state = State::Claimed;
+            ++counters.unchecked;
+            return false;
+        }
+        if (slot.state != State::Hit) return false;
+        value = std::move(slot.value);
+        slots.erase(path);
+    }
+    if (!decode(value, metrics)) {
+        std::lock_guard<LockStats::Mutex> lock(mutex);
+        --counters.hits;
+        ++counters.misses;
+        return false;
+    }
+    metrics.path = path;
+    return true;
+}
+
+void RemoteCache::store(Language language, std::string_view source, const FileMetrics& metrics) {
+    std::string entry = key(language, source);
+    std::string value = encode(metrics);
+    {
+        std::lock_guard<LockStats::Mutex> lock(mutex);
+        if (failed) return;
+        uploads.emplace_back(std::move(entry), std::move(value));
+    }
+    changed.notify_all();
+}
+
+void RemoteCache::finishRun() {
+    std::unique_lock<LockStats::Mutex> lock(mutex);
+    changed.wait(lock, [&] { return (uploads.empty() && uploadsInFlight == 0) || failed; });
+    // Lookups nobody took (files skipped by a budget, for instance) are not worth finishing.
+    lookups.clear();
+    slots.clear();
+}
+
+RemoteCache::Stats RemoteCache::stats() const {
+    std::lock_guard<LockStats::Mutex> lock(mutex);
+    return counters;
+}
+
+void RemoteCache::fail(const std::string& error) {
+    if (failed) return;
+    failed = true;
+    counters.failed = true;
+    lookups.clear();
+    uploads.clear();
+    // Workers waiting on a lookup analyze locally; queued files are claimed as they are reached.
+    for (auto& [path, slot] : slots) {
+        if (slot.state == State::InFlight) slot.state = State::Miss;
+    }
+    std::cerr << "\n[Warning] Remote cache unavailable for this run, analyzing locally: " << error << std::endl;
+}
+
+void RemoteCache::lookupLoop() {
+    std::vector<PathId> batch;
+    std::vector<Language> languages;
+    std::vector<HttpRequest> requests;
+    std::vector<HttpResponse> responses;
+    std::string filePath;
+    std::string source;
+    for (;;) {
+        uint64_t batchRun;
+        batch.clear();
+        languages.clear();
+        {
+            std::unique_lock<LockStats::Mutex> lock(mutex);
+            changed.wait(lock, [&] { return stopping || !lookups.empty(); });
+            if (stopping) return;
+            batchRun = run;
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + kLookupDeadline;
+            while (!lookups.empty() && batch.size() < kBatchSize) {
+                PathId path = lookups.front();
+                lookups.pop_front();
+                auto it = slots.find(path);
+                if (it == slots.end() || it->second.state != State::Queued) continue;
+                it->second.state = State::InFlight;
+                it->second.deadline = deadline;
+                batch.push_back(path);
+                languages.push_back(it->second.language);
+            }
+        }
+        if (batch.empty()) continue;
+
+        requests.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            filePath.clear();
+            PathTable::global().appendPath(batch[i], filePath);
+            // An unreadable file gets a key that matches nothing; the worker reports it.
+            if (!readFile(filePath, source)) source.clear();
+            requests[i].method = "GET";
+            requests[i].path = "/ac/" + key(languages[i], source);
+        }
+        std::string error;
+        bool exchanged = client.exchange(requests, responses, error);
+
+        {
+            std::lock_guard<LockStats::Mutex> lock(mutex);
+            if (batchRun == run) {
+                if (!exchanged) fail(error);
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    auto it = slots.find(batch[i]);
+                    if (it == slots.end() || it->second.state != State::InFlight) continue;
+                    if (i < responses.size() && responses[i].status == 200) {
+                        it->second.state = State::Hit;
+                        it->second.value = std::move(responses[i].body);
+                        ++counters.hits;
+                    } else {
+                        it->second.state = State::Miss;
+                        ++counters.misses;
+                    }
+                }
+            }
+        }
+        changed.notify_all();
+    }
+}
+
+void RemoteCache::uploadLoop() {
+    std::vector<HttpRequest> requests;
+    std::vector<HttpResponse> responses;
+    for (;;) {
+        uint64_t batchRun;
+        requests.clear();
+        {
+            std::unique_lock<LockStats::Mutex> lock(mutex);
+            changed.wait(lock, [&] { return stopping || !uploads.empty(); });
+            if (stopping) return;
+            batchRun = run;
+            while (!uploads.empty() && requests.size() < kBatchSize) {
+                HttpRequest request;
+                request.method = "PUT";
+                request.path = "/ac/" + uploads.front().first;
+                request.headers["Content-Type"] = "application/octet-stream";
+                request.body = std::move(uploads.front().second);
+                requests.push_back(std::move(request));
+                uploads.pop_front();
+            }
+            uploadsInFlight = requests.size();
+        }
+
+        std::string error;
+        bool exchanged = client.exchange(requests, responses, error);
+
+        {
+            std::lock_guard<LockStats::Mutex> lock(mutex);
+            uploadsInFlight = 0;
+            if (batchRun == run) {
+                if (!exchanged) fail(error);
+                for (const HttpResponse& response : responses) {
+                    if (response.status / 100 == 2) ++counters.uploads;
+                }
+            }
+        }
+        changed.notify_all();
+    }
+}
@@ -0,0 +1,133 @@
+/**
+ * @file RemoteCache.h
+ * @brief A shared, content-addressed cache of analysis results over plain HTTP.
+ *
+ * CI runners are ephemeral, so a cache on local disk always starts cold. The
+ * remote cache lets a run reuse results that any earlier run computed, on any
+ * machine. An entry lives at `<url>/ac/<key>`. The key is the SHA-256 of the
+ * result format, the build identity (a hash of the analysis and grammar
+ * sources, computed by CMake), the tree-sitter runtime and grammar ABI versions,
+ * the file's language (with its descriptor, for descriptor languages) and the
+ * file's contents. A build that could score a file differently therefore never
+ * reuses another's results. Paths are not part of the key, so a moved or copied
+ * file still hits. The protocol is that of Bazel's HTTP remote cache:
+ * GET fetches an entry (404 is a miss) and PUT stores one. bazel-remote, nginx
+ * with WebDAV, or the bundled `cqa-cache-server` can all serve it.
+ *
+ * During a run, the walk hands every file to prefetch(). A lookup thread reads
+ * and hashes the files in that order and fetches them in batches of pipelined
+ * GETs while the workers analyze. A worker that reaches a file calls take():
+ *  - a fetched result is used instead of parsing;
+ *  - a lookup in flight is waited for, up to kLookupDeadline after its batch was sent;
+ *  - a lookup that has not started, or that missed the deadline, is abandoned, and
+ *    the file is analyzed locally.
+ * Results computed locally go to an upload thread, which PUTs them in batches.
+ * That includes abandoned lookups, whose entries the server may already hold; a
+ * repeated PUT stores the same bytes again, and saves a GET before the upload.
+ *
+ * The cache is best effort. After a network error it is off for the rest of the
+ * run, with a warning, and every remaining file is analyzed locally.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef REMOTE_CACHE_H
+#define REMOTE_CACHE_H
+
+#include "HttpClient.h"
+#include "LanguageRegistry.h"
+#include "LockStats.h"
+#include "Metrics.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+class RemoteCache {
+public:
+    /// Requests per pipelined batch.
+    static constexpr size_t kBatchSize = 64;
+    /// How long after a batch is sent workers wait for its answers, however the server trickles them.
+    static constexpr std::chrono::milliseconds kLookupDeadline{2000};
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;    ///< Looked up and not found.
+        size_t unchecked = 0; ///< Reached by a worker before its lookup started or answered in time.
+        size_t uploads = 0;   ///< Results stored after a miss or an abandoned lookup.
+        bool failed = false;  ///< A network error turned the cache off for the rest of the run.
+    };
+
+    RemoteCache() = default;
+    ~RemoteCache();
+    RemoteCache(const RemoteCache&) = delete;
+    RemoteCache& operator=(const RemoteCache&) = delete;
+
+    /**
+     * @brief Sets the server and starts the lookup and upload threads.
+     * Nothing is sent until the first run.
+     */
+    bool open(const std::string& url, std::string& error);
+
+    /// Starts a run: forgets the previous run's lookups and turns the cache back on after a failure.
+    void beginRun();
+
+    /// Queues a file for lookup. Called by the walk, in the order the files will be analyzed.
+    void prefetch(PathId path, Language language);
+
+    /**
+     * @brief Claims a file's lookup for a worker that is about to analyze it.
+     * @return True if its result was fetched; `metrics` then holds it.
+     */
+    bool take(PathId path, FileMetrics& metrics);
+
+    /// Queues a result that was analyzed locally for upload. `source` is the file's contents.
+    void store(Language language, std::string_view source, const FileMetrics& metrics);
+
+    /// Waits until every queued upload has been sent, and ends the run.
+    void finishRun();
+
+    /// @return The statistics of the current or last run.
+    Stats stats() const;
+
+    /// @return The cache key: 64 hex digits.
+    static std::string key(Language language, std::string_view source);
+
+private:
+    enum class State : uint8_t { Queued, InFlight, Hit, Miss, Claimed };
+
+    struct Slot {
+        Language language = Language::Unsupported;
+        State state = State::Queued;
+        std::chrono::steady_clock::time_point deadline; ///< Set when the lookup is sent.
+        std::string value; ///< The encoded result, once fetched.
+    };
+
+    HttpClient client; ///< Set up by open(); both threads share it and its kept-alive connections.
+    mutable LockStats::Mutex mutex{"remote cache"};
+    std::condition_variable_any changed;
+    std::deque<PathId> lookups;
+    std::unordered_map<PathId, Slot> slots;
+    std::deque<std::pair<std::string, std::string>> uploads; ///< (key, encoded result)
+    size_t uploadsInFlight = 0;
+    uint64_t run = 0; ///< Lookups from an earlier run are discarded when they return.
+    bool failed = false;
+    bool stopping = false;
+    Stats counters;
+    std::thread lookupThread;
+    std::thread uploadThread;
+
+    void lookupLoop();
+    void uploadLoop();
+
+    /// Turns the cache off for the rest of the run. Call with the mutex held.
+    void fail(const std::string& error);
+};
+
+#endif // REMOTE_CACHE_H
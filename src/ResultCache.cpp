@@ -0,0 +1,110 @@
+// src/ResultCache.cpp
+#include "ResultCache.h"
+#include "Json.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+    constexpr int kVersion = 1;
+
+    void writeJsonString(std::FILE* out, const std::string& value) {
+        std::fputc('"', out);
+        for (unsigned char c : value) {
+            if (c == '"' || c == '\\') {
+                std::fputc('\\', out);
+                std::fputc(c, out);
+            } else if (c < 0x20) {
+                std::fprintf(out, "\\u%04x", c);
+            } else {
+                std::fputc(c, out);
+            }
+        }
+        std::fputc('"', out);
+    }
+
+} // namespace
+
+bool ResultCache::load(const std::string& path, std::string& error) {
+    entries.clear();
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) return true;
+
+    Json::Value document;
+    if (!Json::parseFile(path, document, error)) return false;
+    if (document.numberOr("version", 0) != kVersion) {
+        // An older or newer format only costs one run's ordering; start over.
+        return true;
+    }
+    const Json::Value* files = document.find("files");
+    if (!files || files->type != Json::Type::Array) {
+        error = "missing \"files\" array";
+        return false;
+    }
+    for (const Json::Value& file : files->array) {
+        std::string filePath = file.stringOr("path", "");
+        if (filePath.empty()) continue;
+        Entry entry;
+        entry.language = file.stringOr("language", "");
+        entry.bytes = static_cast<uint64_t>(std::max(0.0, file.numberOr("bytes", 0)));
+        entry.smi = file.numberOr("smi", 0);
+        entries[filePath] = std::move(entry);
+    }
+    return true;
+}
+
+bool ResultCache::save(const std::string& path) const {
+    std::string temporary = path + ".tmp";
+    std::FILE* out = std::fopen(temporary.c_str(), "w");
+    if (!out) return false;
+
+    // Sorted, so the file diffs cleanly when it is checked in or cached by CI.
+    std::vector<const std::pair<const std::string, Entry>*> sorted;
+    sorted.reserve(entries.size());
+    for (const auto& entry : entries) sorted.push_back(&entry);
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    std::fprintf(out, "{\"version\": %d, \"files\": [\n", kVersion);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const auto& [filePath, entry] = *sorted[i];
+        std::fputs("  {\"path\": ", out);
+        writeJsonString(out, filePath);
+        std::fputs(", \"language\": ", out);
+        writeJsonString(out, entry.language);
+        std::fprintf(out, ", \"bytes\": %llu, \"smi\": %.3f}%s\n", static_cast<unsigned long long>(entry.bytes),
+                     entry.smi, i + 1 < sorted.size() ? "," : "");
+    }
+    std::fputs("]}\n", out);
+    bool written = std::fclose(out) == 0;
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+const ResultCache::Entry* ResultCache::find(std::string_view filePath) const {
+    auto it = entries.find(std::string(filePath));
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+void ResultCache::record(std::string_view filePath, Language language, uint64_t bytes, double smi) {
+    Entry& entry = entries[std::string(filePath)];
+    entry.language = LanguageRegistry::name(language);
+    entry.bytes = bytes;
+    entry.smi = smi;
+}
+
+std::unordered_map<std::string, double> ResultCache::languageMeans() const {
+    std::unordered_map<std::string, std::pair<double, size_t>> totals;
+    for (const auto& [filePath, entry] : entries) {
+        auto& [sum, count] = totals[entry.language];
+        sum += entry.smi;
+        ++count;
+    }
+    std::unordered_map<std::string, double> means;
+    for (const auto& [language, total] : totals) means[language] = total.first / total.second;
+    return means;
+}
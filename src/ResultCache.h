@@ -0,0 +1,58 @@
+/**
+ * @file ResultCache.h
+ * @brief Scores of earlier runs, kept in a file between runs.
+ *
+ * The cache maps a file's path, as the walk reported it, to the Shit Mountain
+ * Index and size it had when it was last analyzed. `--budget` runs use it to
+ * analyze the files most likely to rank worst first. Every run given `--cache`
+ * updates it, so a full nightly run keeps the estimates for budgeted CI runs
+ * fresh. Files a budgeted run skipped keep their old entries.
+ *
+ * The file is JSON:
+ * `{"version": 1, "files": [{"path": "src/a.cpp", "language": "cpp", "bytes": 1234, "smi": 41.5}, ...]}`.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "LanguageRegistry.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class ResultCache {
+public:
+    struct Entry {
+        std::string language; ///< By name, so ids of descriptor languages may change between runs.
+        uint64_t bytes = 0;
+        double smi = 0.0;
+    };
+
+    /**
+     * @brief Reads a cache file. A missing file is an empty cache, not an error.
+     * @return False if the file exists but cannot be parsed.
+     */
+    bool load(const std::string& path, std::string& error);
+
+    /// Writes the cache next to `path` and renames it into place.
+    bool save(const std::string& path) const;
+
+    /// @return The file's last recorded score, or null.
+    const Entry* find(std::string_view filePath) const;
+
+    void record(std::string_view filePath, Language language, uint64_t bytes, double smi);
+
+    /// The mean score of each language's cached files, by language name: the prior for files the cache has not seen.
+    std::unordered_map<std::string, double> languageMeans() const;
+
+    size_t size() const { return entries.size(); }
+
+private:
+    std::unordered_map<std::string, Entry> entries;
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,46 @@
+/**
+ * @file Sha256.h
+ * @brief SHA-256 (FIPS 180-4), for content-addressed cache keys.
+ *
+ * Remote caches in the Bazel style name entries by the SHA-256 of their inputs,
+ * so keys computed here interoperate with any such server. Not constant-time;
+ * it hashes public source files, not secrets.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Sha256 {
+public:
+    Sha256();
+
+    /// Hashes more input; may be called any number of times before hexDigest().
+    void update(std::string_view data);
+
+    /// Finishes the hash and returns it as 64 lower-case hex digits. The hasher is then spent.
+    std::string hexDigest();
+
+    static std::string hex(std::string_view data) {
+        Sha256 hasher;
+        hasher.update(data);
+        return hasher.hexDigest();
+    }
+
+private:
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t blockSize = 0;
+    uint64_t totalBytes = 0;
+
+    void compress(const uint8_t* chunk);
+};
+
+#endif // SHA256_H
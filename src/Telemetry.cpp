@@ -0,0 +1,251 @@
+// src/Telemetry.cpp
+#include "Telemetry.h"
+#include "Histogram.h"
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kStageCount = static_cast<size_t>(Telemetry::Stage::Count);
+constexpr size_t kCounterCount = static_cast<size_t>(Telemetry::Counter::Count);
+constexpr size_t kSkipCount = static_cast<size_t>(Telemetry::SkipReason::Count);
+
+// Exported bucket boundaries in seconds; the HDR histograms keep far finer resolution.
+const double kBucketBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+                                0.05,   0.1,     0.25,   0.5,   1.0,    2.5,   5.0,  10.0, 30.0, 60.0};
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+const char* const kStageMetric[kStageCount] = {"cqa_parse_duration_seconds", "cqa_analyze_duration_seconds"};
+const char* const kStageQuantileMetric[kStageCount] = {"cqa_parse_duration_quantile_seconds",
+                                                       "cqa_analyze_duration_quantile_seconds"};
+const char* const kStageHelp[kStageCount] = {"Time spent parsing one file.",
+                                             "Time spent analyzing and scoring one parsed file."};
+const char* const kCounterMetric[kCounterCount] = {"cqa_files_analyzed_total", "cqa_source_bytes_total",
+                                                   "cqa_parse_errors_total", "cqa_remote_cache_hits_total"};
+const char* const kCounterHelp[kCounterCount] = {"Files analyzed successfully.", "Source bytes analyzed.",
+                                                 "Files that failed to parse or parsed with syntax errors.",
+                                                 "Files whose results came from the remote cache instead of analysis."};
+const char* const kSkipLabel[kSkipCount] = {"unsupported", "unreadable", "budget"};
+
+/**
+ * @struct LanguageSlot
+ * @brief One thread's recordings for one language. Written only by the owning thread.
+ */
+struct LanguageSlot {
+    Histogram stages[kStageCount]; // in microseconds
+    std::atomic<uint64_t> counters[kCounterCount] = {};
+};
+
+struct ThreadRecorder {
+    std::array<std::atomic<LanguageSlot*>, LanguageRegistry::kMaxLanguages> slots = {}; // indexed by Language
+    std::vector<std::unique_ptr<LanguageSlot>> owned;
+    std::atomic<uint64_t> skips[kSkipCount] = {};
+};
+
+std::atomic<bool> g_enabled{false};
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<ThreadRecorder>> g_recorders;
+std::vector<ThreadRecorder*> g_idleRecorders;
+
+/**
+ * @brief Hands the thread's recorder back when the thread exits, so `--watch`
+ * runs that start fresh workers reuse recorders instead of growing the registry.
+ */
+struct RecorderLease {
+    ThreadRecorder* recorder = nullptr;
+    ~RecorderLease() {
+        if (!recorder) return;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_idleRecorders.push_back(recorder);
+    }
+};
+thread_local RecorderLease t_lease;
+
+std::mutex g_runMutex;
+uint64_t g_runs = 0;
+double g_lastRunSeconds = 0.0;
+double g_lastRunTimestamp = 0.0;
+
+ThreadRecorder& localRecorder() {
+    if (!t_lease.recorder) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        if (!g_idleRecorders.empty()) {
+            t_lease.recorder = g_idleRecorders.back();
+            g_idleRecorders.pop_back();
+        } else {
+            g_recorders.push_back(std::make_unique<ThreadRecorder>());
+            t_lease.recorder = g_recorders.back().get();
+        }
+    }
+    return *t_lease.recorder;
+}
+
+LanguageSlot* localSlot(Language language) {
+    if (language == Language::Unsupported) return nullptr;
+    ThreadRecorder& recorder = localRecorder();
+    std::atomic<LanguageSlot*>& entry = recorder.slots[LanguageRegistry::index(language)];
+    LanguageSlot* slot = entry.load(std::memory_order_relaxed);
+    if (!slot) {
+        // Publish a fully constructed slot so concurrent readers never see a partial one.
+        recorder.owned.push_back(std::make_unique<LanguageSlot>());
+        slot = recorder.owned.back().get();
+        entry.store(slot, std::memory_order_release);
+    }
+    return slot;
+}
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') escaped += '\\';
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+namespace Telemetry {
+
+void enable() {
+    g_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+StageTimer::StageTimer(Stage stage, Language language)
+    : stage(stage), language(language), active(enabled()) {
+    if (active) start = Clock::now();
+}
+
+StageTimer::~StageTimer() {
+    if (!active) return;
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    if (LanguageSlot* slot = localSlot(language)) slot->stages[static_cast<size_t>(stage)].record(us);
+}
+
+void add(Counter counter, Language language, uint64_t amount) {
+    if (!enabled()) return;
+    if (LanguageSlot* slot = localSlot(language)) bump(slot->counters[static_cast<size_t>(counter)], amount);
+}
+
+void skip(SkipReason reason, uint64_t amount) {
+    if (!enabled()) return;
+    bump(localRecorder().skips[static_cast<size_t>(reason)], amount);
+}
+
+void recordRun(double seconds) {
+    std::lock_guard<std::mutex> lock(g_runMutex);
+    g_runs++;
+    g_lastRunSeconds = seconds;
+    g_lastRunTimestamp = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string renderPrometheus() {
+    struct Merged {
+        HistogramSnapshot stages[kStageCount];
+        uint64_t counters[kCounterCount] = {};
+    };
+    std::map<std::string, Merged> byLanguage;
+    uint64_t skips[kSkipCount] = {};
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (const auto& recorder : g_recorders) {
+            for (size_t r = 0; r < kSkipCount; ++r) skips[r] += recorder->skips[r].load(std::memory_order_relaxed);
+            for (size_t l = 0; l < LanguageRegistry::kMaxLanguages; ++l) {
+                const LanguageSlot* slot = recorder->slots[l].load(std::memory_order_acquire);
+                if (!slot) continue;
+                Merged& merged = byLanguage[LanguageRegistry::name(static_cast<Language>(l))];
+                for (size_t s = 0; s < kStageCount; ++s) merged.stages[s].merge(slot->stages[s].snapshot());
+                for (size_t c = 0; c < kCounterCount; ++c) {
+                    merged.counters[c] += slot->counters[c].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    std::ostringstream out;
+    out.precision(9);
+    for (size_t s = 0; s < kStageCount; ++s) {
+        const char* name = kStageMetric[s];
+        out << "# HELP " << name << " " << kStageHelp[s] << "\n# TYPE " << name << " histogram\n";
+        for (const auto& [language, merged] : byLanguage) {
+            const HistogramSnapshot& histogram = merged.stages[s];
+            std::string label = "language=\"" + escapeLabel(language) + "\"";
+            for (double bound : kBucketBounds) {
+                out << name << "_bucket{" << label << ",le=\"" << bound << "\"} "
+                    << histogram.countAtOrBelow(static_cast<uint64_t>(bound * 1e6)) << "\n";
+            }
+            out << name << "_bucket{" << label << ",le=\"+Inf\"} " << histogram.count() << "\n";
+            out << name << "_sum{" << label << "} " << histogram.sum() / 1e6 << "\n";
+            out << name << "_count{" << label << "} " << histogram.count() << "\n";
+        }
+        const char* quantileName = kStageQuantileMetric[s];
+        out << "# HELP " << quantileName << " Latency quantiles from the high-resolution histogram.\n"
+            << "# TYPE " << quantileName << " gauge\n";
+        for (const auto& [language, merged] : byLanguage) {
+            for (double q : kQuantiles) {
+                out << quantileName << "{language=\"" << escapeLabel(language) << "\",quantile=\"" << q << "\"} "
+                    << merged.stages[s].quantile(q) / 1e6 << "\n";
+            }
+        }
+    }
+
+    for (size_t c = 0; c < kCounterCount; ++c) {
+        out << "# HELP " << kCounterMetric[c] << " " << kCounterHelp[c] << "\n# TYPE " << kCounterMetric[c]
+            << " counter\n";
+        for (const auto& [language, merged] : byLanguage) {
+            out << kCounterMetric[c] << "{language=\"" << escapeLabel(language) << "\"} " << merged.counters[c] << "\n";
+        }
+    }
+
+    out << "# HELP cqa_files_skipped_total Files that were not analyzed.\n# TYPE cqa_files_skipped_total counter\n";
+    for (size_t r = 0; r < kSkipCount; ++r) {
+        out << "cqa_files_skipped_total{reason=\"" << kSkipLabel[r] << "\"} " << skips[r] << "\n";
+    }
+
+    std::lock_guard<std::mutex> lock(g_runMutex);
+    out << "# HELP cqa_runs_total Completed analysis runs.\n# TYPE cqa_runs_total counter\n"
+        << "cqa_runs_total " << g_runs << "\n"
+        << "# HELP cqa_last_run_duration_seconds Wall time of the most recent run.\n"
+        << "# TYPE cqa_last_run_duration_seconds gauge\n"
+        << "cqa_last_run_duration_seconds " << g_lastRunSeconds << "\n"
+        << "# HELP cqa_last_run_timestamp_seconds Unix time at which the most recent run finished.\n"
+        << "# TYPE cqa_last_run_timestamp_seconds gauge\n"
+        << std::fixed << "cqa_last_run_timestamp_seconds " << g_lastRunTimestamp << "\n";
+    return out.str();
+}
+
+bool writeTextfile(const std::string& path) {
+    std::string temporary = path + ".tmp";
+    std::FILE* out = std::fopen(temporary.c_str(), "w");
+    if (!out) return false;
+    std::string text = renderPrometheus();
+    bool written = std::fwrite(text.data(), 1, text.size(), out) == text.size();
+    written = std::fclose(out) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace Telemetry
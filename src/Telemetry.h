@@ -0,0 +1,86 @@
+/**
+ * @file Telemetry.h
+ * @brief Operational metrics for fleet-wide runs: latency histograms and counters.
+ *
+ * Every worker thread records into its own per-language `Histogram`s and counters,
+ * so recording is lock-free. Readers (the textfile writer or the live `/metrics`
+ * endpoint) merge all threads on demand and render the Prometheus text exposition
+ * format. Counters are cumulative for the lifetime of the process, which keeps
+ * them valid Prometheus counters across repeated `--watch` runs.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "LanguageRegistry.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Telemetry {
+
+    enum class Stage : uint8_t {
+        Parse,
+        Analyze,
+        Count
+    };
+
+    enum class Counter : uint8_t {
+        FilesAnalyzed,
+        SourceBytes,
+        ParseErrors,
+        RemoteCacheHits,
+        Count
+    };
+
+    enum class SkipReason : uint8_t {
+        Unsupported, ///< No analyzer for the file's language.
+        Unreadable,  ///< The file could not be opened.
+        Budget,      ///< Still queued when a `--budget` run's time ran out.
+        Count
+    };
+
+    /// Turns recording on. Must be called before any worker thread starts.
+    void enable();
+    bool enabled();
+
+    /**
+     * @class StageTimer
+     * @brief Records the duration of the enclosing block in the stage's latency histogram.
+     */
+    class StageTimer {
+    public:
+        StageTimer(Stage stage, Language language);
+        ~StageTimer();
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+    private:
+        Stage stage;
+        Language language;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void add(Counter counter, Language language, uint64_t amount = 1);
+    void skip(SkipReason reason, uint64_t amount = 1);
+
+    /// Records the completion of one whole analysis run.
+    void recordRun(double seconds);
+
+    /// @return All metrics in Prometheus text exposition format (version 0.0.4).
+    std::string renderPrometheus();
+
+    /**
+     * @brief Writes the metrics for node_exporter's textfile collector.
+     * The file is written next to its destination and renamed into place, so the
+     * collector never sees a partial file.
+     */
+    bool writeTextfile(const std::string& path);
+
+} // namespace Telemetry
+
+#endif // TELEMETRY_H
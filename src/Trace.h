@@ -0,0 +1,61 @@
+/**
+ * @file Trace.h
+ * @brief Instrumentation macros for hot paths, switchable at compile time.
+ *
+ * All profiling, tracing and counter hooks in the pipeline go through these
+ * macros rather than calling the Profiler directly. With the CMake option
+ * `CQA_ENABLE_TRACING=OFF` they expand to empty `static_cast<void>` statements:
+ * no objects are constructed and the arguments are not evaluated, so the
+ * instrumented functions compile to the same code as if the hooks had never
+ * been written. The trace-codegen test (bench/TraceCodegenCheck.cmake) checks
+ * this by comparing their disassembly with that of a copy without the hooks.
+ *
+ * In enabled builds a hook that is not switched on at run time costs one relaxed
+ * load and a predictable branch, which keeps it cheap enough for production.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifndef CQA_ENABLE_TRACING
+#define CQA_ENABLE_TRACING 1
+#endif
+
+#define CQA_TRACE_CONCAT_INNER(a, b) a##b
+#define CQA_TRACE_CONCAT(a, b) CQA_TRACE_CONCAT_INNER(a, b)
+
+#if CQA_ENABLE_TRACING
+
+#include "Profiler.h"
+
+/// Times the rest of the enclosing block as `Profiler::Phase::phase`.
+#define CQA_TRACE_SCOPE(phase) \
+    ::Profiler::PhaseScope CQA_TRACE_CONCAT(cqa_trace_scope_, __LINE__)(::Profiler::Phase::phase)
+
+/// Attributes everything recorded on this thread to one file until the block ends.
+#define CQA_TRACE_FILE(path, language) ::Profiler::FileScope cqa_trace_file((path), (language))
+#define CQA_TRACE_FILE_BYTES(bytes) cqa_trace_file.setSourceBytes(bytes)
+#define CQA_TRACE_FILE_SHAPE(nodes, depth) cqa_trace_file.setTreeShape((nodes), (depth))
+
+/// Adds `amount` to `Profiler::Counter::counter` for the current file.
+#define CQA_TRACE_COUNTER(counter, amount) ::Profiler::count(::Profiler::Counter::counter, (amount))
+
+/// Names the calling thread in the timeline.
+#define CQA_TRACE_THREAD_NAME(name) ::Profiler::setThreadName(name)
+
+#else
+
+// Arguments appear only inside sizeof: never evaluated, but still "used" for warnings.
+#define CQA_TRACE_SCOPE(phase) static_cast<void>(0)
+#define CQA_TRACE_FILE(path, language) static_cast<void>(sizeof(path) + sizeof(language))
+#define CQA_TRACE_FILE_BYTES(bytes) static_cast<void>(sizeof(bytes))
+#define CQA_TRACE_FILE_SHAPE(nodes, depth) static_cast<void>(sizeof(nodes) + sizeof(depth))
+#define CQA_TRACE_COUNTER(counter, amount) static_cast<void>(sizeof(amount))
+#define CQA_TRACE_THREAD_NAME(name) static_cast<void>(sizeof(name))
+
+#endif // CQA_ENABLE_TRACING
+
+#endif // TRACE_H
@@ -0,0 +1,157 @@
+/**
+ * @file cqa.h
+ * @brief The C API of libcqa, for embedding the analyzer in other programs.
+ *
+ * A `cqa_context` owns a pool of worker threads, each with its own reusable
+ * parser. `cqa_analyze()` takes a batch of in-memory sources, analyzes them on
+ * the pool, and writes the results into three flat arrays:
+ *
+ * - one `cqa_file_result` per input, in input order;
+ * - all functions of all files, in a single array, where each file refers to
+ *   its functions by index range;
+ * - a block of NUL-terminated function names, referenced by offset.
+ *
+ * The arrays are either owned by the library (leave `files` NULL, then call
+ * `cqa_results_free()`), or supplied by the caller, who can then reuse them
+ * across batches without further allocation.
+ *
+ * The API uses only C types and is versioned by `CQA_API_VERSION`; fields are
+ * only ever appended to the structs below.
+ *
+ * @author HotspringDev
+ * @date 2025-09-14
+ */
+
+#ifndef CQA_H
+#define CQA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(CQA_SHARED)
+#  ifdef CQA_BUILDING_LIBRARY
+#    define CQA_API __declspec(dllexport)
+#  else
+#    define CQA_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define CQA_API __attribute__((visibility("default")))
+#else
+#  define CQA_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CQA_API_VERSION 1
+
+/** Result of an API call. */
+typedef enum cqa_status {
+    CQA_OK = 0,
+    CQA_ERROR_INVALID_ARGUMENT = 1,
+    CQA_ERROR_BUFFER_TOO_SMALL = 2, /**< Caller-provided arrays were too small; see cqa_analyze(). */
+    CQA_ERROR_OUT_OF_MEMORY = 3,
+    CQA_ERROR_INTERNAL = 4
+} cqa_status;
+
+/** Outcome for one input of a batch. */
+typedef enum cqa_file_status {
+    CQA_FILE_OK = 0,
+    CQA_FILE_UNSUPPORTED_LANGUAGE = 1, /**< The language was unknown or could not be detected from the path. */
+    CQA_FILE_PARSE_ERROR = 2           /**< The source has syntax errors; no metrics were computed. */
+} cqa_file_status;
+
+/** One source to analyze. The memory must stay valid until cqa_analyze() returns. */
+typedef struct cqa_input {
+    const char* path;     /**< Used for language detection only (extension, else shebang or modeline); may be NULL if `language` is set. */
+    const char* language; /**< "c", "cpp", "python", "java", "rust", "go", "javascript", "typescript", or NULL to detect. */
+    const char* data;     /**< Source text, not necessarily NUL-terminated. */
+    size_t size;          /**< Length of `data` in bytes. */
+} cqa_input;
+
+/** Metrics for one input. Fields other than `status` are zero unless it is CQA_FILE_OK. */
+typedef struct cqa_file_result {
+    int32_t status;                  /**< A cqa_file_status. */
+    uint32_t function_begin;         /**< Index of the file's first function in `functions`. */
+    uint32_t function_count;
+    int32_t total_lines;
+    int32_t comment_lines;
+    int32_t naming_violations;
+    double avg_function_length;
+    double avg_function_complexity;
+    double comment_coverage_ratio;   /**< Percent of lines with comments. */
+    double shit_mountain_index;      /**< The overall score; higher is worse. */
+} cqa_file_result;
+
+/** Metrics for one function. */
+typedef struct cqa_function_result {
+    uint32_t name_offset;            /**< Offset of the NUL-terminated name in `names`. */
+    uint32_t name_length;
+    int32_t line_start;
+    int32_t line_end;
+    int32_t line_count;
+    int32_t complexity;
+} cqa_function_result;
+
+/**
+ * Output arrays of a batch.
+ *
+ * Library-owned: zero-initialize the struct. cqa_analyze() allocates the arrays
+ * and sets the counts; release them with cqa_results_free().
+ *
+ * Caller-provided: set `files` (room for one entry per input), `functions` and
+ * `names` with their capacities. If an array is too small, cqa_analyze()
+ * returns CQA_ERROR_BUFFER_TOO_SMALL and sets `function_count` and
+ * `names_size` to the sizes needed.
+ */
+typedef struct cqa_results {
+    cqa_file_result* files;
+    size_t file_capacity;
+    size_t file_count;
+    cqa_function_result* functions;
+    size_t function_capacity;
+    size_t function_count;
+    char* names;
+    size_t names_capacity;
+    size_t names_size;
+    int library_owned;               /**< Set by the library; do not modify. */
+} cqa_results;
+
+typedef struct cqa_context cqa_context;
+
+/** Returns CQA_API_VERSION of the library actually loaded. */
+CQA_API uint32_t cqa_version(void);
+
+/** Returns a static description of a status. */
+CQA_API const char* cqa_status_string(cqa_status status);
+
+/** Returns the language implied by a path's extension, or NULL if it is not supported. */
+CQA_API const char* cqa_detect_language(const char* path);
+
+/**
+ * Creates a context with `threads` analysis threads (0: one per hardware thread).
+ * The calling thread of cqa_analyze() is one of them, so 1 starts no threads.
+ * If the threads cannot all be started, the ones that were are stopped again and
+ * CQA_ERROR_INTERNAL is returned.
+ */
+CQA_API cqa_status cqa_context_create(unsigned threads, cqa_context** context);
+
+/** Stops the context's threads and frees it. Accepts NULL. */
+CQA_API void cqa_context_destroy(cqa_context* context);
+
+/**
+ * Analyzes `count` inputs and writes their metrics to `results`.
+ * Batches on one context run one at a time; concurrent calls wait for each other.
+ * Use one context per thread for independent concurrent batches.
+ */
+CQA_API cqa_status cqa_analyze(cqa_context* context, const cqa_input* inputs, size_t count, cqa_results* results);
+
+/** Frees library-owned arrays and zeroes the struct. Does nothing for caller-provided arrays. */
+CQA_API void cqa_results_free(cqa_results* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CQA_H */
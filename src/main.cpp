@@ -2,8 +2,8 @@
  * @file main.cpp
  * @brief The main entry point for the CodeWisdom Analyzer.
  *
- * This file handles command-line argument parsing, file system traversal,
- * orchestrating the analysis of each file, and printing the final ranked report.
+ * This file handles command-line argument parsing, runs the analysis pipeline
+ * (see Pipeline.h) over the requested path, and prints the final ranked report.
  *
  * @author HotspringDev
  * @date 2025-09-14
@@ -11,18 +11,35 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <iomanip>
 #include <map>
+#include <memory>
+#include <thread>
 
 #include "Parser.h"
 #include "Analyzer.h"
+#include "CodeOwners.h"
 #include "Metrics.h"
+#include "HttpServer.h"
+#include "LanguageDescriptor.h"
+#include "MemoryTracker.h"
+#include "PerfCounters.h"
+#include "Pipeline.h"
+#include "Profiler.h"
+#include "RemoteCache.h"
+#include "ResultCache.h"
+#include "Telemetry.h"
 #include "TerminalColor.h"
+#include "Trace.h"
 
 namespace fs = std::filesystem;
 using namespace TerminalColor;
@@ -40,6 +57,7 @@ bool ends_with(const std::string& value, const std::string& ending) {
  * This version provides a simplified report for files without analyzable functions.
  */
 void printReport(const FileMetrics& metrics) {
+    CQA_TRACE_SCOPE(Report);
     const Color RESET = Color::RESET, RED = Color::RED, GREEN = Color::GREEN,
                 YELLOW = Color::YELLOW, CYAN = Color::CYAN, WHITE = Color::WHITE;
     
@@ -49,7 +67,7 @@ void printReport(const FileMetrics& metrics) {
 
     std::cout << WHITE << "======================================================\n" << RESET;
     std::cout << std::fixed << std::setprecision(2);
-    std::cout << "  Analysis Report for: " << CYAN << metrics.file_path << RESET << "\n";
+    std::cout << "  Analysis Report for: " << CYAN << metrics.filePath() << RESET << "\n";
     std::cout << "  Shit Mountain Index (SMI): " << smi_color << metrics.shit_mountain_index << RESET << " (Higher is worse)\n";
     std::cout << WHITE << "------------------------------------------------------\n" << RESET;
 
@@ -73,96 +91,398 @@ void printReport(const FileMetrics& metrics) {
 }
 
 /**
- * @brief Determines the programming language from a file's extension.
- * Correctly handles C++ header files (.h, .hpp).
+ * @brief Writes a string as a JSON string literal.
  */
-std::string getLanguageFromFile(const std::string& filePath) {
-    auto const pos = filePath.find_last_of('.');
-    if (pos == std::string::npos) return "unsupported";
-    std::string ext = filePath.substr(pos);
-
-    static const std::map<std::string, std::string> extension_map = {
-        {".cpp", "cpp"}, {".hpp", "cpp"}, {".h", "cpp"}, {".cc", "cpp"}, {".cxx", "cpp"},
-        {".c", "c"},
-        {".py", "python"},
-        {".java", "java"},
-        {".rs", "rust"},
-        {".go", "go"},
-        {".js", "javascript"},
-        {".ts", "typescript"}
-    };
-
-    auto it = extension_map.find(ext);
-    return (it != extension_map.end()) ? it->second : "unsupported";
+void writeJsonString(std::ostream& out, std::string_view value) {
+    out << '"';
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                << std::dec << std::setfill(' ');
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
 }
 
 /**
- * @brief Reads, parses, and analyzes a single source file.
+ * @brief Prints a file's metrics as a single JSON line, for editor and pre-commit integrations.
  */
-FileMetrics analyzeFile(const std::string& filePath) {
-    std::string language = getLanguageFromFile(filePath);
-    if (language == "unsupported") return FileMetrics();
+void printCompactReport(const FileMetrics& metrics) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "{\"file\":";
+    writeJsonString(line, metrics.filePath());
+    line << ",\"smi\":" << metrics.shit_mountain_index
+         << ",\"avg_function_length\":" << metrics.avg_function_length
+         << ",\"avg_complexity\":" << metrics.avg_function_complexity
+         << ",\"comment_coverage\":" << metrics.comment_coverage_ratio
+         << ",\"naming_violations\":" << metrics.naming_violations << ",\"functions\":[";
+    for (size_t i = 0; i < metrics.functions.size(); ++i) {
+        FunctionView func = metrics.functions[i];
+        line << (i ? "," : "") << "{\"name\":";
+        writeJsonString(line, func.name);
+        line << ",\"line\":" << func.line_start << ",\"length\":" << func.line_count
+             << ",\"complexity\":" << func.complexity << "}";
+    }
+    line << "]}\n";
+    std::cout << line.str();
+}
 
-    std::cout << ".";
+/// Worst files listed under each owner.
+constexpr size_t kOwnerWorstFiles = 5;
 
-    std::ifstream file(filePath);
-    if (!file.is_open()) return FileMetrics();
-    std::string sourceCode((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
+/**
+ * @brief Prints the technical debt of each CODEOWNERS owner, worst first.
+ */
+void printOwnerReport(const std::vector<OwnerRollup>& rollups) {
+    std::cout << Color::WHITE << "=============== TECHNICAL DEBT BY OWNER (LINE-WEIGHTED SMI) ===============\n\n" << Color::RESET;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const OwnerRollup& rollup : rollups) {
+        std::cout << Color::CYAN << rollup.owner << Color::RESET << ": SMI " << rollup.weighted_smi
+                  << " (mean " << rollup.mean_smi << ") over " << rollup.files << " files, " << rollup.lines
+                  << " lines\n";
+        for (const FileMetrics* metrics : rollup.worst) {
+            std::cout << "    " << metrics->shit_mountain_index << "  " << metrics->filePath() << "\n";
+        }
+    }
+    std::cout << "\n";
+}
 
-    Parser parser;
-    if (parser.parse(sourceCode, language)) {
-        TSNode root = parser.getRootNode();
-        auto strategy = createStrategy(language);
-        if (!strategy) return FileMetrics();
+/**
+ * @brief Prints each owner's rollup as one JSON line.
+ */
+void printCompactOwnerReport(const std::vector<OwnerRollup>& rollups) {
+    for (const OwnerRollup& rollup : rollups) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << "{\"owner\":";
+        writeJsonString(line, rollup.owner);
+        line << ",\"files\":" << rollup.files << ",\"lines\":" << rollup.lines
+             << ",\"weighted_smi\":" << rollup.weighted_smi << ",\"mean_smi\":" << rollup.mean_smi << ",\"worst\":[";
+        for (size_t i = 0; i < rollup.worst.size(); ++i) {
+            line << (i ? "," : "") << "{\"file\":";
+            writeJsonString(line, rollup.worst[i]->filePath());
+            line << ",\"smi\":" << rollup.worst[i]->shit_mountain_index << "}";
+        }
+        line << "]}\n";
+        std::cout << line.str();
+    }
+}
 
-        Analyzer analyzer(std::move(strategy));
-        return analyzer.analyze(root, filePath, sourceCode);
-    } else {
-        std::cerr << "\n[Warning] Failed to parse: " << filePath << std::endl;
+/**
+ * @struct Options
+ * @brief Command-line options controlling a run.
+ */
+struct Options {
+    std::string path;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    size_t memory_limit_mb = 0; ///< 0 means no memory ceiling.
+    bool profile = false;       ///< Print a per-phase timing profile at the end.
+    size_t profile_top = 10;    ///< Number of slowest files listed in the profile.
+    bool perf_counters = false; ///< Collect hardware counters (implies --profile).
+    std::string trace_path;     ///< Chrome trace-event output file; empty disables tracing.
+    bool memory_profile = false; ///< Attribute allocations to phases and files (implies --profile).
+    std::string metrics_file;   ///< Prometheus textfile written after every run; empty disables it.
+    int serve_metrics_port = -1; ///< Port for a live /metrics endpoint on 127.0.0.1; -1 disables it.
+    unsigned watch_seconds = 0; ///< Re-run the analysis at this interval until interrupted; 0 runs once.
+    bool compact = false;       ///< Print one JSON line per file instead of the formatted report.
+    std::vector<std::string> descriptor_paths; ///< Language descriptor files or directories, loaded in order.
+    double budget_seconds = 0.0; ///< Wall-clock budget per run; 0 analyzes every file.
+    std::string cache_path;     ///< Scores of earlier runs, read to order a budget and updated after every run.
+    std::string remote_cache_url; ///< Shared content-addressed result cache; empty disables it.
+    std::string codeowners_path; ///< CODEOWNERS file for the per-owner rollup; empty disables it.
+};
+
+/**
+ * @brief Parses command-line arguments into an Options struct.
+ * @return False if the arguments are malformed.
+ */
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if ((arg == "-j" || arg == "--jobs") && hasValue) {
+                options.jobs = std::max(1, std::stoi(argv[++i]));
+            } else if (arg.size() > 2 && arg.compare(0, 2, "-j") == 0) {
+                options.jobs = std::max(1, std::stoi(arg.substr(2)));
+            } else if (arg == "--mem-limit" && hasValue) {
+                options.memory_limit_mb = std::stoul(argv[++i]);
+            } else if (arg == "--compact") {
+                options.compact = true;
+            } else if (arg == "--profile") {
+                options.profile = true;
+            } else if (arg == "--perf-counters") {
+                options.profile = true;
+                options.perf_counters = true;
+            } else if (arg == "--mem-profile") {
+                options.profile = true;
+                options.memory_profile = true;
+            } else if (arg == "--trace" && hasValue) {
+                options.trace_path = argv[++i];
+            } else if (arg == "--metrics-file" && hasValue) {
+                options.metrics_file = argv[++i];
+            } else if (arg == "--serve-metrics" && hasValue) {
+                options.serve_metrics_port = std::stoi(argv[++i]);
+                if (options.serve_metrics_port < 0 || options.serve_metrics_port > 65535) return false;
+            } else if (arg == "--watch" && hasValue) {
+                options.watch_seconds = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--budget" && hasValue) {
+                options.budget_seconds = std::stod(argv[++i]);
+                if (!(options.budget_seconds > 0.0)) return false;
+            } else if (arg == "--cache" && hasValue) {
+                options.cache_path = argv[++i];
+            } else if (arg == "--codeowners" && hasValue) {
+                options.codeowners_path = argv[++i];
+            } else if (arg == "--remote-cache" && hasValue) {
+                options.remote_cache_url = argv[++i];
+            } else if (arg == "--descriptors" && hasValue) {
+                options.descriptor_paths.push_back(argv[++i]);
+            } else if (arg == "--profile-top" && hasValue) {
+                options.profile = true;
+                options.profile_top = std::stoul(argv[++i]);
+            } else if (!arg.empty() && arg[0] == '-') {
+                return false;
+            } else if (options.path.empty()) {
+                options.path = arg;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
     }
-    return FileMetrics();
+    return !options.path.empty();
+}
+
+std::atomic<bool> g_stopRequested{false};
+
+void requestStop(int) {
+    g_stopRequested = true;
+}
+
+/**
+ * @brief Prints how much of the tree a budgeted run covered, as one JSON line.
+ */
+void printCompactCoverage(const GovernorStats& stats, size_t analyzed) {
+    std::cout << "{\"coverage\":{\"files_analyzed\":" << analyzed
+              << ",\"files_total\":" << stats.files_admitted + stats.files_expired
+              << ",\"bytes_analyzed\":" << stats.bytes_admitted
+              << ",\"bytes_total\":" << stats.bytes_admitted + stats.bytes_expired
+              << ",\"files_skipped\":" << stats.files_expired
+              << ",\"bytes_skipped\":" << stats.bytes_expired << "}}\n";
+}
+
+/**
+ * @brief Runs one complete analysis of the input path and returns the ranked results.
+ * @param cache Orders a budgeted run and receives the new scores; may be null.
+ * @param remote Shared results to reuse and add to; may be null.
+ * @param workspaces Per-worker parsers and buffers, kept warm from one `--watch` run to the next.
+ * @param stats Receives the governor's summary, including a budget's coverage.
+ */
+std::vector<FileMetrics> runAnalysis(const Options& options, ResultCache* cache, RemoteCache* remote,
+                                     std::vector<std::unique_ptr<AnalysisWorkspace>>& workspaces,
+                                     GovernorStats& stats) {
+    PipelineOptions pipeline;
+    pipeline.governor.max_workers = options.jobs;
+    pipeline.governor.memory_ceiling = options.memory_limit_mb * 1024 * 1024;
+    pipeline.show_progress = !options.compact;
+    pipeline.budget_seconds = options.budget_seconds;
+    pipeline.cache = cache;
+    pipeline.remote = remote;
+    pipeline.workspaces = &workspaces;
+
+    if (!options.compact) std::cout << "Analyzing files, please wait...";
+    std::vector<FileMetrics> all_metrics = analyzePath(options.path, pipeline, &stats);
+    if (!options.compact) std::cout << "\nAnalysis complete.\n\n";
+
+    if (pipeline.governor.memory_ceiling != 0 && !options.compact) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Memory governor: peak tree memory " << stats.peak_tree_bytes / (1024.0 * 1024.0) << " MB"
+                  << ", tree/source ratio " << stats.expansion_ratio
+                  << ", concurrency " << stats.min_concurrency << "-" << options.jobs
+                  << ", " << stats.throttled_waits << " throttled admissions"
+                  << ", " << stats.large_files << " large files"
+                  << (stats.pressure_available ? "" : " (PSI unavailable)") << "\n\n";
+    }
+    if (remote && !options.compact) {
+        RemoteCache::Stats remoteStats = remote->stats();
+        std::cout << "Remote cache: " << remoteStats.hits << " hits, " << remoteStats.misses << " misses, "
+                  << remoteStats.unchecked << " analyzed without their lookup, " << remoteStats.uploads << " uploaded"
+                  << (remoteStats.failed ? " (unavailable for part of the run)" : "") << "\n\n";
+    }
+    if (options.budget_seconds > 0.0 && !options.compact) {
+        // Bytes include admitted files that then failed to parse; the file count does not.
+        size_t files = stats.files_admitted + stats.files_expired;
+        double megabytes = (stats.bytes_admitted + stats.bytes_expired) / (1024.0 * 1024.0);
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Budget coverage: analyzed " << all_metrics.size() << " of " << files << " files ("
+                  << (files ? 100.0 * all_metrics.size() / files : 100.0) << "%), "
+                  << stats.bytes_admitted / (1024.0 * 1024.0) << " of " << megabytes << " MB; "
+                  << stats.files_expired << " files skipped when the budget ran out. "
+                  << "The ranking covers the analyzed files only.\n\n";
+    }
+
+    // Workers finish in arbitrary order; break ties by path so reports are reproducible.
+    std::sort(all_metrics.begin(), all_metrics.end(), [](const FileMetrics& a, const FileMetrics& b) {
+        if (a.shit_mountain_index != b.shit_mountain_index) return a.shit_mountain_index > b.shit_mountain_index;
+        return PathTable::global().compare(a.path, b.path) < 0;
+    });
+    return all_metrics;
 }
 
 /**
  * @brief Main function.
  */
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <path_to_source_file_or_directory>" << std::endl;
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [-j N] [--mem-limit MB] [--profile] [--profile-top N] [--perf-counters] [--mem-profile] [--trace out.json] [--metrics-file out.prom] [--serve-metrics PORT] [--watch SECONDS] [--descriptors PATH]... [--budget SECONDS] [--cache FILE] [--remote-cache URL] [--codeowners FILE] [--compact] <path_to_source_file_or_directory>" << std::endl;
+        std::cerr << "  --budget and --remote-cache apply to directories. A single file is always analyzed in full,\n"
+                     "  and the coverage reported for it is that one file." << std::endl;
         return 1;
     }
 
-    std::string path = argv[1];
+    const std::string& path = options.path;
     if (!fs::exists(path)) {
         std::cerr << "Error: Path does not exist: " << path << std::endl;
         return 1;
     }
-    
-    std::vector<FileMetrics> all_metrics;
-    std::cout << "Analyzing files, please wait...";
-
-    if (fs::is_directory(path)) {
-        for (const auto& entry : fs::recursive_directory_iterator(path)) {
-            if (entry.is_regular_file()) {
-                FileMetrics result = analyzeFile(entry.path().string());
-                if (!result.file_path.empty()) all_metrics.push_back(result);
+
+    // Before any file is analyzed: the registry is not synchronized for later changes.
+    for (const std::string& descriptorPath : options.descriptor_paths) {
+        std::vector<std::string> errors;
+        if (!LanguageDescriptors::loadPath(descriptorPath, errors)) {
+            for (const std::string& error : errors) std::cerr << "Error: Language descriptor " << error << std::endl;
+            return 1;
+        }
+    }
+
+    ResultCache cache;
+    if (!options.cache_path.empty()) {
+        std::string error;
+        if (!cache.load(options.cache_path, error)) {
+            std::cerr << "Error: Could not read result cache " << options.cache_path << ": " << error << std::endl;
+            return 1;
+        }
+    }
+    CodeOwners codeOwners;
+    if (!options.codeowners_path.empty()) {
+        std::string error;
+        if (!codeOwners.load(options.codeowners_path, error)) {
+            std::cerr << "Error: Invalid CODEOWNERS: " << error << std::endl;
+            return 1;
+        }
+    }
+    RemoteCache remote;
+    if (!options.remote_cache_url.empty()) {
+        std::string error;
+        if (!remote.open(options.remote_cache_url, error)) {
+            std::cerr << "Error: Invalid remote cache: " << error << std::endl;
+            return 1;
+        }
+    }
+
+#if !CQA_ENABLE_TRACING
+    if (options.profile || !options.trace_path.empty()) {
+        std::cerr << "[Warning] This build was configured with CQA_ENABLE_TRACING=OFF; "
+                     "--profile, --perf-counters, --mem-profile and --trace have no effect." << std::endl;
+    }
+    options.profile = options.perf_counters = options.memory_profile = false;
+    options.trace_path.clear();
+#endif
+
+    // Must precede the first parser so every tree-sitter allocation is accounted for.
+    MemoryTracker::install();
+    if (options.profile) Profiler::enable();
+    if (options.memory_profile) {
+        Profiler::enableMemory();
+        if (!MemoryTracker::enableCxxTracking()) {
+            std::cerr << "[Warning] C++ allocation tracking is not supported by this build; "
+                         "only tree-sitter memory will be reported." << std::endl;
+        }
+    }
+    std::string perfUnavailable;
+    if (options.perf_counters && !PerfCounters::enable(perfUnavailable)) {
+        std::cerr << "[Warning] Hardware counters unavailable: " << perfUnavailable << std::endl;
+    }
+    if (!options.trace_path.empty()) Profiler::enableTrace(1u << 16);
+    if (!options.metrics_file.empty() || options.serve_metrics_port >= 0) Telemetry::enable();
+    CQA_TRACE_THREAD_NAME("main");
+
+    HttpServer metricsServer;
+    if (options.serve_metrics_port >= 0) {
+        std::string error;
+        auto handler = [](const HttpRequest& request) {
+            HttpResponse response;
+            if (request.path != "/metrics") {
+                response.status = 404;
+            } else if (request.method != "GET" && request.method != "HEAD") {
+                response.status = 405;
+            } else {
+                response.content_type = "text/plain; version=0.0.4; charset=utf-8";
+                response.body = Telemetry::renderPrometheus();
             }
+            return response;
+        };
+        if (!metricsServer.start("127.0.0.1", static_cast<uint16_t>(options.serve_metrics_port), handler, error)) {
+            std::cerr << "Error: Could not serve metrics on port " << options.serve_metrics_port << ": " << error << std::endl;
+            return 1;
         }
-    } else if (fs::is_regular_file(path)) {
-        FileMetrics result = analyzeFile(path);
-        if (!result.file_path.empty()) all_metrics.push_back(result);
+        std::cout << "Serving metrics on http://127.0.0.1:" << metricsServer.port() << "/metrics\n";
     }
-    std::cout << "\nAnalysis complete.\n\n";
 
-    std::sort(all_metrics.begin(), all_metrics.end(), [](const FileMetrics& a, const FileMetrics& b) {
-        return a.shit_mountain_index > b.shit_mountain_index;
-    });
-    
-    std::cout << Color::WHITE << "=============== PROJECT ANALYSIS RANKING (WORST FILES FIRST) ===============\n\n" << Color::RESET;
-    for (const auto& metrics : all_metrics) {
-        printReport(metrics);
+    if (options.watch_seconds != 0) {
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
     }
 
+    std::vector<std::unique_ptr<AnalysisWorkspace>> workspaces;
+    do {
+        auto runStart = std::chrono::steady_clock::now();
+        GovernorStats stats;
+        std::vector<FileMetrics> all_metrics = runAnalysis(options, options.cache_path.empty() ? nullptr : &cache,
+                                                       options.remote_cache_url.empty() ? nullptr : &remote,
+                                                       workspaces, stats);
+        Telemetry::recordRun(std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count());
+        if (!options.cache_path.empty() && !cache.save(options.cache_path)) {
+            std::cerr << "Error: Could not write result cache: " << options.cache_path << std::endl;
+            if (options.watch_seconds == 0) return 1;
+        }
+        if (!options.metrics_file.empty() && !Telemetry::writeTextfile(options.metrics_file)) {
+            std::cerr << "Error: Could not write metrics file: " << options.metrics_file << std::endl;
+            if (options.watch_seconds == 0) return 1;
+        }
+
+        if (options.compact) {
+            for (const auto& metrics : all_metrics) printCompactReport(metrics);
+            if (options.budget_seconds > 0.0) printCompactCoverage(stats, all_metrics.size());
+            if (!options.codeowners_path.empty()) printCompactOwnerReport(codeOwners.rollUp(all_metrics, kOwnerWorstFiles));
+        } else {
+            std::cout << Color::WHITE << "=============== PROJECT ANALYSIS RANKING (WORST FILES FIRST) ===============\n\n" << Color::RESET;
+            for (const auto& metrics : all_metrics) {
+                printReport(metrics);
+            }
+            if (!options.codeowners_path.empty()) printOwnerReport(codeOwners.rollUp(all_metrics, kOwnerWorstFiles));
+        }
+
+        // Every --watch run is profiled on its own; the trace file always holds the latest run.
+        Profiler::printReport(std::cout, options.profile_top);
+        if (!Profiler::writeTrace(options.trace_path)) {
+            std::cerr << "Error: Could not write trace file: " << options.trace_path << std::endl;
+            if (options.watch_seconds == 0) return 1;
+        }
+        Profiler::reset();
+
+        // Sleep in short slices so a signal ends the watch promptly.
+        auto nextRun = std::chrono::steady_clock::now() + std::chrono::seconds(options.watch_seconds);
+        while (options.watch_seconds != 0 && !g_stopRequested && std::chrono::steady_clock::now() < nextRun) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    } while (options.watch_seconds != 0 && !g_stopRequested);
+
+    metricsServer.stop();
     return 0;
 }